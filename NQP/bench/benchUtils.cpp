@@ -0,0 +1,352 @@
+#include "benchUtils.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+#include <limits>
+#include <numeric>
+#include <sstream>
+namespace NNLS_BENCH {
+using namespace QP_NNLS;
+
+SampleStats Summarize(std::vector<double> samples) {
+    SampleStats stats;
+    if (samples.empty()) {
+        return stats;
+    }
+    std::sort(samples.begin(), samples.end());
+    const std::size_t n = samples.size();
+    stats.min = samples.front();
+    stats.max = samples.back();
+    stats.median = n % 2 == 1 ? samples[n / 2] : 0.5 * (samples[n / 2 - 1] + samples[n / 2]);
+    stats.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / n;
+    return stats;
+}
+
+double GeometricMean(const std::vector<double>& values) {
+    double logSum = 0.0;
+    std::size_t n = 0;
+    for (double v : values) {
+        if (v > 0.0 && std::isfinite(v)) {
+            logSum += std::log(v);
+            ++n;
+        }
+    }
+    return n > 0 ? std::exp(logSum / n) : std::numeric_limits<double>::quiet_NaN();
+}
+
+std::string BenchOptions::Get(const std::string& key, const std::string& defaultValue) const {
+    const auto it = named.find(key);
+    return it == named.end() ? defaultValue : it->second;
+}
+
+int BenchOptions::GetInt(const std::string& key, int defaultValue) const {
+    const auto it = named.find(key);
+    return it == named.end() ? defaultValue : std::stoi(it->second);
+}
+
+double BenchOptions::GetDouble(const std::string& key, double defaultValue) const {
+    const auto it = named.find(key);
+    return it == named.end() ? defaultValue : std::stod(it->second);
+}
+
+BenchOptions ParseOptions(int argc, char* argv[], int first) {
+    BenchOptions options;
+    for (int i = first; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg.rfind("--", 0) == 0) {
+            const std::string key = arg.substr(2);
+            if (i + 1 < argc && std::string(argv[i + 1]).rfind("--", 0) != 0) {
+                options.named[key] = argv[++i];
+            } else {
+                options.named[key] = "1";
+            }
+        } else {
+            options.positional.push_back(arg);
+        }
+    }
+    return options;
+}
+
+bool ParseSizes(const std::string& list, std::vector<unsg_t>& sizes) {
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        const int n = std::atoi(item.c_str());
+        if (n <= 0) {
+            return false;
+        }
+        sizes.push_back(static_cast<unsg_t>(n));
+    }
+    return !sizes.empty();
+}
+
+void JsonWriter::Prefix(const std::string& key) {
+    if (!first.empty()) {
+        if (!first.back()) {
+            os << ",";
+        }
+        first.back() = false;
+        os << "\n" << std::string(2 * first.size(), ' ');
+        if (!inArray.back()) {
+            os << "\"" << key << "\": ";
+        }
+    }
+}
+
+void JsonWriter::BeginObject(const std::string& key) {
+    Prefix(key);
+    os << "{";
+    first.push_back(true);
+    inArray.push_back(false);
+}
+
+void JsonWriter::EndObject() {
+    first.pop_back();
+    inArray.pop_back();
+    os << "\n" << std::string(2 * first.size(), ' ') << "}";
+    if (first.empty()) {
+        os << "\n";
+    }
+}
+
+void JsonWriter::BeginArray(const std::string& key) {
+    Prefix(key);
+    os << "[";
+    first.push_back(true);
+    inArray.push_back(true);
+}
+
+void JsonWriter::EndArray() {
+    first.pop_back();
+    inArray.pop_back();
+    os << "\n" << std::string(2 * first.size(), ' ') << "]";
+}
+
+void JsonWriter::Value(const std::string& key, double value) {
+    Prefix(key);
+    if (std::isfinite(value)) {
+        os << std::setprecision(15) << value;
+    } else {
+        os << "null";
+    }
+}
+
+void JsonWriter::Value(const std::string& key, bool value) {
+    Prefix(key);
+    os << (value ? "true" : "false");
+}
+
+void JsonWriter::Value(const std::string& key, const std::string& value) {
+    Prefix(key);
+    os << "\"";
+    for (char ch : value) {
+        if (ch == '"' || ch == '\\') {
+            os << '\\' << ch;
+        } else if (ch == '\n') {
+            os << "\\n";
+        } else {
+            os << ch;
+        }
+    }
+    os << "\"";
+}
+
+void JsonWriter::Stats(const std::string& key, const SampleStats& stats) {
+    BeginObject(key);
+    Value("min", stats.min);
+    Value("median", stats.median);
+    Value("mean", stats.mean);
+    Value("max", stats.max);
+    EndObject();
+}
+
+const char* ToString(DualLoopExitStatus status) {
+    switch (status) {
+    case DualLoopExitStatus::ALL_DUAL_POSITIVE: return "ALL_DUAL_POSITIVE";
+    case DualLoopExitStatus::FULL_ACTIVE_SET: return "FULL_ACTIVE_SET";
+    case DualLoopExitStatus::ITERATIONS: return "ITERATIONS";
+    case DualLoopExitStatus::INFEASIBILITY: return "INFEASIBILITY";
+    case DualLoopExitStatus::TIME_LIMIT: return "TIME_LIMIT";
+    default: return "UNKNOWN";
+    }
+}
+
+const char* ToString(PrimalLoopExitStatus status) {
+    switch (status) {
+    case PrimalLoopExitStatus::EMPTY_ACTIVE_SET: return "EMPTY_ACTIVE_SET";
+    case PrimalLoopExitStatus::ALL_PRIMAL_POSITIVE: return "ALL_PRIMAL_POSITIVE";
+    case PrimalLoopExitStatus::ITERATIONS: return "ITERATIONS";
+    case PrimalLoopExitStatus::EMPTY_ACTIVE_SET_ON_ZERO_ITERATION: return "EMPTY_ACTIVE_SET_ON_ZERO_ITERATION";
+    case PrimalLoopExitStatus::SINGULAR_MATRIX: return "SINGULAR_MATRIX";
+    case PrimalLoopExitStatus::DIDNT_STARTED: return "DIDNT_STARTED";
+    case PrimalLoopExitStatus::LINE_SEARCH_FAILED: return "LINE_SEARCH_FAILED";
+    case PrimalLoopExitStatus::TIME_LIMIT: return "TIME_LIMIT";
+    default: return "UNKNOWN";
+    }
+}
+
+const char* ToString(SolverPhase phase) {
+    switch (phase) {
+    case SolverPhase::CHOLETSKY: return "choletsky";
+    case SolverPhase::INVERSION: return "inversion";
+    case SolverPhase::M_FORMATION: return "m_formation";
+    case SolverPhase::SCALING: return "scaling";
+    case SolverPhase::PRICING: return "pricing";
+    case SolverPhase::LS_ADD: return "ls_add";
+    case SolverPhase::LS_DELETE: return "ls_delete";
+    case SolverPhase::LS_SOLVE: return "ls_solve";
+    case SolverPhase::LINE_SEARCH: return "line_search";
+    case SolverPhase::SOLUTION_RECOVERY: return "solution_recovery";
+    case SolverPhase::DUALITY_GAP: return "duality_gap";
+    case SolverPhase::PRESOLVE: return "presolve";
+    default: return "unknown";
+    }
+}
+
+const char* ToString(HwCounter counter) {
+    switch (counter) {
+    case HwCounter::CYCLES: return "cycles";
+    case HwCounter::INSTRUCTIONS: return "instructions";
+    case HwCounter::CACHE_MISSES: return "cache_misses";
+    case HwCounter::BRANCH_MISSES: return "branch_misses";
+    default: return "unknown";
+    }
+}
+
+bool ListProblems(const std::string& dir, const std::string& filter, std::vector<std::filesystem::path>& files) {
+    files.clear();
+    std::error_code ec;
+    std::map<std::string, std::filesystem::path> byName;
+    for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+        const std::filesystem::path& path = entry.path();
+        const std::string name = path.stem().string();
+        if (!entry.is_regular_file() || name.find(filter) == std::string::npos) {
+            continue;
+        }
+        const bool text = path.extension() == ".txt" || QPS_PARSER::IsQpsExtension(path.extension().string());
+        if (path.extension() == ".nqpb" || (text && byName.count(name) == 0)) {
+            byName[name] = path;
+        }
+    }
+    if (ec) {
+        std::cerr << "can't read directory " << dir << ": " << ec.message() << std::endl;
+        return false;
+    }
+    for (const auto& [name, path] : byName) {
+        files.push_back(path);
+    }
+    return true;
+}
+
+bool ProblemLoader::Load(const std::filesystem::path& file, TXT_QP_PARSER::DENSE_PROBLEM_FORMAT fmt) {
+    Stopwatch watch;
+    errMsg.clear();
+    bool loaded = false;
+    if (file.extension() == ".nqpb") {
+        problem = &binaryProblem;
+        loaded = binaryFile.Open(file.string()) && binaryFile.ToProblem(binaryProblem);
+        if (loaded) {
+            const bool leftRight = (binaryFile.GetHeader().flags & BINARY_QP_FORMAT::flagLeftRight) != 0;
+            if (leftRight != (fmt == TXT_QP_PARSER::DENSE_PROBLEM_FORMAT::LEFT_RIGHT)) {
+                loaded = false;
+                errMsg = "binary problem is stored in other format";
+            }
+        } else {
+            errMsg = binaryFile.GetError();
+        }
+        binaryFile.Close();
+    } else if (QPS_PARSER::IsQpsExtension(file.extension().string())) {
+        problem = &binaryProblem;
+        QPS_PARSER::QpsReader reader;
+        QPS_PARSER::SparseQPProblem sparse;
+        if (!reader.Read(file.string(), sparse)) {
+            errMsg = reader.GetError();
+        } else {
+            QPS_PARSER::ToDense(sparse, binaryProblem, fmt == TXT_QP_PARSER::DENSE_PROBLEM_FORMAT::LEFT_RIGHT);
+            loaded = true;
+        }
+    } else {
+        problem = &formatter.PrepareProblem(file.string(), fmt);
+        loaded = formatter.GetRetStatus().status;
+        errMsg = formatter.GetRetStatus().errMsg;
+    }
+    loadTime = watch.Seconds();
+    return loaded;
+}
+
+std::string ProblemFamily(const std::string& name) {
+    std::size_t len = 0;
+    while (len < name.size() && std::isalpha(static_cast<unsigned char>(name[len]))) {
+        ++len;
+    }
+    return len > 0 ? name.substr(0, len) : name;
+}
+
+double MaxViolation(const DenseQPProblem& problem, const std::vector<double>& x) {
+    double maxViolation = 0.0;
+    if (x.size() != problem.H.size()) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    for (std::size_t i = 0; i < problem.A.size(); ++i) {
+        double ax = 0.0;
+        for (std::size_t j = 0; j < x.size(); ++j) {
+            ax += problem.A[i][j] * x[j];
+        }
+        const double violation = i < problem.nEqConstraints ? std::fabs(ax - problem.b[i]) : ax - problem.b[i];
+        maxViolation = std::max(maxViolation, violation);
+        if (i >= problem.nEqConstraints && i < problem.bLw.size() && problem.bLw[i] > -CONSTANTS::infiniteBound) {
+            maxViolation = std::max(maxViolation, problem.bLw[i] - ax); // ranged row
+        }
+    }
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        if (i < problem.lw.size()) {
+            maxViolation = std::max(maxViolation, problem.lw[i] - x[i]);
+        }
+        if (i < problem.up.size()) {
+            maxViolation = std::max(maxViolation, x[i] - problem.up[i]);
+        }
+    }
+    return maxViolation;
+}
+
+void WriteProfile(JsonWriter& json, const SolverOutput& output) {
+    const SolverProfile& profile = output.profile;
+    const SolverCounters& counters = output.counters;
+    json.BeginObject("counters");
+    json.Value("primalIterations", counters.primalIterations);
+    json.Value("activeSetAdds", counters.activeSetAdds);
+    json.Value("activeSetDeletes", counters.activeSetDeletes);
+    json.Value("lineSearchSteps", counters.lineSearchSteps);
+    json.Value("singularSolves", counters.singularSolves);
+    json.Value("refactorizations", counters.refactorizations);
+    json.Value("activeSetChanges", counters.activeSetChanges);
+    json.Value("peakActiveSet", counters.peakActiveSet);
+    json.EndObject();
+    if (!profile.enabled) {
+        return;
+    }
+    json.BeginObject("phases");
+    for (std::size_t i = 0; i < nSolverPhases; ++i) {
+        const SolverPhase phase = static_cast<SolverPhase>(i);
+        const PhaseTime& time = profile[phase];
+        json.BeginObject(ToString(phase));
+        json.Value("calls", time.calls);
+        json.Value("wall", time.wall);
+        json.Value("selfWall", time.selfWall);
+        if (profile.cpuTime) {
+            json.Value("cpu", time.cpu);
+            json.Value("selfCpu", time.selfCpu);
+        }
+        json.Value("flops", counters.Flops(phase));
+        if (profile.hwCounters) {
+            for (std::size_t c = 0; c < nHwCounters; ++c) {
+                json.Value(ToString(static_cast<HwCounter>(c)), time.selfHw.values[c]);
+            }
+        }
+        json.EndObject();
+    }
+    json.EndObject();
+}
+}
@@ -0,0 +1,110 @@
+#ifndef NNLS_BENCH_UTILS_H
+#define NNLS_BENCH_UTILS_H
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "binary_problem.h"
+#include "qps_reader.h"
+#include "TxtParser.h"
+#include "types.h"
+namespace NNLS_BENCH {
+struct SampleStats {
+    double min = 0.0;
+    double median = 0.0;
+    double mean = 0.0;
+    double max = 0.0;
+};
+SampleStats Summarize(std::vector<double> samples);
+double GeometricMean(const std::vector<double>& values); // positive values only
+
+struct BenchOptions {
+    // positional arguments and --key value pairs, --flag without value is stored as "1"
+    std::vector<std::string> positional;
+    std::map<std::string, std::string> named;
+    bool Has(const std::string& key) const { return named.find(key) != named.end(); }
+    std::string Get(const std::string& key, const std::string& defaultValue) const;
+    int GetInt(const std::string& key, int defaultValue) const;
+    double GetDouble(const std::string& key, double defaultValue) const;
+};
+BenchOptions ParseOptions(int argc, char* argv[], int first);
+bool ParseSizes(const std::string& list, std::vector<QP_NNLS::unsg_t>& sizes); // "10,20,50", positive values
+
+class Stopwatch {
+public:
+    Stopwatch(): tStart(std::chrono::steady_clock::now()) {}
+    double Seconds() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - tStart).count();
+    }
+private:
+    std::chrono::time_point<std::chrono::steady_clock> tStart;
+};
+
+class JsonWriter {
+    // streaming writer, keys are ignored inside arrays
+public:
+    explicit JsonWriter(std::ostream& os): os(os) {}
+    ~JsonWriter() = default;
+    void BeginObject(const std::string& key = "");
+    void EndObject();
+    void BeginArray(const std::string& key = "");
+    void EndArray();
+    void Value(const std::string& key, double value); // nan / inf are written as null
+    template<typename T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>, bool> = true>
+    void Value(const std::string& key, T value) {
+        Prefix(key);
+        os << value;
+    }
+    void Value(const std::string& key, bool value);
+    void Value(const std::string& key, const std::string& value);
+    void Value(const std::string& key, const char* value) { Value(key, std::string(value)); }
+    void Stats(const std::string& key, const SampleStats& stats);
+private:
+    void Prefix(const std::string& key);
+    std::ostream& os;
+    std::vector<bool> first; // first element in current scope
+    std::vector<bool> inArray;
+};
+
+const char* ToString(QP_NNLS::DualLoopExitStatus status);
+const char* ToString(QP_NNLS::PrimalLoopExitStatus status);
+const char* ToString(QP_NNLS::SolverPhase phase);
+const char* ToString(QP_NNLS::HwCounter counter);
+
+// sorted *.txt, *.qps (*.sif, *.mps) and *.nqpb files of a directory which names contain filter, binary
+// file is taken if both exist, false if directory can't be read
+bool ListProblems(const std::string& dir, const std::string& filter, std::vector<std::filesystem::path>& files);
+class ProblemLoader {
+    // txt problems go through DenseProblemFormatter, binary problems are loaded as stored,
+    // qps problems are read sparse and expanded to the right format
+public:
+    ProblemLoader() = default;
+    ~ProblemLoader() = default;
+    bool Load(const std::filesystem::path& file, TXT_QP_PARSER::DENSE_PROBLEM_FORMAT fmt);
+    const QP_NNLS::DenseQPProblem& GetProblem() const { return *problem; }
+    const std::string& GetError() const { return errMsg; }
+    double GetLoadTime() const { return loadTime; } // seconds
+private:
+    TXT_QP_PARSER::DenseProblemFormatter formatter;
+    BINARY_QP_FORMAT::ProblemFile binaryFile;
+    QP_NNLS::DenseQPProblem binaryProblem;
+    const QP_NNLS::DenseQPProblem* problem = &binaryProblem;
+    std::string errMsg;
+    double loadTime = 0.0;
+};
+std::string ProblemFamily(const std::string& name); // leading letters: HS21 -> HS, CVXQP1_S -> CVXQP
+
+// max(Ax - b, lw - x, x - up, 0) of the original problem
+double MaxViolation(const QP_NNLS::DenseQPProblem& problem, const std::vector<double>& x);
+void WriteProfile(JsonWriter& json, const QP_NNLS::SolverOutput& output);
+
+int RunSuite(const BenchOptions& options);
+int RunQldComparison(const BenchOptions& options);
+int RunSweep(const BenchOptions& options);
+int RunKernels(const BenchOptions& options);
+int RunReplay(const BenchOptions& options);
+}
+#endif // NNLS_BENCH_UTILS_H
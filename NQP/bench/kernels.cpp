@@ -0,0 +1,472 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <Eigen/Dense>
+#include "benchUtils.h"
+#include "qp_generator.h"
+#include "utils.h"
+namespace NNLS_BENCH {
+using namespace QP_NNLS;
+namespace {
+// GFLOP/s of both sides use the nominal flop count of the operation,
+// so the ratio of rates is the ratio of times
+enum class Kernel {
+    MULT = 0,          // A * B, A: r x n, B: n x n
+    M1M2T,             // A * A_T
+    M1TM2,             // A_T * A
+    INVERT_GAUSS,      // M^-1, M: n x n
+    CHOLESKY,          // M = L_T * L
+    INVERT_CHOLETSKY,  // L^-1, L: lower triangular
+    INVERT_HERMIT,     // M^-1 from lower triangular factor
+    LDL_COMPUTE,       // R * R_T = L * D * L_T, R: n/2 x n
+    LDL_ADD,           // append row to factorization of R
+    LDL_REMOVE,        // remove first row and append it back
+    MMTB_SOLVE,        // R * R_T * x = b
+    N_KERNELS
+};
+constexpr std::size_t nKernels = static_cast<std::size_t>(Kernel::N_KERNELS);
+constexpr double nan = std::numeric_limits<double>::quiet_NaN();
+
+const char* ToString(Kernel kernel) {
+    switch (kernel) {
+    case Kernel::MULT: return "Mult";
+    case Kernel::M1M2T: return "M1M2T";
+    case Kernel::M1TM2: return "M1TM2";
+    case Kernel::INVERT_GAUSS: return "InvertByGauss";
+    case Kernel::CHOLESKY: return "ComputeCholFactorT";
+    case Kernel::INVERT_CHOLETSKY: return "InvertCholetsky";
+    case Kernel::INVERT_HERMIT: return "InvertHermit";
+    case Kernel::LDL_COMPUTE: return "LDL::Compute";
+    case Kernel::LDL_ADD: return "LDL::Add";
+    case Kernel::LDL_REMOVE: return "LDL::Remove+Add";
+    case Kernel::MMTB_SOLVE: return "MMTbSolver::Solve";
+    default: return "unknown";
+    }
+}
+
+const char* EigenCounterpart(Kernel kernel) {
+    switch (kernel) {
+    case Kernel::MULT: return "A * B";
+    case Kernel::M1M2T: return "A * A.transpose()";
+    case Kernel::M1TM2: return "A.transpose() * A";
+    case Kernel::INVERT_GAUSS: return "PartialPivLU::inverse";
+    case Kernel::CHOLESKY: return "LLT";
+    case Kernel::INVERT_CHOLETSKY: return "triangularView<Lower>::solve(I)";
+    case Kernel::INVERT_HERMIT: return "L^-T * L^-1";
+    case Kernel::LDL_COMPUTE: return "LDLT(R * R.transpose())";
+    case Kernel::LDL_ADD: return "LDLT refactorization";
+    case Kernel::LDL_REMOVE: return "LDLT refactorization";
+    case Kernel::MMTB_SOLVE: return "LDLT(R * R.transpose()).solve";
+    default: return "";
+    }
+}
+
+bool HasTallLayout(Kernel kernel) {
+    return kernel == Kernel::MULT || kernel == Kernel::M1M2T || kernel == Kernel::M1TM2;
+}
+
+template<int Layout>
+using EigenMatrix = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Layout>;
+
+struct KernelInput {
+    unsg_t n = 0;
+    matrix_t A;    // r x n, r = n or 4n
+    matrix_t B;    // n x n
+    matrix_t M;    // n x n positive definite
+    matrix_t L;    // n x n lower triangular, M = L * L_T
+    matrix_t R;    // n/2 x n, full row rank
+    std::vector<double> b; // n/2
+};
+
+struct KernelResult {
+    Kernel kernel = Kernel::MULT;
+    std::string layout;
+    unsg_t rows = 0;
+    unsg_t n = 0;
+    double flops = 0.0;
+    double custom = 0.0; // seconds per call
+    double eigenCol = 0.0;
+    double eigenRow = 0.0;
+    double maxDiff = nan; // relative to max |eigen result|, nan where results are not comparable
+    double GFlops(double t) const { return t > 0.0 ? 1.0e-9 * flops / t : nan; }
+    double Speedup() const { return custom / std::min(eigenCol, eigenRow); } // > 1: eigen is faster
+};
+
+template<typename F>
+double TimePerCall(F&& f, double minTime) {
+    // batches of doubling size until one takes minTime / 5, median of 5 batches
+    f();
+    int calls = 1;
+    while (true) {
+        Stopwatch watch;
+        for (int i = 0; i < calls; ++i) {
+            f();
+        }
+        if (watch.Seconds() >= 0.2 * minTime || calls >= (1 << 24)) {
+            break;
+        }
+        calls *= 2;
+    }
+    std::vector<double> samples;
+    for (int s = 0; s < 5; ++s) {
+        Stopwatch watch;
+        for (int i = 0; i < calls; ++i) {
+            f();
+        }
+        samples.push_back(watch.Seconds() / calls);
+    }
+    return Summarize(samples).median;
+}
+
+matrix_t RandomMatrix(QP_GENERATOR::Rng& rng, std::size_t rows, std::size_t cols) {
+    matrix_t m(rows, std::vector<double>(cols));
+    for (auto& row : m) {
+        for (auto& v : row) {
+            v = rng.Uniform(-1.0, 1.0);
+        }
+    }
+    return m;
+}
+
+template<int Layout>
+EigenMatrix<Layout> ToEigen(const matrix_t& m) {
+    const Eigen::Index cols = m.empty() ? 0 : static_cast<Eigen::Index>(m.front().size());
+    EigenMatrix<Layout> e(static_cast<Eigen::Index>(m.size()), cols);
+    for (Eigen::Index i = 0; i < e.rows(); ++i) {
+        for (Eigen::Index j = 0; j < cols; ++j) {
+            e(i, j) = m[i][j];
+        }
+    }
+    return e;
+}
+
+KernelInput MakeInput(unsg_t n, unsg_t rows, std::uint64_t seed) {
+    QP_GENERATOR::Rng rng(seed);
+    KernelInput in;
+    in.n = n;
+    in.A = RandomMatrix(rng, rows, n);
+    in.B = RandomMatrix(rng, n, n);
+    const matrix_t G = RandomMatrix(rng, n, n);
+    in.M.assign(n, std::vector<double>(n, 0.0));
+    M1M2T(G, G, in.M);
+    for (unsg_t i = 0; i < n; ++i) {
+        for (unsg_t j = 0; j < n; ++j) {
+            in.M[i][j] /= n;
+        }
+        in.M[i][i] += 1.0;
+    }
+    const Eigen::MatrixXd L = ToEigen<Eigen::ColMajor>(in.M).llt().matrixL();
+    in.L.assign(n, std::vector<double>(n, 0.0));
+    for (unsg_t i = 0; i < n; ++i) {
+        for (unsg_t j = 0; j <= i; ++j) {
+            in.L[i][j] = L(i, j);
+        }
+    }
+    in.R = RandomMatrix(rng, std::max(1U, n / 2), n);
+    in.b.resize(in.R.size());
+    for (auto& v : in.b) {
+        v = rng.Uniform(-1.0, 1.0);
+    }
+    return in;
+}
+
+double Flops(Kernel kernel, double r, double n) {
+    const double m = std::max(1.0, std::floor(n / 2.0)); // rows of R
+    switch (kernel) {
+    case Kernel::MULT: return 2.0 * r * n * n;
+    case Kernel::M1M2T: return 2.0 * r * r * n;
+    case Kernel::M1TM2: return 2.0 * r * n * n;
+    case Kernel::INVERT_GAUSS: return 2.0 * n * n * n;
+    case Kernel::CHOLESKY: return n * n * n / 3.0;
+    case Kernel::INVERT_CHOLETSKY: return n * n * n / 3.0;
+    case Kernel::INVERT_HERMIT: return 2.0 * n * n * n / 3.0;
+    case Kernel::LDL_COMPUTE: return m * m * n + m * m * m / 3.0;
+    case Kernel::LDL_ADD: return 2.0 * m * n + m * m + 2.0 * n; // A * row, L * D solve, row norm
+    case Kernel::LDL_REMOVE: return 2.0 * m * m + 2.0 * m * n + m * m; // rank one downdate of the trailing block + Add
+    case Kernel::MMTB_SOLVE: return m * m * n + m * m * m / 3.0 + 2.0 * m * m;
+    default: return 0.0;
+    }
+}
+
+double TimeCustom(Kernel kernel, const KernelInput& in, double minTime, matrix_t& result) {
+    const std::size_t n = in.n;
+    const std::size_t r = in.A.size();
+    switch (kernel) {
+    case Kernel::MULT:
+        result.assign(r, std::vector<double>(n, 0.0));
+        return TimePerCall([&]() { Mult(in.A, in.B, result); }, minTime);
+    case Kernel::M1M2T:
+        result.assign(r, std::vector<double>(r, 0.0));
+        return TimePerCall([&]() { M1M2T(in.A, in.A, result); }, minTime);
+    case Kernel::M1TM2:
+        result.assign(n, std::vector<double>(n, 0.0));
+        return TimePerCall([&]() { M1TM2(in.A, in.A, result); }, minTime);
+    case Kernel::INVERT_GAUSS:
+        return TimePerCall([&]() {
+            result.assign(n, std::vector<double>(n, 0.0));
+            InvertByGauss(in.M, result);
+        }, minTime);
+    case Kernel::CHOLESKY: {
+        CholetskyOutput output;
+        return TimePerCall([&]() {
+            result.assign(n, std::vector<double>(n, 0.0));
+            ComputeCholFactorT(in.M, result, output);
+        }, minTime);
+    }
+    case Kernel::INVERT_CHOLETSKY:
+        return TimePerCall([&]() {
+            result.assign(n, std::vector<double>(n, 0.0));
+            InvertCholetsky(in.L, result);
+        }, minTime);
+    case Kernel::INVERT_HERMIT:
+        result.assign(n, std::vector<double>(n, 0.0));
+        return TimePerCall([&]() { InvertHermit(in.L, result); }, minTime);
+    case Kernel::LDL_COMPUTE: {
+        LDL ldl;
+        const double t = TimePerCall([&]() {
+            ldl.Set(in.R);
+            ldl.Compute();
+        }, minTime);
+        result = ldl.GetL();
+        return t;
+    }
+    case Kernel::LDL_ADD: {
+        // factorization of all rows but the last one, removing the last row is a resize
+        LDL ldl;
+        ldl.Set(matrix_t(in.R.begin(), in.R.end() - 1));
+        ldl.Compute();
+        return TimePerCall([&]() {
+            ldl.Add(in.R.back());
+            ldl.Remove(static_cast<int>(in.R.size()) - 1);
+        }, minTime);
+    }
+    case Kernel::LDL_REMOVE: {
+        // rows rotate, the factorized matrix keeps its size
+        LDL ldl;
+        ldl.Set(in.R);
+        ldl.Compute();
+        std::size_t first = 0;
+        return TimePerCall([&]() {
+            ldl.Remove(0);
+            ldl.Add(in.R[first]);
+            first = (first + 1) % in.R.size();
+        }, minTime);
+    }
+    case Kernel::MMTB_SOLVE: {
+        MMTbSolver solver;
+        const double t = TimePerCall([&]() { solver.Solve(in.R, in.b); }, minTime);
+        result.assign(1, solver.GetSolution());
+        return t;
+    }
+    default:
+        return nan;
+    }
+}
+
+template<int Layout>
+double TimeEigen(Kernel kernel, const KernelInput& in, double minTime, Eigen::MatrixXd& result) {
+    using Matrix = EigenMatrix<Layout>;
+    const Eigen::Index n = in.n;
+    const Matrix A = ToEigen<Layout>(in.A);
+    const Matrix B = ToEigen<Layout>(in.B);
+    const Matrix M = ToEigen<Layout>(in.M);
+    const Matrix L = ToEigen<Layout>(in.L);
+    const Matrix R = ToEigen<Layout>(in.R);
+    const Eigen::VectorXd b = Eigen::Map<const Eigen::VectorXd>(in.b.data(), in.b.size());
+    const Matrix I = Matrix::Identity(n, n);
+    Matrix out;
+    double t = nan;
+    switch (kernel) {
+    case Kernel::MULT:
+        out.resize(A.rows(), n);
+        t = TimePerCall([&]() { out.noalias() = A * B; }, minTime);
+        break;
+    case Kernel::M1M2T:
+        out.resize(A.rows(), A.rows());
+        t = TimePerCall([&]() { out.noalias() = A * A.transpose(); }, minTime);
+        break;
+    case Kernel::M1TM2:
+        out.resize(n, n);
+        t = TimePerCall([&]() { out.noalias() = A.transpose() * A; }, minTime);
+        break;
+    case Kernel::INVERT_GAUSS:
+        t = TimePerCall([&]() { out = M.partialPivLu().inverse(); }, minTime);
+        break;
+    case Kernel::CHOLESKY: {
+        Eigen::LLT<Matrix> llt(n);
+        t = TimePerCall([&]() { llt.compute(M); }, minTime);
+        out = llt.matrixL();
+        break;
+    }
+    case Kernel::INVERT_CHOLETSKY:
+        t = TimePerCall([&]() { out = L.template triangularView<Eigen::Lower>().solve(I); }, minTime);
+        break;
+    case Kernel::INVERT_HERMIT: {
+        Matrix inv;
+        t = TimePerCall([&]() {
+            inv = L.template triangularView<Eigen::Lower>().solve(I);
+            out.noalias() = inv.transpose() * inv;
+        }, minTime);
+        break;
+    }
+    case Kernel::LDL_COMPUTE:
+    case Kernel::LDL_ADD:
+    case Kernel::LDL_REMOVE: {
+        Eigen::LDLT<Matrix> ldlt(R.rows());
+        Matrix gram(R.rows(), R.rows());
+        t = TimePerCall([&]() {
+            gram.noalias() = R * R.transpose();
+            ldlt.compute(gram);
+        }, minTime);
+        break;
+    }
+    case Kernel::MMTB_SOLVE: {
+        Eigen::LDLT<Matrix> ldlt(R.rows());
+        Matrix gram(R.rows(), R.rows());
+        Eigen::VectorXd x;
+        t = TimePerCall([&]() {
+            gram.noalias() = R * R.transpose();
+            x = ldlt.compute(gram).solve(b);
+        }, minTime);
+        out = x.transpose();
+        break;
+    }
+    default:
+        break;
+    }
+    result = out;
+    return t;
+}
+
+bool Comparable(Kernel kernel) {
+    // ComputeCholFactorT factorizes in reversed order (M = L_T * L), InvertHermit does not return M^-1,
+    // LDL update results depend on the row order
+    return kernel != Kernel::CHOLESKY && kernel != Kernel::INVERT_HERMIT && kernel != Kernel::LDL_COMPUTE &&
+           kernel != Kernel::LDL_ADD && kernel != Kernel::LDL_REMOVE;
+}
+
+double MaxRelativeDiff(const matrix_t& custom, const Eigen::MatrixXd& eigen) {
+    if (custom.size() != static_cast<std::size_t>(eigen.rows()) || custom.empty() ||
+        custom.front().size() != static_cast<std::size_t>(eigen.cols())) {
+        return nan;
+    }
+    double diff = 0.0;
+    for (Eigen::Index i = 0; i < eigen.rows(); ++i) {
+        for (Eigen::Index j = 0; j < eigen.cols(); ++j) {
+            diff = std::max(diff, std::fabs(custom[i][j] - eigen(i, j)));
+        }
+    }
+    const double scale = eigen.cwiseAbs().maxCoeff();
+    return scale > 0.0 ? diff / scale : diff;
+}
+
+void PrintTable(const std::vector<KernelResult>& results) {
+    std::cout << std::left << std::setw(20) << "kernel" << std::setw(8) << "layout" << std::right
+              << std::setw(7) << "rows" << std::setw(7) << "n"
+              << std::setw(11) << "custom" << std::setw(11) << "eigenCol" << std::setw(11) << "eigenRow"
+              << std::setw(10) << "speedup" << std::setw(12) << "maxDiff" << "   [GFLOP/s]\n";
+    for (const auto& r : results) {
+        std::cout << std::left << std::setw(20) << ToString(r.kernel) << std::setw(8) << r.layout << std::right
+                  << std::setw(7) << r.rows << std::setw(7) << r.n
+                  << std::fixed << std::setprecision(3)
+                  << std::setw(11) << r.GFlops(r.custom) << std::setw(11) << r.GFlops(r.eigenCol)
+                  << std::setw(11) << r.GFlops(r.eigenRow) << std::setprecision(2) << std::setw(10) << r.Speedup()
+                  << std::defaultfloat << std::setprecision(2) << std::setw(12) << r.maxDiff << "\n";
+    }
+    // geometric mean of eigen speedup per kernel over all sizes and layouts
+    std::cout << "\neigen speedup over custom kernels (geometric mean)\n";
+    for (std::size_t k = 0; k < nKernels; ++k) {
+        std::vector<double> speedups;
+        for (const auto& r : results) {
+            if (static_cast<std::size_t>(r.kernel) == k) {
+                speedups.push_back(r.Speedup());
+            }
+        }
+        if (!speedups.empty()) {
+            std::cout << "    " << std::left << std::setw(20) << ToString(static_cast<Kernel>(k)) << std::right
+                      << std::fixed << std::setprecision(2) << std::setw(8) << GeometricMean(speedups)
+                      << std::defaultfloat << "  vs " << EigenCounterpart(static_cast<Kernel>(k)) << "\n";
+        }
+    }
+}
+
+void WriteJson(const std::string& file, double minTime, const std::vector<KernelResult>& results) {
+    std::ofstream fid(file);
+    JsonWriter json(fid);
+    json.BeginObject();
+    json.Value("benchmark", "kernels");
+    json.Value("minTime", minTime);
+    json.BeginArray("results");
+    for (const auto& r : results) {
+        json.BeginObject();
+        json.Value("kernel", ToString(r.kernel));
+        json.Value("eigen", EigenCounterpart(r.kernel));
+        json.Value("layout", r.layout);
+        json.Value("rows", r.rows);
+        json.Value("n", r.n);
+        json.Value("flops", r.flops);
+        json.Value("custom", r.custom);
+        json.Value("eigenColMajor", r.eigenCol);
+        json.Value("eigenRowMajor", r.eigenRow);
+        json.Value("customGFlops", r.GFlops(r.custom));
+        json.Value("eigenColMajorGFlops", r.GFlops(r.eigenCol));
+        json.Value("eigenRowMajorGFlops", r.GFlops(r.eigenRow));
+        json.Value("speedup", r.Speedup());
+        json.Value("maxDiff", r.maxDiff);
+        json.EndObject();
+    }
+    json.EndArray();
+    json.EndObject();
+}
+}
+
+int RunKernels(const BenchOptions& options) {
+    std::vector<unsg_t> sizes;
+    if (!ParseSizes(options.Get("sizes", "16,32,64,128,256"), sizes)) {
+        std::cerr << "usage: nnls_bench kernels [--sizes 16,32,...] [--filter name] [--min-time 0.05]"
+                     " [--seed 1] [--json file]" << std::endl;
+        return 1;
+    }
+    const std::string filter = options.Get("filter", "");
+    const double minTime = std::max(1.0e-3, options.GetDouble("min-time", 0.05));
+    const std::uint64_t seed = static_cast<std::uint64_t>(std::max(0, options.GetInt("seed", 1)));
+    std::vector<KernelResult> results;
+    for (std::size_t k = 0; k < nKernels; ++k) {
+        const Kernel kernel = static_cast<Kernel>(k);
+        if (std::string(ToString(kernel)).find(filter) == std::string::npos) {
+            continue;
+        }
+        for (unsg_t n : sizes) {
+            for (unsg_t rowFactor : {1U, 4U}) {
+                if (rowFactor > 1 && !HasTallLayout(kernel)) {
+                    continue;
+                }
+                const KernelInput in = MakeInput(n, rowFactor * n, seed);
+                KernelResult result;
+                result.kernel = kernel;
+                result.layout = rowFactor == 1 ? "square" : "tall";
+                result.rows = rowFactor * n;
+                result.n = n;
+                result.flops = Flops(kernel, result.rows, n);
+                matrix_t custom;
+                Eigen::MatrixXd eigen;
+                result.custom = TimeCustom(kernel, in, minTime, custom);
+                result.eigenCol = TimeEigen<Eigen::ColMajor>(kernel, in, minTime, eigen);
+                result.eigenRow = TimeEigen<Eigen::RowMajor>(kernel, in, minTime, eigen);
+                if (Comparable(kernel)) {
+                    result.maxDiff = MaxRelativeDiff(custom, eigen);
+                }
+                results.push_back(std::move(result));
+            }
+        }
+    }
+    PrintTable(results);
+    if (options.Has("json")) {
+        WriteJson(options.Get("json", ""), minTime, results);
+    }
+    return 0;
+}
+}
@@ -0,0 +1,31 @@
+#include <iostream>
+#include <string>
+#include "benchUtils.h"
+
+int main(int argc, char* argv[]) {
+    using namespace NNLS_BENCH;
+    const std::string command = argc > 1 ? argv[1] : "";
+    const BenchOptions options = ParseOptions(argc, argv, 2);
+#ifndef __OPTIMIZE__
+    std::cerr << "warning: nnls_bench is built without optimization, timings are not representative\n";
+#endif
+    if (command == "suite") {
+        return RunSuite(options);
+    } else if (command == "qld") {
+        return RunQldComparison(options);
+    } else if (command == "sweep") {
+        return RunSweep(options);
+    } else if (command == "kernels") {
+        return RunKernels(options);
+    } else if (command == "replay") {
+        return RunReplay(options);
+    }
+    std::cerr << "usage: nnls_bench <command> [options]\n"
+                 "commands:\n"
+                 "  suite   timed solves of all problems in a directory of txt / qps / nqpb problems\n"
+                 "  qld     speed and accuracy comparison with QLD on a directory of txt / qps / nqpb problems\n"
+                 "  sweep   size sweep over generated problem families with complexity exponent fit\n"
+                 "  kernels GFLOP/s of the utils linear algebra kernels against Eigen\n"
+                 "  replay  QP sequence of an FSQP log through one solver: cold, factorization reuse, warm start\n";
+    return 1;
+}
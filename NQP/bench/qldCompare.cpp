@@ -0,0 +1,277 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include "benchUtils.h"
+#include "decorators.h"
+#include "TxtParser.h"
+#include "qp.h"
+namespace NNLS_BENCH {
+using namespace QP_NNLS;
+namespace {
+constexpr double nan = std::numeric_limits<double>::quiet_NaN();
+
+struct SolverRun {
+    SampleStats time; // conversion / setup + solve
+    double cost = nan;
+    double maxViolation = nan;
+    unsg_t iterations = 0;
+    std::vector<double> x;
+    std::string status;
+    bool solved = false;
+};
+
+struct Comparison {
+    std::string name;
+    std::string family;
+    std::string errMsg;
+    unsg_t nVariables = 0;
+    unsg_t nConstraints = 0;
+    SolverRun nqp;
+    SolverRun qld;
+    double speedup = nan; // qld time / nqp time
+    double costDelta = nan; // relative
+    double xDelta = nan; // inf norm
+    bool loaded = false;
+};
+
+void ToQldInput(const DenseQPProblem& problem, QP_SOLVERS::QPInput& input) {
+    input.m_H = problem.H;
+    input.m_A = problem.A;
+    input.m_bV = problem.b;
+    input.m_cV = problem.c;
+    input.m_lower = problem.lw;
+    input.m_upper = problem.up;
+    input.m_x0.assign(problem.H.size(), 0.0);
+    input.m_nEqConstraints = static_cast<int>(problem.nEqConstraints);
+}
+
+void RunNqp(const DenseQPProblem& problem, int warmup, int repeats, SolverRun& run) {
+    Settings settings;
+    settings.coreSettings.profile = false; // latency against QLD without profiler overhead
+    std::vector<double> times;
+    for (int r = 0; r < warmup + repeats; ++r) {
+        QPNNLSDense solver;
+        Stopwatch watch;
+        solver.Init(settings);
+        if (!solver.SetProblem(problem)) {
+            run.status = "INIT_FAILED";
+            return;
+        }
+        solver.Solve();
+        const double t = watch.Seconds();
+        if (r >= warmup) {
+            times.push_back(t);
+        }
+        if (r + 1 == warmup + repeats) {
+            const SolverOutput& output = solver.GetOutput();
+            run.status = ToString(output.dualExitStatus);
+            run.iterations = output.nDualIterations;
+            run.solved = output.dualExitStatus != DualLoopExitStatus::INFEASIBILITY;
+            if (run.solved) {
+                run.x = output.x;
+                run.cost = output.cost;
+                run.maxViolation = MaxViolation(problem, run.x);
+            }
+        }
+    }
+    run.time = Summarize(times);
+}
+
+void RunQld(const DenseQPProblem& problem, int warmup, int repeats, SolverRun& run) {
+    std::vector<double> times;
+    for (int r = 0; r < warmup + repeats; ++r) {
+        QP_SOLVERS::QPInput input;
+        QP_SOLVERS::QPOutput output;
+        Stopwatch watch;
+        ToQldInput(problem, input);
+        QP_SOLVERS::solveQLD(input, output);
+        const double t = watch.Seconds();
+        if (r >= warmup) {
+            times.push_back(t);
+        }
+        if (r + 1 == warmup + repeats) {
+            run.status = output.exitStatus == 0 ? "OK" : output.m_errMsg;
+            run.iterations = static_cast<unsg_t>(output.nIterations);
+            run.solved = output.exitStatus == 0;
+            if (run.solved) {
+                run.x = output.m_x;
+                run.cost = output.m_cost;
+                run.maxViolation = MaxViolation(problem, run.x);
+            }
+        }
+    }
+    run.time = Summarize(times);
+}
+
+void Compare(Comparison& c) {
+    c.speedup = c.nqp.time.median > 0.0 ? c.qld.time.median / c.nqp.time.median : nan;
+    if (c.nqp.solved && c.qld.solved) {
+        c.costDelta = std::fabs(c.nqp.cost - c.qld.cost) / std::max(1.0, std::fabs(c.qld.cost));
+        c.xDelta = 0.0;
+        for (std::size_t i = 0; i < c.nqp.x.size() && i < c.qld.x.size(); ++i) {
+            c.xDelta = std::max(c.xDelta, std::fabs(c.nqp.x[i] - c.qld.x[i]));
+        }
+    }
+}
+
+struct FamilySummary {
+    std::vector<double> speedups;
+    unsg_t nProblems = 0;
+    unsg_t nqpFaster = 0;
+    unsg_t bothSolved = 0;
+    double maxCostDelta = 0.0;
+};
+
+std::map<std::string, FamilySummary> SummarizeFamilies(const std::vector<Comparison>& comparisons) {
+    std::map<std::string, FamilySummary> families;
+    for (const auto& c : comparisons) {
+        if (!c.loaded) {
+            continue;
+        }
+        for (const std::string& key : {c.family, std::string("ALL")}) {
+            FamilySummary& f = families[key];
+            ++f.nProblems;
+            if (std::isfinite(c.speedup)) {
+                f.speedups.push_back(c.speedup);
+                f.nqpFaster += c.speedup > 1.0 ? 1 : 0;
+            }
+            if (c.nqp.solved && c.qld.solved) {
+                ++f.bothSolved;
+                f.maxCostDelta = std::max(f.maxCostDelta, c.costDelta);
+            }
+        }
+    }
+    return families;
+}
+
+void PrintTable(const std::vector<Comparison>& comparisons, const std::map<std::string, FamilySummary>& families) {
+    std::cout << std::left << std::setw(16) << "problem" << std::right
+              << std::setw(6) << "n" << std::setw(6) << "m"
+              << std::setw(12) << "nqp[ms]" << std::setw(12) << "qld[ms]" << std::setw(9) << "speedup"
+              << std::setw(7) << "itNqp" << std::setw(7) << "itQld"
+              << std::setw(11) << "dCost" << std::setw(11) << "dX"
+              << std::setw(11) << "violNqp" << std::setw(11) << "violQld" << "\n";
+    for (const auto& c : comparisons) {
+        std::cout << std::left << std::setw(16) << c.name << std::right;
+        if (!c.loaded) {
+            std::cout << "  " << c.errMsg << "\n";
+            continue;
+        }
+        std::cout << std::setw(6) << c.nVariables << std::setw(6) << c.nConstraints
+                  << std::fixed << std::setprecision(4)
+                  << std::setw(12) << 1.0e3 * c.nqp.time.median << std::setw(12) << 1.0e3 * c.qld.time.median
+                  << std::setprecision(2) << std::setw(9) << c.speedup
+                  << std::defaultfloat << std::setprecision(3)
+                  << std::setw(7) << c.nqp.iterations << std::setw(7) << c.qld.iterations
+                  << std::setw(11) << c.costDelta << std::setw(11) << c.xDelta
+                  << std::setw(11) << c.nqp.maxViolation << std::setw(11) << c.qld.maxViolation << "\n";
+    }
+    std::cout << "\n" << std::left << std::setw(16) << "family" << std::right << std::setw(6) << "n"
+              << std::setw(14) << "geomSpeedup" << std::setw(11) << "nqpFaster" << std::setw(13) << "maxDCost" << "\n";
+    for (const auto& [name, f] : families) {
+        std::cout << std::left << std::setw(16) << name << std::right << std::setw(6) << f.nProblems
+                  << std::setw(14) << GeometricMean(f.speedups) << std::setw(11) << f.nqpFaster
+                  << std::setw(13) << f.maxCostDelta << "\n";
+    }
+}
+
+void WriteRun(JsonWriter& json, const std::string& key, const SolverRun& run) {
+    json.BeginObject(key);
+    json.Stats("time", run.time);
+    json.Value("iterations", run.iterations);
+    json.Value("status", run.status);
+    json.Value("solved", run.solved);
+    json.Value("cost", run.cost);
+    json.Value("maxViolation", run.maxViolation);
+    json.EndObject();
+}
+
+void WriteJson(const std::string& file, const BenchOptions& options, const std::vector<Comparison>& comparisons,
+               const std::map<std::string, FamilySummary>& families) {
+    std::ofstream fid(file);
+    JsonWriter json(fid);
+    json.BeginObject();
+    json.Value("benchmark", "qld");
+    json.Value("directory", options.positional.front());
+    json.Value("warmup", options.GetInt("warmup", 1));
+    json.Value("repeats", options.GetInt("repeats", 5));
+    json.BeginArray("problems");
+    for (const auto& c : comparisons) {
+        json.BeginObject();
+        json.Value("name", c.name);
+        json.Value("family", c.family);
+        json.Value("ok", c.loaded);
+        if (!c.loaded) {
+            json.Value("error", c.errMsg);
+            json.EndObject();
+            continue;
+        }
+        json.Value("nVariables", c.nVariables);
+        json.Value("nConstraints", c.nConstraints);
+        WriteRun(json, "nqp", c.nqp);
+        WriteRun(json, "qld", c.qld);
+        json.Value("speedup", c.speedup);
+        json.Value("costDelta", c.costDelta);
+        json.Value("xDelta", c.xDelta);
+        json.EndObject();
+    }
+    json.EndArray();
+    json.BeginObject("families");
+    for (const auto& [name, f] : families) {
+        json.BeginObject(name);
+        json.Value("problems", f.nProblems);
+        json.Value("geomeanSpeedup", GeometricMean(f.speedups));
+        json.Value("nqpFaster", f.nqpFaster);
+        json.Value("bothSolved", f.bothSolved);
+        json.Value("maxCostDelta", f.maxCostDelta);
+        json.EndObject();
+    }
+    json.EndObject();
+    json.EndObject();
+}
+}
+
+int RunQldComparison(const BenchOptions& options) {
+    using namespace TXT_QP_PARSER;
+    if (options.positional.empty()) {
+        std::cerr << "usage: nnls_bench qld <problems dir> [--repeats 5] [--warmup 1] [--json file]"
+                     " [--filter substring]" << std::endl;
+        return 1;
+    }
+    std::vector<std::filesystem::path> files;
+    if (!ListProblems(options.positional.front(), options.Get("filter", ""), files)) {
+        return 1;
+    }
+    const int warmup = std::max(0, options.GetInt("warmup", 1));
+    const int repeats = std::max(1, options.GetInt("repeats", 5));
+    ProblemLoader loader;
+    std::vector<Comparison> comparisons;
+    for (const auto& file : files) {
+        Comparison c;
+        c.name = file.stem().string();
+        c.family = ProblemFamily(c.name);
+        // both solvers take Ax <= b with equalities in the first rows
+        c.loaded = loader.Load(file, DENSE_PROBLEM_FORMAT::RIGHT);
+        const DenseQPProblem& problem = loader.GetProblem();
+        if (!c.loaded) {
+            c.errMsg = loader.GetError();
+        } else {
+            c.nVariables = static_cast<unsg_t>(problem.H.size());
+            c.nConstraints = static_cast<unsg_t>(problem.A.size());
+            RunNqp(problem, warmup, repeats, c.nqp);
+            RunQld(problem, warmup, repeats, c.qld);
+            Compare(c);
+        }
+        comparisons.push_back(std::move(c));
+    }
+    const auto families = SummarizeFamilies(comparisons);
+    PrintTable(comparisons, families);
+    if (options.Has("json")) {
+        WriteJson(options.Get("json", ""), options, comparisons, families);
+    }
+    return 0;
+}
+}
@@ -0,0 +1,281 @@
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include "benchUtils.h"
+#include "decorators.h"
+#include "qp_utils.h"
+namespace NNLS_BENCH {
+using namespace QP_NNLS;
+namespace {
+enum class ReplayMode {
+    COLD = 0, // new solver per QP, as the suite does
+    FACTOR,   // one solver, Cholesky factor of H reused while H is unchanged
+    WARM,     // FACTOR + active set of the previous QP as warm start
+    N_MODES
+};
+constexpr std::size_t nModes = static_cast<std::size_t>(ReplayMode::N_MODES);
+
+const char* ToString(ReplayMode mode) {
+    switch (mode) {
+    case ReplayMode::COLD: return "cold";
+    case ReplayMode::FACTOR: return "factor";
+    case ReplayMode::WARM: return "warm";
+    default: return "unknown";
+    }
+}
+
+struct ReplayStep {
+    std::string name;
+    DenseQPProblem problem;
+};
+
+struct ModeResult {
+    ReplayMode mode = ReplayMode::COLD;
+    std::vector<double> latency;  // per QP, min over repeats, setup + solve
+    std::vector<double> cost;
+    std::vector<unsg_t> dualIterations;
+    double total = 0.0;           // min over repeats of the whole sequence
+    unsg_t primalIterations = 0;
+    unsg_t reused = 0;
+    unsg_t warmStarted = 0;
+    unsg_t failed = 0;
+    double maxCostDiff = 0.0;     // relative to cold start
+};
+
+bool LoadLog(const std::string& file, std::vector<ReplayStep>& steps) {
+    FSQP_LOG_PARSER::IterationLog log;
+    if (!log.Open(file)) {
+        std::cerr << file << ": " << log.GetError() << std::endl;
+        return false;
+    }
+    FSQP_LOG_PARSER::IterationData data;
+    using Record = FSQP_LOG_PARSER::IterationLog::Record;
+    for (Record record = log.Next(data); record != Record::END; record = log.Next(data)) {
+        ReplayStep step;
+        step.name = std::to_string(log.GetIteration());
+        if (record != Record::ITERATION || !FSQP_LOG_PARSER::IterationToProblem(data, step.problem)) {
+            std::cerr << "skipped iteration " << step.name << ": d0 subproblem can't be read" << std::endl;
+            continue;
+        }
+        steps.push_back(std::move(step));
+    }
+    return true;
+}
+
+bool LoadDirectory(const std::string& dir, const std::string& filter, std::vector<ReplayStep>& steps) {
+    // problems are replayed in file name order, e.g. nnls_problem_convert --fsqp output
+    std::vector<std::filesystem::path> files;
+    if (!ListProblems(dir, filter, files)) {
+        return false;
+    }
+    ProblemLoader loader;
+    for (const auto& file : files) {
+        if (!loader.Load(file, TXT_QP_PARSER::DENSE_PROBLEM_FORMAT::RIGHT)) {
+            std::cerr << "skipped " << file.string() << ": " << loader.GetError() << std::endl;
+            continue;
+        }
+        steps.push_back({file.stem().string(), loader.GetProblem()});
+    }
+    // numeric suffixes: log_2 before log_10
+    std::stable_sort(steps.begin(), steps.end(), [](const ReplayStep& l, const ReplayStep& r) {
+        return l.name.size() < r.name.size() || (l.name.size() == r.name.size() && l.name < r.name);
+    });
+    return true;
+}
+
+void Replay(const std::vector<ReplayStep>& steps, ReplayMode mode, int repeats, ModeResult& result) {
+    const std::size_t nSteps = steps.size();
+    result.mode = mode;
+    result.latency.assign(nSteps, std::numeric_limits<double>::max());
+    result.cost.assign(nSteps, std::numeric_limits<double>::quiet_NaN());
+    result.dualIterations.assign(nSteps, 0);
+    result.total = std::numeric_limits<double>::max();
+    Settings settings;
+    settings.coreSettings.profile = false; // per-QP latency without profiler overhead
+    settings.coreSettings.reuseFactorization = mode != ReplayMode::COLD;
+    for (int r = 0; r < repeats; ++r) {
+        result.primalIterations = 0;
+        result.reused = 0;
+        result.warmStarted = 0;
+        result.failed = 0;
+        QPNNLSDense longLived;
+        longLived.Init(settings);
+        std::vector<unsg_t> activeSet;
+        double total = 0.0;
+        for (std::size_t i = 0; i < nSteps; ++i) {
+            std::unique_ptr<QPNNLSDense> fresh;
+            QPNNLSDense* solver = &longLived;
+            Stopwatch watch;
+            if (mode == ReplayMode::COLD) {
+                fresh = std::make_unique<QPNNLSDense>();
+                fresh->Init(settings);
+                solver = fresh.get();
+            }
+            const bool initialized = solver->SetProblem(steps[i].problem);
+            if (initialized) {
+                if (mode == ReplayMode::WARM) {
+                    solver->SetWarmStart(activeSet);
+                }
+                solver->Solve();
+            }
+            const double t = watch.Seconds();
+            total += t;
+            result.latency[i] = std::min(result.latency[i], t);
+            if (!initialized) {
+                ++result.failed;
+                activeSet.clear();
+                continue;
+            }
+            const SolverOutput& output = solver->GetOutput();
+            result.cost[i] = output.cost;
+            result.dualIterations[i] = output.nDualIterations;
+            result.primalIterations += output.counters.primalIterations;
+            result.reused += output.counters.factorizationReused ? 1 : 0;
+            result.warmStarted += output.counters.warmStartSize > 0 ? 1 : 0;
+            if (output.dualExitStatus == DualLoopExitStatus::INFEASIBILITY) {
+                ++result.failed;
+                activeSet.clear();
+            } else {
+                activeSet = output.activeSet;
+            }
+        }
+        result.total = std::min(result.total, total);
+    }
+}
+
+void CompareCost(const ModeResult& reference, ModeResult& result) {
+    result.maxCostDiff = 0.0;
+    for (std::size_t i = 0; i < result.cost.size(); ++i) {
+        const double diff = std::fabs(result.cost[i] - reference.cost[i]) / (1.0 + std::fabs(reference.cost[i]));
+        if (!std::isnan(diff)) {
+            result.maxCostDiff = std::max(result.maxCostDiff, diff);
+        }
+    }
+}
+
+unsg_t Sum(const std::vector<unsg_t>& v) {
+    unsg_t sum = 0;
+    for (unsg_t x : v) {
+        sum += x;
+    }
+    return sum;
+}
+
+void PrintSummary(const std::vector<ModeResult>& results, std::size_t nSteps) {
+    std::cout << std::left << std::setw(8) << "mode" << std::right
+              << std::setw(12) << "total[ms]" << std::setw(10) << "QP/s"
+              << std::setw(12) << "median[ms]" << std::setw(12) << "max[ms]"
+              << std::setw(9) << "dualIt" << std::setw(10) << "primalIt"
+              << std::setw(8) << "reused" << std::setw(7) << "warm" << std::setw(8) << "failed"
+              << std::setw(13) << "maxCostDiff" << "\n";
+    for (const auto& r : results) {
+        const SampleStats latency = Summarize(r.latency);
+        std::cout << std::left << std::setw(8) << ToString(r.mode) << std::right
+                  << std::fixed << std::setprecision(3)
+                  << std::setw(12) << 1.0e3 * r.total << std::setw(10) << std::setprecision(1) << nSteps / r.total
+                  << std::setprecision(4) << std::setw(12) << 1.0e3 * latency.median
+                  << std::setw(12) << 1.0e3 * latency.max << std::defaultfloat
+                  << std::setw(9) << Sum(r.dualIterations) << std::setw(10) << r.primalIterations
+                  << std::setw(8) << r.reused << std::setw(7) << r.warmStarted << std::setw(8) << r.failed
+                  << std::setprecision(3) << std::setw(13) << r.maxCostDiff << "\n";
+    }
+}
+
+void PrintSteps(const std::vector<ReplayStep>& steps, const std::vector<ModeResult>& results) {
+    std::cout << std::left << std::setw(12) << "qp" << std::right << std::setw(6) << "n" << std::setw(6) << "m";
+    for (const auto& r : results) {
+        std::cout << std::setw(12) << (std::string(ToString(r.mode)) + "[ms]") << std::setw(6) << "it";
+    }
+    std::cout << "\n";
+    for (std::size_t i = 0; i < steps.size(); ++i) {
+        std::cout << std::left << std::setw(12) << steps[i].name << std::right
+                  << std::setw(6) << steps[i].problem.H.size() << std::setw(6) << steps[i].problem.A.size();
+        for (const auto& r : results) {
+            std::cout << std::fixed << std::setprecision(4) << std::setw(12) << 1.0e3 * r.latency[i]
+                      << std::defaultfloat << std::setw(6) << r.dualIterations[i];
+        }
+        std::cout << "\n";
+    }
+}
+
+void WriteJson(const std::string& file, const std::string& source, int repeats,
+               const std::vector<ReplayStep>& steps, const std::vector<ModeResult>& results) {
+    std::ofstream fid(file);
+    JsonWriter json(fid);
+    json.BeginObject();
+    json.Value("benchmark", "replay");
+    json.Value("source", source);
+    json.Value("repeats", repeats);
+    json.Value("nQPs", steps.size());
+    json.BeginArray("modes");
+    for (const auto& r : results) {
+        json.BeginObject();
+        json.Value("mode", ToString(r.mode));
+        json.Value("total", r.total);
+        json.Value("throughput", steps.size() / r.total);
+        json.Stats("latency", Summarize(r.latency));
+        json.Value("dualIterations", Sum(r.dualIterations));
+        json.Value("primalIterations", r.primalIterations);
+        json.Value("factorizationReused", r.reused);
+        json.Value("warmStarted", r.warmStarted);
+        json.Value("failed", r.failed);
+        json.Value("maxCostDiff", r.maxCostDiff);
+        json.BeginArray("steps");
+        for (std::size_t i = 0; i < steps.size(); ++i) {
+            json.BeginObject();
+            json.Value("name", steps[i].name);
+            json.Value("latency", r.latency[i]);
+            json.Value("iterations", r.dualIterations[i]);
+            json.Value("cost", r.cost[i]);
+            json.EndObject();
+        }
+        json.EndArray();
+        json.EndObject();
+    }
+    json.EndArray();
+    json.EndObject();
+}
+}
+
+int RunReplay(const BenchOptions& options) {
+    if (options.positional.empty()) {
+        std::cerr << "usage: nnls_bench replay <fsqp log | dir of converted problems> [--repeats 3] [--modes cold,factor,warm]"
+                     " [--filter substring] [--steps] [--json file]" << std::endl;
+        return 1;
+    }
+    const std::string source = options.positional.front();
+    std::vector<ReplayStep> steps;
+    const bool loaded = std::filesystem::is_directory(source) ? LoadDirectory(source, options.Get("filter", ""), steps)
+                                                              : LoadLog(source, steps);
+    if (!loaded || steps.empty()) {
+        std::cerr << "no problems to replay in " << source << std::endl;
+        return 1;
+    }
+    const int repeats = std::max(1, options.GetInt("repeats", 3));
+    const std::string modes = "," + options.Get("modes", "cold,factor,warm") + ",";
+    std::vector<ModeResult> results;
+    for (std::size_t m = 0; m < nModes; ++m) {
+        const ReplayMode mode = static_cast<ReplayMode>(m);
+        // cold start is always run, it is the reference of the cost check
+        if (mode != ReplayMode::COLD && modes.find("," + std::string(ToString(mode)) + ",") == std::string::npos) {
+            continue;
+        }
+        results.emplace_back();
+        Replay(steps, mode, repeats, results.back());
+        CompareCost(results.front(), results.back());
+    }
+    std::cout << "replayed " << steps.size() << " QPs from " << source << "\n";
+    if (options.Has("steps")) {
+        PrintSteps(steps, results);
+    }
+    PrintSummary(results, steps.size());
+    if (options.Has("json")) {
+        WriteJson(options.Get("json", ""), source, repeats, steps, results);
+    }
+    return 0;
+}
+}
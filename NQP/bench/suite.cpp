@@ -0,0 +1,173 @@
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include "benchUtils.h"
+#include "decorators.h"
+#include "TxtParser.h"
+namespace NNLS_BENCH {
+using namespace QP_NNLS;
+namespace {
+struct SuiteResult {
+    std::string name;
+    std::string errMsg;
+    unsg_t nVariables = 0;
+    unsg_t nConstraints = 0;
+    unsg_t nEqConstraints = 0;
+    double loadTime = 0.0;
+    SampleStats setup;
+    SampleStats solve;
+    SolverOutput output;
+    double maxViolation = 0.0;
+    bool loaded = false;
+    bool initialized = false;
+};
+
+void SolveRepeated(const DenseQPProblem& problem, const Settings& settings, int warmup, int repeats,
+                   SuiteResult& result) {
+    std::vector<double> setupTimes;
+    std::vector<double> solveTimes;
+    for (int r = 0; r < warmup + repeats; ++r) {
+        // new solver each time: settings are modified during initialization
+        QPNNLSDense solver;
+        Stopwatch setupWatch;
+        solver.Init(settings);
+        const bool initialized = solver.SetProblem(problem);
+        const double tSetup = setupWatch.Seconds();
+        if (!initialized) {
+            result.initialized = false;
+            return;
+        }
+        Stopwatch solveWatch;
+        solver.Solve();
+        const double tSolve = solveWatch.Seconds();
+        if (r >= warmup) {
+            setupTimes.push_back(tSetup);
+            solveTimes.push_back(tSolve);
+        }
+        if (r + 1 == warmup + repeats) {
+            result.output = solver.GetOutput();
+        }
+    }
+    result.initialized = true;
+    result.setup = Summarize(setupTimes);
+    result.solve = Summarize(solveTimes);
+    result.maxViolation = result.output.dualExitStatus == DualLoopExitStatus::INFEASIBILITY ?
+                          std::numeric_limits<double>::quiet_NaN() : MaxViolation(problem, result.output.x);
+}
+
+void PrintTable(const std::vector<SuiteResult>& results) {
+    std::cout << std::left << std::setw(16) << "problem" << std::right
+              << std::setw(7) << "n" << std::setw(7) << "m"
+              << std::setw(13) << "setup[ms]" << std::setw(13) << "solve[ms]"
+              << std::setw(7) << "iter" << std::setw(13) << "gap" << std::setw(13) << "maxViol"
+              << "  status\n";
+    for (const auto& r : results) {
+        std::cout << std::left << std::setw(16) << r.name << std::right;
+        if (!r.loaded || !r.initialized) {
+            std::cout << "  " << r.errMsg << "\n";
+            continue;
+        }
+        std::cout << std::setw(7) << r.nVariables << std::setw(7) << r.nConstraints
+                  << std::setprecision(4) << std::fixed
+                  << std::setw(13) << 1.0e3 * r.setup.median << std::setw(13) << 1.0e3 * r.solve.median
+                  << std::defaultfloat << std::setprecision(3)
+                  << std::setw(7) << r.output.nDualIterations
+                  << std::setw(13) << r.output.dualityGap << std::setw(13) << r.maxViolation
+                  << "  " << ToString(r.output.dualExitStatus) << "\n";
+    }
+}
+
+void WriteJson(const std::string& file, const BenchOptions& options, const std::vector<SuiteResult>& results) {
+    std::ofstream fid(file);
+    JsonWriter json(fid);
+    json.BeginObject();
+    json.Value("benchmark", "suite");
+    json.Value("directory", options.positional.front());
+    json.Value("warmup", options.GetInt("warmup", 1));
+    json.Value("repeats", options.GetInt("repeats", 5));
+    json.BeginArray("problems");
+    for (const auto& r : results) {
+        json.BeginObject();
+        json.Value("name", r.name);
+        json.Value("ok", r.loaded && r.initialized);
+        json.Value("load", r.loadTime);
+        if (!r.loaded || !r.initialized) {
+            json.Value("error", r.errMsg);
+            json.EndObject();
+            continue;
+        }
+        json.Value("nVariables", r.nVariables);
+        json.Value("nConstraints", r.nConstraints);
+        json.Value("nEqConstraints", r.nEqConstraints);
+        json.Stats("setup", r.setup);
+        json.Stats("solve", r.solve);
+        json.Value("iterations", r.output.nDualIterations);
+        json.Value("dualityGap", r.output.dualityGap);
+        json.Value("maxViolation", r.maxViolation);
+        json.Value("cost", r.output.cost);
+        json.Value("dualStatus", ToString(r.output.dualExitStatus));
+        json.Value("primalStatus", ToString(r.output.primalExitStatus));
+        WriteProfile(json, r.output);
+        json.EndObject();
+    }
+    json.EndArray();
+    json.EndObject();
+}
+}
+
+int RunSuite(const BenchOptions& options) {
+    using namespace TXT_QP_PARSER;
+    if (options.positional.empty()) {
+        std::cerr << "usage: nnls_bench suite <problems dir> [--repeats 5] [--warmup 1] [--json file]"
+                     " [--filter substring] [--format right|left_right] [--hw] [--presolve] [--eliminate-eq]" << std::endl;
+        return 1;
+    }
+    std::vector<std::filesystem::path> files;
+    if (!ListProblems(options.positional.front(), options.Get("filter", ""), files)) {
+        return 1;
+    }
+    const int warmup = std::max(0, options.GetInt("warmup", 1));
+    const int repeats = std::max(1, options.GetInt("repeats", 5));
+    const DENSE_PROBLEM_FORMAT fmt = options.Get("format", "right") == "left_right" ?
+                                     DENSE_PROBLEM_FORMAT::LEFT_RIGHT : DENSE_PROBLEM_FORMAT::RIGHT;
+    Settings settings;
+    settings.coreSettings.profile = true; // phase table of the report
+    settings.coreSettings.profileCpuTime = true;
+    settings.coreSettings.profileHwCounters = options.Has("hw");
+    settings.coreSettings.presolve = options.Has("presolve");
+    settings.coreSettings.eliminateEqualities = options.Has("eliminate-eq");
+    ProblemLoader loader;
+    std::vector<SuiteResult> results;
+    for (const auto& file : files) {
+        SuiteResult result;
+        result.name = file.stem().string();
+        result.loaded = loader.Load(file, fmt);
+        result.loadTime = loader.GetLoadTime();
+        const DenseQPProblem& problem = loader.GetProblem();
+        if (!result.loaded) {
+            result.errMsg = loader.GetError();
+        } else {
+            result.nVariables = static_cast<unsg_t>(problem.H.size());
+            result.nConstraints = static_cast<unsg_t>(problem.A.size());
+            result.nEqConstraints = problem.nEqConstraints;
+            SolveRepeated(problem, settings, warmup, repeats, result);
+            if (!result.initialized) {
+                result.errMsg = "initialization failed";
+            }
+        }
+        results.push_back(std::move(result));
+    }
+    PrintTable(results);
+    double loadTime = 0.0;
+    for (const auto& r : results) {
+        loadTime += r.loadTime;
+    }
+    std::cout << "loaded " << results.size() << " problems in " << 1.0e3 * loadTime << " ms\n";
+    if (options.Has("json")) {
+        WriteJson(options.Get("json", ""), options, results);
+    }
+    return 0;
+}
+}
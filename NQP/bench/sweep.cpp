@@ -0,0 +1,266 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include "benchUtils.h"
+#include "decorators.h"
+#include "qp_generator.h"
+namespace NNLS_BENCH {
+using namespace QP_NNLS;
+using QP_GENERATOR::QPFamily;
+namespace {
+constexpr double dominantExponentMargin = 0.5; // phase exponent above total exponent
+constexpr double dominantShare = 0.05; // phase share of solve time at the largest size
+
+struct SweepPoint {
+    unsg_t n = 0;
+    unsg_t nConstraints = 0;
+    double setup = 0.0; // medians
+    double solve = 0.0;
+    std::array<double, nSolverPhases> phases{}; // self wall time of the last repeat
+    unsg_t iterations = 0;
+    int repeats = 0; // fewer than requested when the budget ran out
+    DualLoopExitStatus status = DualLoopExitStatus::UNKNOWN;
+};
+
+struct SweepFamily {
+    QPFamily family = QPFamily::BOX;
+    std::vector<SweepPoint> points;
+    double setupExponent = 0.0;
+    double solveExponent = 0.0;
+    double totalExponent = 0.0;
+    std::array<double, nSolverPhases> phaseExponents{};
+    std::vector<SolverPhase> dominant; // phases growing faster than the total
+};
+
+double FitExponent(const std::vector<SweepPoint>& points, const std::function<double(const SweepPoint&)>& time) {
+    // least squares slope of log(t) over log(n), points with zero time are skipped
+    double sx = 0.0, sy = 0.0, sxx = 0.0, sxy = 0.0;
+    int count = 0;
+    for (const auto& p : points) {
+        const double t = time(p);
+        if (t <= 0.0 || p.n == 0) {
+            continue;
+        }
+        const double x = std::log(static_cast<double>(p.n));
+        const double y = std::log(t);
+        sx += x;
+        sy += y;
+        sxx += x * x;
+        sxy += x * y;
+        ++count;
+    }
+    const double den = count * sxx - sx * sx;
+    if (count < 2 || den <= 0.0) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    return (count * sxy - sx * sy) / den;
+}
+
+bool ParseFamilies(const std::string& list, std::vector<QPFamily>& families) {
+    if (list == "all") {
+        for (std::size_t i = 0; i < QP_GENERATOR::nFamilies; ++i) {
+            families.push_back(static_cast<QPFamily>(i));
+        }
+        return true;
+    }
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        QPFamily family;
+        if (!QP_GENERATOR::FromString(item, family)) {
+            return false;
+        }
+        families.push_back(family);
+    }
+    return !families.empty();
+}
+
+unsg_t NConstraints(QPFamily family, unsg_t n) {
+    // m argument of the generator
+    switch (family) {
+    case QPFamily::PORTFOLIO: return std::max(1U, n / 20);
+    case QPFamily::TALL: return 4 * n;
+    default: return 0;
+    }
+}
+
+// repeats stop early once budget seconds are spent, the first repeat always runs
+SweepPoint Measure(QPFamily family, unsg_t n, std::uint64_t seed, int repeats, double budget, const Settings& settings) {
+    const DenseQPProblem problem = QP_GENERATOR::Generate(family, n, NConstraints(family, n), seed);
+    SweepPoint point;
+    point.n = n;
+    point.nConstraints = static_cast<unsg_t>(problem.A.size());
+    std::vector<double> setupTimes;
+    std::vector<double> solveTimes;
+    Stopwatch watch;
+    for (int r = 0; r < repeats; ++r) {
+        QPNNLSDense solver;
+        Stopwatch setupWatch;
+        solver.Init(settings);
+        if (!solver.SetProblem(problem)) {
+            return point;
+        }
+        setupTimes.push_back(setupWatch.Seconds());
+        Stopwatch solveWatch;
+        solver.Solve();
+        solveTimes.push_back(solveWatch.Seconds());
+        if (r + 1 == repeats || watch.Seconds() > budget) {
+            const SolverOutput& output = solver.GetOutput();
+            for (std::size_t i = 0; i < nSolverPhases; ++i) {
+                point.phases[i] = output.profile.phases[i].selfWall;
+            }
+            point.iterations = output.nDualIterations;
+            point.status = output.dualExitStatus;
+            point.repeats = r + 1;
+            break;
+        }
+    }
+    point.setup = Summarize(setupTimes).median;
+    point.solve = Summarize(solveTimes).median;
+    return point;
+}
+
+void Fit(SweepFamily& result) {
+    const auto& points = result.points;
+    result.setupExponent = FitExponent(points, [](const SweepPoint& p) { return p.setup; });
+    result.solveExponent = FitExponent(points, [](const SweepPoint& p) { return p.solve; });
+    result.totalExponent = FitExponent(points, [](const SweepPoint& p) { return p.setup + p.solve; });
+    if (points.empty()) {
+        return;
+    }
+    const SweepPoint& largest = points.back();
+    const double total = largest.setup + largest.solve;
+    for (std::size_t i = 0; i < nSolverPhases; ++i) {
+        result.phaseExponents[i] = FitExponent(points, [i](const SweepPoint& p) { return p.phases[i]; });
+        if (total > 0.0 && largest.phases[i] > dominantShare * total &&
+            result.phaseExponents[i] > result.totalExponent + dominantExponentMargin) {
+            result.dominant.push_back(static_cast<SolverPhase>(i));
+        }
+    }
+}
+
+void PrintTable(const std::vector<SweepFamily>& results) {
+    std::cout << std::left << std::setw(11) << "family" << std::right << std::setw(7) << "n"
+              << std::setw(8) << "m" << std::setw(13) << "setup[ms]" << std::setw(13) << "solve[ms]"
+              << std::setw(7) << "iter" << "  status\n";
+    for (const auto& r : results) {
+        for (const auto& p : r.points) {
+            std::cout << std::left << std::setw(11) << QP_GENERATOR::ToString(r.family) << std::right
+                      << std::setw(7) << p.n << std::setw(8) << p.nConstraints
+                      << std::setprecision(4) << std::fixed
+                      << std::setw(13) << 1.0e3 * p.setup << std::setw(13) << 1.0e3 * p.solve
+                      << std::defaultfloat << std::setw(7) << p.iterations
+                      << "  " << ToString(p.status) << "\n";
+        }
+    }
+    std::cout << "\ncomplexity exponents, time ~ n^k\n" << std::setprecision(3);
+    for (const auto& r : results) {
+        std::cout << std::left << std::setw(11) << QP_GENERATOR::ToString(r.family) << std::right
+                  << " setup " << r.setupExponent << "  solve " << r.solveExponent
+                  << "  total " << r.totalExponent << "\n";
+        for (std::size_t i = 0; i < nSolverPhases; ++i) {
+            if (!std::isnan(r.phaseExponents[i])) {
+                std::cout << "    " << std::left << std::setw(18) << ToString(static_cast<SolverPhase>(i))
+                          << std::right << r.phaseExponents[i] << "\n";
+            }
+        }
+        for (SolverPhase phase : r.dominant) {
+            std::cout << "    warning: " << ToString(phase) << " grows faster than total solve time\n";
+        }
+    }
+}
+
+void WriteJson(const std::string& file, std::uint64_t seed, int repeats, const std::vector<SweepFamily>& results) {
+    std::ofstream fid(file);
+    JsonWriter json(fid);
+    json.BeginObject();
+    json.Value("benchmark", "sweep");
+    json.Value("seed", seed);
+    json.Value("repeats", repeats);
+    json.BeginArray("families");
+    for (const auto& r : results) {
+        json.BeginObject();
+        json.Value("family", QP_GENERATOR::ToString(r.family));
+        json.BeginArray("points");
+        for (const auto& p : r.points) {
+            json.BeginObject();
+            json.Value("n", p.n);
+            json.Value("nConstraints", p.nConstraints);
+            json.Value("setup", p.setup);
+            json.Value("solve", p.solve);
+            json.Value("iterations", p.iterations);
+            json.Value("repeats", p.repeats);
+            json.Value("dualStatus", ToString(p.status));
+            json.BeginObject("phases");
+            for (std::size_t i = 0; i < nSolverPhases; ++i) {
+                json.Value(ToString(static_cast<SolverPhase>(i)), p.phases[i]);
+            }
+            json.EndObject();
+            json.EndObject();
+        }
+        json.EndArray();
+        json.BeginObject("exponents");
+        json.Value("setup", r.setupExponent);
+        json.Value("solve", r.solveExponent);
+        json.Value("total", r.totalExponent);
+        for (std::size_t i = 0; i < nSolverPhases; ++i) {
+            json.Value(ToString(static_cast<SolverPhase>(i)), r.phaseExponents[i]);
+        }
+        json.EndObject();
+        json.BeginArray("dominantPhases");
+        for (SolverPhase phase : r.dominant) {
+            json.Value("", ToString(phase));
+        }
+        json.EndArray();
+        json.EndObject();
+    }
+    json.EndArray();
+    json.EndObject();
+}
+}
+
+int RunSweep(const BenchOptions& options) {
+    std::vector<QPFamily> families;
+    std::vector<unsg_t> sizes;
+    if (!ParseFamilies(options.Get("families", "all"), families) ||
+        !ParseSizes(options.Get("sizes", "10,20,50,100,200,500,1000,2000,5000"), sizes)) {
+        std::cerr << "usage: nnls_bench sweep [--families all|box,mpc,portfolio,svm,tall]"
+                     " [--sizes 10,20,...] [--seed 1] [--repeats 3] [--max-seconds 10] [--json file]" << std::endl;
+        return 1;
+    }
+    std::sort(sizes.begin(), sizes.end());
+    const std::uint64_t seed = static_cast<std::uint64_t>(std::max(0, options.GetInt("seed", 1)));
+    const int repeats = std::max(1, options.GetInt("repeats", 3));
+    const double maxSeconds = options.GetDouble("max-seconds", 10.0);
+    Settings settings;
+    settings.coreSettings.profile = true; // per phase times of every point
+    std::vector<SweepFamily> results;
+    for (QPFamily family : families) {
+        SweepFamily result;
+        result.family = family;
+        double spent = 0.0;
+        for (unsg_t n : sizes) {
+            // sizes grow geometrically, stop once the family budget is used up
+            if (spent > maxSeconds) {
+                break;
+            }
+            Stopwatch watch;
+            result.points.push_back(Measure(family, n, seed, repeats, maxSeconds - spent, settings));
+            spent += watch.Seconds();
+        }
+        Fit(result);
+        results.push_back(std::move(result));
+    }
+    PrintTable(results);
+    if (options.Has("json")) {
+        WriteJson(options.Get("json", ""), seed, repeats, results);
+    }
+    return 0;
+}
+}
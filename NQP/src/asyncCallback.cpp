@@ -0,0 +1,122 @@
+#include "asyncCallback.h"
+#include <chrono>
+namespace QP_NNLS {
+namespace {
+    constexpr std::chrono::microseconds writerPollInterval(100);
+}
+AsyncTraceSink::AsyncTraceSink(std::unique_ptr<ITraceWriter> writer, std::size_t capacity):
+    writer(std::move(writer)),
+    ring(capacity)
+{
+    worker = std::thread(&AsyncTraceSink::Run, this);
+}
+
+AsyncTraceSink::~AsyncTraceSink() {
+    stop.store(true, std::memory_order_release);
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void AsyncTraceSink::PushInit(InitializationData&& data) {
+    droppedAtInit = dropped.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(stagesMutex);
+    stages.emplace_back();
+    stages.back().stage = 1;
+    stages.back().position = pushed;
+    stages.back().initData = std::move(data);
+    stagesPushed.fetch_add(1, std::memory_order_release);
+}
+
+bool AsyncTraceSink::PushIteration(const IterationData& data) {
+    TraceSnapshot* slot = ring.BeginPush();
+    if (slot == nullptr) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    slot->Set(data);
+    ring.EndPush();
+    ++pushed;
+    return true;
+}
+
+void AsyncTraceSink::PushFinal(FinalData&& data) {
+    std::lock_guard<std::mutex> lock(stagesMutex);
+    stages.emplace_back();
+    stages.back().stage = 3;
+    stages.back().position = pushed;
+    stages.back().nDropped = dropped.load(std::memory_order_relaxed) - droppedAtInit;
+    stages.back().finalData = std::move(data);
+    stagesPushed.fetch_add(1, std::memory_order_release);
+}
+
+void AsyncTraceSink::Flush() {
+    while (written.load(std::memory_order_acquire) < pushed ||
+           stagesWritten.load(std::memory_order_acquire) < stagesPushed.load(std::memory_order_acquire)) {
+        std::this_thread::sleep_for(writerPollInterval);
+    }
+}
+
+bool AsyncTraceSink::WriteStages(bool all) {
+    // writes stages pushed before the next unwritten iteration
+    bool anyWritten = false;
+    while (true) {
+        StageRecord record;
+        {
+            std::lock_guard<std::mutex> lock(stagesMutex);
+            if (stages.empty() ||
+                (!all && stages.front().position > written.load(std::memory_order_relaxed))) {
+                break;
+            }
+            record = std::move(stages.front());
+            stages.pop_front();
+        }
+        if (record.stage == 1) {
+            writer->WriteInit(record.initData);
+        } else {
+            writer->WriteFinal(record.finalData, record.nDropped);
+        }
+        stagesWritten.fetch_add(1, std::memory_order_release);
+        anyWritten = true;
+    }
+    return anyWritten;
+}
+
+void AsyncTraceSink::Run() {
+    while (true) {
+        const bool stopping = stop.load(std::memory_order_acquire);
+        bool idle = !WriteStages(false);
+        if (TraceSnapshot* snapshot = ring.Front()) {
+            writer->WriteIteration(*snapshot);
+            ring.Pop();
+            written.fetch_add(1, std::memory_order_release);
+            idle = false;
+        }
+        if (idle) {
+            if (stopping) {
+                WriteStages(true);
+                break;
+            }
+            std::this_thread::sleep_for(writerPollInterval);
+        }
+    }
+}
+
+AsyncCallback::AsyncCallback(const std::string& filePath, std::size_t capacity):
+    sink(std::make_unique<TextTraceWriter>(filePath), capacity)
+{}
+
+AsyncCallback::AsyncCallback(std::unique_ptr<ITraceWriter> writer, std::size_t capacity):
+    sink(std::move(writer), capacity)
+{}
+
+void AsyncCallback::ProcessData(int stage) {
+    if (stage == 1) {
+        sink.PushInit(std::move(initData));
+    } else if (stage == 2) {
+        sink.PushIteration(iterData);
+    } else if (stage == 3) {
+        sink.PushFinal(std::move(finalData));
+    }
+}
+} // namespace QP_NNLS
@@ -0,0 +1,67 @@
+#ifndef QP_NNLS_ASYNC_CALLBACK_H
+#define QP_NNLS_ASYNC_CALLBACK_H
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "callback.h"
+#include "spscRing.h"
+namespace QP_NNLS {
+    class AsyncTraceSink {
+        // Moves trace formatting and file IO off the solver thread.
+        // Iterations are copied into a lock-free SPSC ring drained by a background
+        // writer thread. If the ring is full the iteration is dropped and counted,
+        // the solver thread never waits for the writer.
+        // Init and final stages are rare and go through a small mutex protected queue,
+        // they are written in order with respect to the iterations.
+    public:
+        AsyncTraceSink() = delete;
+        AsyncTraceSink(std::unique_ptr<ITraceWriter> writer, std::size_t capacity);
+        ~AsyncTraceSink(); // writes everything pushed and joins the writer thread
+        AsyncTraceSink(const AsyncTraceSink& other) = delete;
+        AsyncTraceSink& operator=(const AsyncTraceSink& other) = delete;
+        void PushInit(InitializationData&& data);
+        bool PushIteration(const IterationData& data); // false if dropped
+        void PushFinal(FinalData&& data);
+        void Flush(); // blocks until everything pushed so far is written
+        unsg_t GetDropped() const { return dropped.load(std::memory_order_relaxed); }
+    private:
+        struct StageRecord {
+            int stage = 0;
+            std::size_t position = 0; // number of iterations pushed before the stage
+            unsg_t nDropped = 0;
+            InitializationData initData;
+            FinalData finalData;
+        };
+        void Run();
+        bool WriteStages(bool all);
+        std::unique_ptr<ITraceWriter> writer;
+        SpscRing<TraceSnapshot> ring;
+        std::deque<StageRecord> stages;
+        std::mutex stagesMutex;
+        std::size_t pushed = 0; // producer only
+        unsg_t droppedAtInit = 0; // producer only
+        std::atomic<std::size_t> written{0};
+        std::atomic<std::size_t> stagesPushed{0};
+        std::atomic<std::size_t> stagesWritten{0};
+        std::atomic<unsg_t> dropped{0};
+        std::atomic<bool> stop{false};
+        std::thread worker;
+    };
+
+    class AsyncCallback : public Callback {
+        // Callback1 log format written by AsyncTraceSink
+    public:
+        AsyncCallback(const std::string& filePath, std::size_t capacity = 1024);
+        AsyncCallback(std::unique_ptr<ITraceWriter> writer, std::size_t capacity = 1024);
+        virtual ~AsyncCallback() override = default;
+        void ProcessData(int stage) override;
+        void Flush() { sink.Flush(); }
+        unsg_t GetDropped() const { return sink.GetDropped(); }
+    private:
+        AsyncTraceSink sink;
+    };
+}
+
+#endif // QP_NNLS_ASYNC_CALLBACK_H
@@ -0,0 +1,413 @@
+#include "binaryTrace.h"
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iterator>
+namespace QP_NNLS {
+BinaryTraceWriter::BinaryTraceWriter(const std::string& filePath, bool snapshots):
+    fid(filePath, std::ios::out | std::ios::binary),
+    snapshots(snapshots)
+{
+    fid.write(BINARY_TRACE::magic, sizeof(BINARY_TRACE::magic));
+    const std::uint16_t header[2] = {BINARY_TRACE::version,
+                                     snapshots ? BINARY_TRACE::flagSnapshots : std::uint16_t(0)};
+    fid.write(reinterpret_cast<const char*>(header), sizeof(header));
+}
+
+BinaryTraceWriter::~BinaryTraceWriter() {
+    fid.close();
+}
+
+void BinaryTraceWriter::PutUInt(std::uint64_t value) {
+    while (value >= 0x80) {
+        buf.push_back(static_cast<std::uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    buf.push_back(static_cast<std::uint8_t>(value));
+}
+
+void BinaryTraceWriter::PutDouble(double value) {
+    std::uint8_t bytes[sizeof(double)];
+    std::memcpy(bytes, &value, sizeof(double));
+    buf.insert(buf.end(), bytes, bytes + sizeof(double));
+}
+
+void BinaryTraceWriter::PutVector(const std::vector<double>& v) {
+    PutUInt(v.size());
+    const std::uint8_t* bytes = reinterpret_cast<const std::uint8_t*>(v.data());
+    buf.insert(buf.end(), bytes, bytes + v.size() * sizeof(double));
+}
+
+void BinaryTraceWriter::PutSparse(const std::vector<double>& v) {
+    std::size_t nnz = 0;
+    for (double val : v) {
+        if (val != 0.0) {
+            ++nnz;
+        }
+    }
+    PutUInt(v.size());
+    PutUInt(nnz);
+    std::size_t prev = 0;
+    for (std::size_t i = 0; i < v.size(); ++i) {
+        if (v[i] != 0.0) {
+            PutUInt(i - prev);
+            PutDouble(v[i]);
+            prev = i;
+        }
+    }
+}
+
+void BinaryTraceWriter::PutMatrix(const matrix_t& m) {
+    for (const auto& row : m) {
+        const std::uint8_t* bytes = reinterpret_cast<const std::uint8_t*>(row.data());
+        buf.insert(buf.end(), bytes, bytes + row.size() * sizeof(double));
+    }
+}
+
+void BinaryTraceWriter::PutIndices(const std::vector<unsg_t>& indices) {
+    PutUInt(indices.size());
+    unsg_t prev = 0;
+    for (auto indx : indices) {
+        PutUInt(indx - prev);
+        prev = indx;
+    }
+}
+
+void BinaryTraceWriter::Commit() {
+    fid.write(reinterpret_cast<const char*>(buf.data()), buf.size());
+    buf.clear();
+}
+
+void BinaryTraceWriter::WriteInit(const InitializationData& data) {
+    prevActiveSet.clear();
+    prevHistory.clear();
+    const std::size_t nConstraints = data.M.size();
+    const std::size_t nVariables = data.Chol.size();
+    PutByte(BINARY_TRACE::recordInit);
+    PutUInt(nVariables);
+    PutUInt(nConstraints);
+    PutByte(static_cast<std::uint8_t>(data.InitStatus));
+    PutDouble(data.scaleDB);
+    PutDouble(data.tChol);
+    PutDouble(data.tInv);
+    PutDouble(data.tM);
+    PutVector(data.s);
+    PutVector(data.c);
+    PutVector(data.b);
+    if (snapshots) {
+        PutMatrix(data.Chol);
+        PutMatrix(data.CholInv);
+        PutMatrix(data.M);
+    }
+    Commit();
+}
+
+void BinaryTraceWriter::WriteIteration(const TraceSnapshot& data) {
+    PutByte(BINARY_TRACE::recordIteration);
+    PutUInt(data.iteration);
+    PutUInt(data.newIndex);
+    PutByte(data.singular ? 1 : 0);
+    PutDouble(data.gamma);
+    PutDouble(data.dualTol);
+    PutDouble(data.rsNorm);
+    // active set is sorted, store only the changes
+    added.clear();
+    removed.clear();
+    std::set_difference(data.activeSet.begin(), data.activeSet.end(),
+                        prevActiveSet.begin(), prevActiveSet.end(), std::back_inserter(added));
+    std::set_difference(prevActiveSet.begin(), prevActiveSet.end(),
+                        data.activeSet.begin(), data.activeSet.end(), std::back_inserter(removed));
+    PutIndices(added);
+    PutIndices(removed);
+    prevActiveSet.assign(data.activeSet.begin(), data.activeSet.end());
+    // history grows by push_back and is cleared sometimes, store common prefix and new tail
+    std::size_t common = 0;
+    const std::size_t nHistory = data.activeSetHistory.size();
+    while (common < nHistory && common < prevHistory.size() &&
+           prevHistory[common] == data.activeSetHistory[common]) {
+        ++common;
+    }
+    PutUInt(common);
+    PutUInt(nHistory - common);
+    for (std::size_t i = common; i < nHistory; ++i) {
+        PutUInt(data.activeSetHistory[i]);
+    }
+    prevHistory.assign(data.activeSetHistory.begin(), data.activeSetHistory.end());
+    if (snapshots) {
+        PutSparse(data.zp);
+        PutSparse(data.primal);
+        PutVector(data.dual);
+    }
+    Commit();
+}
+
+void BinaryTraceWriter::WriteFinal(const FinalData& data, unsg_t nDropped) {
+    PutByte(BINARY_TRACE::recordFinal);
+    PutByte(static_cast<std::uint8_t>(data.dualStatus));
+    PutByte(static_cast<std::uint8_t>(data.primalStatus));
+    PutUInt(data.nIterations);
+    PutUInt(nDropped);
+    PutDouble(data.cost);
+    PutVector(data.x);
+    PutVector(data.lambda);
+    PutVector(data.lambdaLw);
+    PutVector(data.lambdaUp);
+    PutVector(data.violations);
+    Commit();
+    fid.flush();
+}
+
+bool BinaryTraceReader::Open(const std::string& filePath) {
+    std::ifstream fid(filePath, std::ios::in | std::ios::binary);
+    if (!fid.is_open()) {
+        return false;
+    }
+    data.assign(std::istreambuf_iterator<char>(fid), std::istreambuf_iterator<char>());
+    pos = 0;
+    const std::size_t headerSize = sizeof(BINARY_TRACE::magic) + 2 * sizeof(std::uint16_t);
+    if (data.size() < headerSize || std::memcmp(data.data(), BINARY_TRACE::magic, sizeof(BINARY_TRACE::magic)) != 0) {
+        return false;
+    }
+    std::uint16_t header[2];
+    std::memcpy(header, data.data() + sizeof(BINARY_TRACE::magic), sizeof(header));
+    if (header[0] != BINARY_TRACE::version) {
+        return false;
+    }
+    flags = header[1];
+    pos = headerSize;
+    return true;
+}
+
+bool BinaryTraceReader::Fits(std::uint64_t count, std::size_t elemSize) const {
+    // count elements of elemSize bytes remain after pos, no overflow of count * elemSize
+    return count <= (data.size() - pos) / elemSize;
+}
+
+bool BinaryTraceReader::GetByte(std::uint8_t& byte) {
+    if (pos >= data.size()) {
+        return false;
+    }
+    byte = data[pos++];
+    return true;
+}
+
+bool BinaryTraceReader::GetUInt(std::uint64_t& value) {
+    value = 0;
+    unsigned shift = 0;
+    std::uint8_t byte = 0;
+    do {
+        if (!GetByte(byte) || shift > 63) {
+            return false;
+        }
+        value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+    return true;
+}
+
+bool BinaryTraceReader::GetUnsg(unsg_t& value) {
+    std::uint64_t v = 0;
+    if (!GetUInt(v)) {
+        return false;
+    }
+    value = static_cast<unsg_t>(v);
+    return true;
+}
+
+bool BinaryTraceReader::GetDouble(double& value) {
+    if (!Fits(1, sizeof(double))) {
+        return false;
+    }
+    std::memcpy(&value, data.data() + pos, sizeof(double));
+    pos += sizeof(double);
+    return true;
+}
+
+bool BinaryTraceReader::GetVector(std::vector<double>& v) {
+    std::uint64_t n = 0;
+    if (!GetUInt(n) || !Fits(n, sizeof(double))) {
+        return false;
+    }
+    v.resize(n);
+    std::memcpy(v.data(), data.data() + pos, n * sizeof(double));
+    pos += n * sizeof(double);
+    return true;
+}
+
+bool BinaryTraceReader::GetSparse(std::vector<double>& v) {
+    std::uint64_t n = 0;
+    std::uint64_t nnz = 0;
+    if (!GetUInt(n) || !GetUInt(nnz) || nnz > n) {
+        return false;
+    }
+    v.assign(n, 0.0);
+    std::uint64_t indx = 0;
+    for (std::uint64_t i = 0; i < nnz; ++i) {
+        std::uint64_t delta = 0;
+        double val = 0.0;
+        if (!GetUInt(delta) || !GetDouble(val)) {
+            return false;
+        }
+        indx += delta;
+        if (indx >= n) {
+            return false;
+        }
+        v[indx] = val;
+    }
+    return true;
+}
+
+bool BinaryTraceReader::GetMatrix(matrix_t& m, std::size_t nRows, std::size_t nCols) {
+    if (nCols > 0 && (!Fits(nCols, sizeof(double)) || nRows > (data.size() - pos) / (nCols * sizeof(double)))) {
+        return false;
+    }
+    m.assign(nRows, std::vector<double>(nCols, 0.0));
+    for (auto& row : m) {
+        std::memcpy(row.data(), data.data() + pos, nCols * sizeof(double));
+        pos += nCols * sizeof(double);
+    }
+    return true;
+}
+
+bool BinaryTraceReader::GetIndices(std::vector<unsg_t>& indices) {
+    std::uint64_t n = 0;
+    if (!GetUInt(n) || n > data.size() - pos) {
+        return false;
+    }
+    indices.resize(n);
+    unsg_t indx = 0;
+    for (auto& i : indices) {
+        unsg_t delta = 0;
+        if (!GetUnsg(delta)) {
+            return false;
+        }
+        indx += delta;
+        i = indx;
+    }
+    return true;
+}
+
+bool BinaryTraceReader::ReadInit() {
+    std::uint8_t status = 0;
+    if (!GetUnsg(nVariables) || !GetUnsg(nConstraints) || !GetByte(status) ||
+        !GetDouble(initData.scaleDB) || !GetDouble(initData.tChol) ||
+        !GetDouble(initData.tInv) || !GetDouble(initData.tM) ||
+        !GetVector(initData.s) || !GetVector(initData.c) || !GetVector(initData.b)) {
+        return false;
+    }
+    initData.InitStatus = static_cast<InitStageStatus>(status);
+    snapshot = TraceSnapshot();
+    nDropped = 0;
+    if (HasSnapshots()) {
+        return GetMatrix(initData.Chol, nVariables, nVariables) &&
+               GetMatrix(initData.CholInv, nVariables, nVariables) &&
+               GetMatrix(initData.M, nConstraints, nVariables);
+    }
+    initData.Chol.clear();
+    initData.CholInv.clear();
+    initData.M.clear();
+    return true;
+}
+
+bool BinaryTraceReader::ReadIteration() {
+    std::uint8_t singular = 0;
+    if (!GetUnsg(snapshot.iteration) || !GetUnsg(snapshot.newIndex) || !GetByte(singular) ||
+        !GetDouble(snapshot.gamma) || !GetDouble(snapshot.dualTol) || !GetDouble(snapshot.rsNorm) ||
+        !GetIndices(added) || !GetIndices(removed)) {
+        return false;
+    }
+    snapshot.singular = singular != 0;
+    std::vector<unsg_t> activeSet;
+    std::set_difference(snapshot.activeSet.begin(), snapshot.activeSet.end(),
+                        removed.begin(), removed.end(), std::back_inserter(activeSet));
+    snapshot.activeSet.clear();
+    std::set_union(activeSet.begin(), activeSet.end(), added.begin(), added.end(),
+                   std::back_inserter(snapshot.activeSet));
+    unsg_t common = 0;
+    unsg_t nTail = 0;
+    if (!GetUnsg(common) || !GetUnsg(nTail) || common > snapshot.activeSetHistory.size()) {
+        return false;
+    }
+    snapshot.activeSetHistory.resize(common);
+    for (unsg_t i = 0; i < nTail; ++i) {
+        unsg_t indx = 0;
+        if (!GetUnsg(indx)) {
+            return false;
+        }
+        snapshot.activeSetHistory.push_back(indx);
+    }
+    if (HasSnapshots()) {
+        return GetSparse(snapshot.zp) && GetSparse(snapshot.primal) && GetVector(snapshot.dual);
+    }
+    return true;
+}
+
+bool BinaryTraceReader::ReadFinal() {
+    std::uint8_t dualStatus = 0;
+    std::uint8_t primalStatus = 0;
+    if (!GetByte(dualStatus) || !GetByte(primalStatus) || !GetUnsg(finalData.nIterations) ||
+        !GetUnsg(nDropped) || !GetDouble(finalData.cost) ||
+        !GetVector(finalData.x) || !GetVector(finalData.lambda) || !GetVector(finalData.lambdaLw) ||
+        !GetVector(finalData.lambdaUp) || !GetVector(finalData.violations)) {
+        return false;
+    }
+    finalData.dualStatus = static_cast<DualLoopExitStatus>(dualStatus);
+    finalData.primalStatus = static_cast<PrimalLoopExitStatus>(primalStatus);
+    return true;
+}
+
+BinaryTraceReader::Record BinaryTraceReader::Next() {
+    std::uint8_t tag = 0;
+    if (!GetByte(tag)) {
+        return Record::END;
+    }
+    if (tag == BINARY_TRACE::recordInit) {
+        return ReadInit() ? Record::INIT : Record::CORRUPTED;
+    } else if (tag == BINARY_TRACE::recordIteration) {
+        return ReadIteration() ? Record::ITERATION : Record::CORRUPTED;
+    } else if (tag == BINARY_TRACE::recordFinal) {
+        return ReadFinal() ? Record::FINAL : Record::CORRUPTED;
+    }
+    return Record::CORRUPTED;
+}
+
+CsvTraceWriter::CsvTraceWriter(const std::string& filePath):
+    fid(filePath, std::ios::out)
+{
+    fid << std::setprecision(15);
+    fid << "solve,iteration,newIndex,singular,gamma,dualTol,rsNorm,activeSetSize,historySize\n";
+}
+
+void CsvTraceWriter::WriteInit(const InitializationData& /*data*/) {
+    ++solve;
+}
+
+void CsvTraceWriter::WriteIteration(const TraceSnapshot& data) {
+    fid << solve << "," << data.iteration << "," << data.newIndex << "," << (data.singular ? 1 : 0) << ","
+        << data.gamma << "," << data.dualTol << "," << data.rsNorm << ","
+        << data.activeSet.size() << "," << data.activeSetHistory.size() << "\n";
+}
+
+void CsvTraceWriter::WriteFinal(const FinalData& /*data*/, unsg_t /*nDropped*/) {
+    fid.flush();
+}
+
+bool DecodeTrace(const std::string& filePath, ITraceWriter& writer) {
+    BinaryTraceReader reader;
+    if (!reader.Open(filePath)) {
+        return false;
+    }
+    while (true) {
+        const BinaryTraceReader::Record record = reader.Next();
+        if (record == BinaryTraceReader::Record::INIT) {
+            writer.WriteInit(reader.GetInit());
+        } else if (record == BinaryTraceReader::Record::ITERATION) {
+            writer.WriteIteration(reader.GetIteration());
+        } else if (record == BinaryTraceReader::Record::FINAL) {
+            writer.WriteFinal(reader.GetFinal(), reader.GetDropped());
+        } else {
+            return record == BinaryTraceReader::Record::END;
+        }
+    }
+}
+} // namespace QP_NNLS
@@ -0,0 +1,112 @@
+#ifndef QP_NNLS_BINARY_TRACE_H
+#define QP_NNLS_BINARY_TRACE_H
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "callback.h"
+namespace QP_NNLS {
+    // Compact binary iteration trace.
+    // file:      "NQPT" | u16 version | u16 flags
+    // init:      'I' | dimensions | scale factor, init timings | s, c, b | [Chol, CholInv, M]
+    // iteration: 'T' | iteration, new index, scalars | active set added / removed (delta coded)
+    //            | history common prefix + new tail | [zp, primal (sparse), dual]
+    // final:     'F' | statuses, iterations, dropped | cost | x, lambda, lambdaLw, lambdaUp, violations
+    // unsigned integers are LEB128 varints, doubles are raw 8 bytes, [..] only with snapshots flag
+    namespace BINARY_TRACE {
+        constexpr char magic[4] = {'N', 'Q', 'P', 'T'};
+        constexpr std::uint16_t version = 2;
+        constexpr std::uint16_t flagSnapshots = 0x01;
+        constexpr char recordInit = 'I';
+        constexpr char recordIteration = 'T';
+        constexpr char recordFinal = 'F';
+    }
+
+    class BinaryTraceWriter : public ITraceWriter {
+    public:
+        BinaryTraceWriter(const std::string& filePath, bool snapshots = false);
+        virtual ~BinaryTraceWriter() override;
+        void WriteInit(const InitializationData& data) override;
+        void WriteIteration(const TraceSnapshot& data) override;
+        void WriteFinal(const FinalData& data, unsg_t nDropped) override;
+        bool IsOpen() const { return fid.is_open(); }
+    private:
+        void PutByte(std::uint8_t byte) { buf.push_back(byte); }
+        void PutUInt(std::uint64_t value);
+        void PutDouble(double value);
+        void PutVector(const std::vector<double>& v);
+        void PutSparse(const std::vector<double>& v);
+        void PutMatrix(const matrix_t& m);
+        void PutIndices(const std::vector<unsg_t>& indices); // sorted, delta coded
+        void Commit();
+        std::ofstream fid;
+        std::vector<std::uint8_t> buf;
+        std::vector<unsg_t> prevActiveSet;
+        std::vector<unsg_t> prevHistory;
+        std::vector<unsg_t> added;
+        std::vector<unsg_t> removed;
+        const bool snapshots;
+    };
+
+    class BinaryTraceReader {
+    public:
+        enum class Record {
+            INIT = 0,
+            ITERATION,
+            FINAL,
+            END,
+            CORRUPTED
+        };
+        BinaryTraceReader() = default;
+        ~BinaryTraceReader() = default;
+        bool Open(const std::string& filePath);
+        Record Next();
+        bool HasSnapshots() const { return (flags & BINARY_TRACE::flagSnapshots) != 0; }
+        unsg_t GetNVariables() const { return nVariables; }
+        unsg_t GetNConstraints() const { return nConstraints; }
+        unsg_t GetDropped() const { return nDropped; }
+        const InitializationData& GetInit() const { return initData; }
+        const TraceSnapshot& GetIteration() const { return snapshot; }
+        const FinalData& GetFinal() const { return finalData; }
+    private:
+        bool Fits(std::uint64_t count, std::size_t elemSize) const;
+        bool GetByte(std::uint8_t& byte);
+        bool GetUInt(std::uint64_t& value);
+        bool GetUnsg(unsg_t& value);
+        bool GetDouble(double& value);
+        bool GetVector(std::vector<double>& v);
+        bool GetSparse(std::vector<double>& v);
+        bool GetMatrix(matrix_t& m, std::size_t nRows, std::size_t nCols);
+        bool GetIndices(std::vector<unsg_t>& indices);
+        bool ReadInit();
+        bool ReadIteration();
+        bool ReadFinal();
+        std::vector<std::uint8_t> data;
+        std::size_t pos = 0;
+        std::uint16_t flags = 0;
+        unsg_t nVariables = 0;
+        unsg_t nConstraints = 0;
+        unsg_t nDropped = 0;
+        std::vector<unsg_t> added;
+        std::vector<unsg_t> removed;
+        InitializationData initData;
+        TraceSnapshot snapshot;
+        FinalData finalData;
+    };
+
+    class CsvTraceWriter : public ITraceWriter {
+        // one line per iteration, for spreadsheets and plotting scripts
+    public:
+        CsvTraceWriter(const std::string& filePath);
+        virtual ~CsvTraceWriter() override = default;
+        void WriteInit(const InitializationData& data) override;
+        void WriteIteration(const TraceSnapshot& data) override;
+        void WriteFinal(const FinalData& data, unsg_t nDropped) override;
+    private:
+        std::ofstream fid;
+        unsg_t solve = 0;
+    };
+
+    bool DecodeTrace(const std::string& filePath, ITraceWriter& writer); // replays binary trace to writer
+}
+#endif // QP_NNLS_BINARY_TRACE_H
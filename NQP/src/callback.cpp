@@ -1,56 +1,96 @@
 #include "callback.h"
 namespace QP_NNLS {
-Callback1::Callback1(const std::string& filePath):
+void TraceSnapshot::Set(const IterationData& data) {
+    // assign() keeps capacity, no allocations once the vectors have grown
+    activeSet.assign(data.activeSet->begin(), data.activeSet->end());
+    activeSetHistory.assign(data.activeSetHistory->begin(), data.activeSetHistory->end());
+    zp.assign(data.zp->begin(), data.zp->end());
+    primal.assign(data.primal->begin(), data.primal->end());
+    dual.assign(data.dual->begin(), data.dual->end());
+    gamma = data.gamma;
+    dualTol = data.dualTol;
+    rsNorm = data.rsNorm;
+    newIndex = data.newIndex;
+    iteration = data.iteration;
+    singular = data.singular;
+}
+
+TextTraceWriter::TextTraceWriter(const std::string& filePath):
     logger(std::make_unique<Logger>())
 {
     logger->SetFile(filePath);
 }
 
+void TextTraceWriter::WriteInit(const InitializationData& data) {
+    logger->SetStage("INITIALIZATION");
+    logger->dump("Choletsky", data.Chol);
+    logger->dump("CholetskyInv", data.CholInv);
+    logger->dump("Matrix M", data.M);
+    logger->dump("vector s", data.s);
+    logger->dump("vector c", data.c);
+    logger->dump("vector b", data.b);
+    logger->message("t Chol", data.tChol);
+    logger->message("t Inv", data.tInv);
+    logger->message("t M", data.tM);
+    logger->message("scale factor DB", data.scaleDB);
+}
+
+void TextTraceWriter::WriteIteration(const TraceSnapshot& data) {
+    logger->message("---ITERATION---", data.iteration);
+    logger->dump("active set", data.activeSet);
+    logger->dump("history", data.activeSetHistory);
+    logger->dump("zp", data.zp);
+    logger->dump("primal", data.primal);
+    logger->dump("dual", data.dual);
+    logger->message("new active component", data.newIndex,
+                    "isSingular", data.singular ? 1 : 0, "gamma", data.gamma,
+                    "dualTol", data.dualTol, "rsdNorm", data.rsNorm);
+}
+
+void TextTraceWriter::WriteFinal(const FinalData& data, unsg_t nDropped) {
+    logger->SetStage("RESULTS");
+    if (nDropped > 0) {
+        logger->message("dropped iterations", nDropped);
+    }
+    if (data.dualStatus == DualLoopExitStatus::INFEASIBILITY) {
+        logger->message("infeasibility");
+    } else if (data.dualStatus == DualLoopExitStatus::ALL_DUAL_POSITIVE) {
+        logger->message("all dual gt tolerance");
+    } else if (data.dualStatus == DualLoopExitStatus::FULL_ACTIVE_SET) {
+        logger->message("full active set");
+    } else if (data.dualStatus == DualLoopExitStatus::ITERATIONS) {
+        logger->message("iterations limit exceeded");
+    } else if (data.dualStatus == DualLoopExitStatus::TIME_LIMIT) {
+        logger->message("time limit exceeded");
+    } else {
+        logger->message("convergence");
+    }
+    if (data.dualStatus != DualLoopExitStatus::INFEASIBILITY) {
+       logger->dump("x", data.x);
+       logger->message("cost", data.cost);
+       logger->dump("lambda", data.lambda);
+       logger->dump("lambdaLw", data.lambdaLw);
+       logger->dump("lambdaUp", data.lambdaUp);
+       logger->dump("violations", data.violations);
+    }
+}
+
+Callback1::Callback1(const std::string& filePath):
+    writer(std::make_unique<TextTraceWriter>(filePath))
+{}
+
+Callback1::Callback1(std::unique_ptr<ITraceWriter> writer):
+    writer(std::move(writer))
+{}
 
 void Callback1::ProcessData(int stage) {
     if (stage == 1) { // dump data after init stage
-        logger->SetStage("INITIALIZATION");
-        logger->dump("Choletsky", initData.Chol);
-        logger->dump("CholetskyInv", initData.CholInv);
-        logger->dump("Matrix M", initData.M);
-        logger->dump("vector s", initData.s);
-        logger->dump("vector c", initData.c);
-        logger->dump("vector b", initData.b);
-        logger->message("t Chol", initData.tChol);
-        logger->message("t Inv", initData.tInv);
-        logger->message("t M", initData.tM);
-        logger->message("scale factor DB", initData.scaleDB);
+        writer->WriteInit(initData);
     } else if (stage == 2) { // dump iteration data
-        logger->message("---ITERATION---", iterData.iteration);
-        logger->dump("active set", *iterData.activeSet);
-        logger->dump("history", *iterData.activeSetHistory);
-        logger->dump("zp", *iterData.zp);
-        logger->dump("primal", *iterData.primal);
-        logger->dump("dual", *iterData.dual);
-        logger->message("new active component", iterData.newIndex,
-                        "isSingular", iterData.singular ? 1 : 0, "gamma", iterData.gamma,
-                        "dualTol", iterData.dualTol, "rsdNorm", iterData.rsNorm);
+        snapshot.Set(iterData);
+        writer->WriteIteration(snapshot);
     }  else if (stage == 3) { // dump final data
-        logger->SetStage("RESULTS");
-        if (finalData.dualStatus == DualLoopExitStatus::INFEASIBILITY) {
-            logger->message("infeasibility");
-        } else if (finalData.dualStatus == DualLoopExitStatus::ALL_DUAL_POSITIVE) {
-            logger->message("all dual gt tolerance");
-        } else if (finalData.dualStatus == DualLoopExitStatus::FULL_ACTIVE_SET) {
-            logger->message("full active set");
-        } else if (finalData.dualStatus == DualLoopExitStatus::ITERATIONS) {
-            logger->message("iterations limit exceeded");
-        } else {
-            logger->message("convergence");
-        }
-        if (finalData.dualStatus != DualLoopExitStatus::INFEASIBILITY) {
-           logger->dump("x", finalData.x);
-           logger->message("cost", finalData.cost);
-           logger->dump("lambda", finalData.lambda);
-           logger->dump("lambdaLw", finalData.lambdaLw);
-           logger->dump("lambdaUp", finalData.lambdaUp);
-           logger->dump("violations", finalData.violations);
-        }
+        writer->WriteFinal(finalData, 0);
     }
 }
 } // namespace QP_NNLS
@@ -31,9 +31,9 @@ namespace QP_NNLS {
     };
     struct InitializationData {
         double scaleDB;
-        std::string tChol;
-        std::string tInv;
-        std::string tM;
+        double tChol; // seconds
+        double tInv;
+        double tM;
         std::vector<double> s;
         std::vector<double> b;
         std::vector<double> c;
@@ -42,6 +42,42 @@ namespace QP_NNLS {
         matrix_t M;
         InitStageStatus InitStatus;
     };
+    struct TraceSnapshot {
+        // owning copy of IterationData, safe to pass to another thread
+        void Set(const IterationData& data);
+        std::vector<unsg_t> activeSet;
+        std::vector<unsg_t> activeSetHistory;
+        std::vector<double> zp;
+        std::vector<double> primal;
+        std::vector<double> dual;
+        double gamma = 0.0;
+        double dualTol = 0.0;
+        double rsNorm = 0.0;
+        unsg_t newIndex = 0;
+        unsg_t iteration = 0;
+        bool singular = false;
+    };
+    class ITraceWriter {
+        // formats solver stages to some output
+    public:
+        virtual ~ITraceWriter() = default;
+        virtual void WriteInit(const InitializationData& data) = 0;
+        virtual void WriteIteration(const TraceSnapshot& data) = 0;
+        virtual void WriteFinal(const FinalData& data, unsg_t nDropped) = 0;
+    protected:
+        ITraceWriter() = default;
+    };
+    class TextTraceWriter : public ITraceWriter {
+        // human readable log through Logger
+    public:
+        TextTraceWriter(const std::string& filePath);
+        virtual ~TextTraceWriter() override = default;
+        void WriteInit(const InitializationData& data) override;
+        void WriteIteration(const TraceSnapshot& data) override;
+        void WriteFinal(const FinalData& data, unsg_t nDropped) override;
+    private:
+        std::unique_ptr<Logger> logger;
+    };
     class Callback {
     public:
         Callback() = default;
@@ -57,10 +93,12 @@ namespace QP_NNLS {
     class Callback1 : public Callback {
     public:
         Callback1(const std::string& filePath);
+        Callback1(std::unique_ptr<ITraceWriter> writer);
         virtual ~Callback1() override = default;
         void ProcessData(int stage) override;
     private:
-        std::unique_ptr<Logger> logger;
+        std::unique_ptr<ITraceWriter> writer;
+        TraceSnapshot snapshot;
     };
 }
 
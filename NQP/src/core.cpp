@@ -4,7 +4,6 @@
 #include <algorithm>
 namespace QP_NNLS {
 Core::Core():
-    timer(std::make_unique<wcTimer>()),
     uCallback(std::make_unique<Callback>())
 {
     ResetProblem();
@@ -21,7 +20,6 @@ void Core::WorkSpace::Clear() {
     c.clear();
     b.clear();
     activeConstraints.clear();
-    linEqConstraints.clear();
     negativeZp.clear();
     v.clear();
     slack.clear();
@@ -29,20 +27,32 @@ void Core::WorkSpace::Clear() {
     H.clear();
     M.clear();
     MS.clear();
+    MF.clear();
+    yF.clear();
+    rowProductF.clear();
     Jac.clear();
     Chol.clear();
     CholInv.clear();
     violations.clear();
+    mCoef.clear();
+    rowWeight.clear();
+    rowProduct.clear();
+    nnlsRow.clear();
+    mRow.clear();
+    bestPrimal.clear();
+    bestActive.clear();
     addHistory = {};
 }
 void Core::SetDefaultSettings() {
     settings = CoreSettings();
+    userPrimalFsb = settings.origPrimalFsb;
 }
 void Core::ResetProblem() {
     ws.Clear();
     nVariables = 0;
     nConstraints = 0;
     nEqConstraints = 0;
+    nUserEqConstraints = 0;
     newActiveIndex = std::numeric_limits<unsg_t>::max();
     rptInterval = 0;
     singularIndex = std::numeric_limits<unsg_t>::max();
@@ -58,10 +68,19 @@ void Core::ResetProblem() {
 }
 void Core::Set(const CoreSettings& settings) {
     this->settings = settings;
+    userPrimalFsb = settings.origPrimalFsb;
+    if (!settings.reuseFactorization) {
+        cachedH.clear();
+        cachedChol.clear();
+        cachedCholInv.clear();
+        cachedBanded = false;
+    }
+    profiler.Enable(settings.profile, settings.profileCpuTime, settings.profileHwCounters);
 }
 void Core::SetCallback(std::unique_ptr<Callback> callback) {
     if (callback != nullptr) {
         uCallback = std::move(callback);
+        userCallback = true;
     }
 }
 bool Core::InitProblem(const DenseQPProblem &problem) {
@@ -69,12 +88,26 @@ bool Core::InitProblem(const DenseQPProblem &problem) {
         return false;
     }
     uCallback->initData.Chol = ws.Chol;
-    uCallback->initData.CholInv = ws.CholInv;
-    uCallback->initData.M = ws.M;
+    if (!banded) {
+        uCallback->initData.CholInv = ws.CholInv;
+    } else if (userCallback) {
+        // the solver works with band solves, the inverse is formed for the trace only
+        uCallback->initData.CholInv.assign(nVariables, std::vector<double>(nVariables, 0.0));
+        InvertBandCholetsky(ws.Chol, bandwidth, uCallback->initData.CholInv);
+    } else {
+        uCallback->initData.CholInv.clear();
+    }
+    uCallback->initData.M.resize(nConstraints);
+    for (unsg_t i = 0; i < nConstraints; ++i) {
+        GetNNLSRow(i, uCallback->initData.M[i]);
+    }
     uCallback->initData.s = ws.s;
     uCallback->initData.c = ws.c;
     uCallback->initData.b = ws.b;
     uCallback->initData.scaleDB = scaleFactorDB;
+    uCallback->initData.tChol = tChol;
+    uCallback->initData.tInv = tInv;
+    uCallback->initData.tM = tM;
     uCallback -> ProcessData(1);
     return true;
 }
@@ -87,49 +120,120 @@ void Core::AllocateWs() {
     ws.lambda.resize(nConstraints, 0.0);
     ws.x.resize(nVariables, 0.0);
     ws.MTY.resize(nVariables, 0.0);
+    ws.nnlsRow.resize(nVariables, 0.0);
     ws.slack.resize(nConstraints, 0.0);
     ws.Chol.resize(nVariables, std::vector<double>(nVariables, 0.0));
-    ws.CholInv.resize(nVariables, std::vector<double>(nVariables, 0.0));
-    ws.M.resize(nConstraints, std::vector<double>(nVariables, 0.0));
+    ws.M.resize(ws.Jac.size(), std::vector<double>(nVariables, 0.0));
+    ws.rowWeight.resize(ws.Jac.size(), 0.0);
+    ws.rowProduct.resize(ws.Jac.size(), 0.0);
     ws.activeConstraints.clear();
     ws.addHistory.clear();
 }
-void Core::ExtendJacobian(const matrix_t& Jac, const std::vector<double>& b,
+void Core::ExtendJacobian(const matrix_t& Jac, const std::vector<double>& b, const std::vector<double>& bLw,
                           const std::vector<double>& lb, const std::vector<double>& ub) {
+    // rows of Jac and M: A, then e_i of every variable
+    // NNLS rows: A, then +e_i (upper) and -e_i (lower bound) of every variable, then -A_i of ranged rows,
+    // then -A_i of equality rows; both sides of a row share one row of Jac and M and differ by the sign in mCoef
+    const unsg_t nRows = nConstraints + nVariables;
     ws.Jac = Jac;
-    ws.Jac.resize(ws.Jac.size() + 2 * nVariables, std::vector<double>(nVariables, 0.0));
+    ws.Jac.resize(nRows, std::vector<double>(nVariables, 0.0));
     ws.b = b;
-    ws.b.resize(ws.b.size() + 2 * nVariables, 0.0);
+    ws.mRow.resize(nConstraints);
+    ws.mCoef.assign(nConstraints, 1.0);
+    for (unsg_t i = 0; i < nConstraints; ++i) {
+        ws.mRow[i] = i;
+    }
+    const auto addSide = [this](unsg_t row, double sign, double rhs) {
+        ws.mRow.push_back(row);
+        ws.mCoef.push_back(sign);
+        ws.b.push_back(rhs);
+    };
     for (unsg_t i = 0; i < nVariables; ++i) {
-        const int ibg = nConstraints + 2 * i;
-        ws.Jac[ibg][i] = 1.0;
-        ws.Jac[ibg + 1][i] = -1.0;
-        ws.b[ibg] = ub[i];
-        ws.b[ibg + 1] = -lb[i];
+        ws.Jac[nConstraints + i][i] = 1.0;
+        addSide(nConstraints + i, 1.0, ub[i]);
+        addSide(nConstraints + i, -1.0, -lb[i]);
+    }
+    for (unsg_t i = nEqConstraints; i < bLw.size(); ++i) {
+        if (bLw[i] > -CONSTANTS::infiniteBound) {
+            addSide(i, -1.0, -bLw[i]);
+        }
+    }
+    for (unsg_t i = 0; i < nEqConstraints; ++i) {
+        addSide(i, -1.0, -b[i]);
     }
-    nConstraints += 2 * nVariables;
+    nConstraints = static_cast<unsg_t>(ws.b.size());
     ws.violations.resize(nConstraints, 0.0);
 }
-bool Core::PrepareNNLS(const DenseQPProblem &problem) {
-    initStatus = InitStageStatus::SUCCESS;
-    nVariables = static_cast<unsg_t>(problem.H.size());
-    nConstraints = static_cast<unsg_t>(problem.A.size());
-    for (unsg_t i = 0; i < nEqConstraints; ++i) {
-        ws.linEqConstraints.insert(i);
+void Core::GetNNLSRow(unsg_t indx, std::vector<double>& row) const {
+    const std::vector<double>& mRow = ws.M[ws.mRow[indx]];
+    const double coef = ws.mCoef[indx];
+    row.resize(nVariables);
+    for (unsg_t j = 0; j < nVariables; ++j) {
+        row[j] = coef * mRow[j];
+    }
+}
+void Core::MultNNLS(const std::vector<double>& v, std::vector<double>& Mv) {
+    // one product per row of M, the sides of a range reuse it
+    Mult(ws.M, v, ws.rowProduct);
+    for (unsg_t i = 0; i < nConstraints; ++i) {
+        Mv[i] = ws.mCoef[i] * ws.rowProduct[ws.mRow[i]];
+    }
+}
+void Core::MultTranspNNLS(const std::vector<double>& y, std::vector<double>& MTy) {
+    for (unsg_t i = 0; i < nConstraints; ++i) {
+        ws.rowWeight[ws.mRow[i]] += ws.mCoef[i] * y[i];
+    }
+    MultTransp(ws.M, ws.rowWeight, MTy);
+    std::fill(ws.rowWeight.begin(), ws.rowWeight.end(), 0.0);
+}
+void Core::MultTranspNNLS(const std::vector<double>& y, const std::set<unsg_t>& indices, std::vector<double>& MTy) {
+    // weights of the rows of M are accumulated first, sides of a range cost one row update
+    std::fill(MTy.begin(), MTy.end(), 0.0);
+    for (auto i : indices) {
+        ws.rowWeight[ws.mRow[i]] += ws.mCoef[i] * y[i];
+    }
+    for (auto i : indices) {
+        const unsg_t row = ws.mRow[i];
+        const double w = ws.rowWeight[row];
+        if (w != 0.0) {
+            const std::vector<double>& m = ws.M[row];
+            for (unsg_t j = 0; j < nVariables; ++j) {
+                MTy[j] += w * m[j];
+            }
+            ws.rowWeight[row] = 0.0;
+        }
+    }
+}
+bool Core::Factorize(const DenseQPProblem& problem) {
+    // H of SQP subproblems often stays the same between iterations, the O(n^3) part is skipped then
+    const bool cacheable = settings.reuseFactorization && settings.cholPvtStrategy == CholPivotingStrategy::NO_PIVOTING;
+    if (cacheable && !cachedChol.empty() && cachedH == problem.H) {
+        ws.Chol = cachedChol;
+        ws.CholInv = cachedCholInv;
+        bandwidth = cachedBandwidth;
+        banded = cachedBanded;
+        counters.factorizationReused = true;
+        counters.bandedFactorization = banded;
+        counters.hessianBandwidth = banded ? bandwidth : 0;
+        return true;
     }
-    ws.activeConstraints = ws.linEqConstraints;
-    nEqConstraints = problem.nEqConstraints;
-    ws.H = problem.H;
-    ws.c = problem.c;
-    ExtendJacobian(problem.A, problem.b, problem.lw, problem.up);
-    SetRptInterval();
-    AllocateWs();
     //uCallback->initData.InitStatus = InitStageStatus::CHOLETSKY;
-    timer->Start();
+    initTimer.Start();
+    profiler.Begin(SolverPhase::CHOLETSKY);
+    banded = false;
     if (settings.cholPvtStrategy == CholPivotingStrategy::NO_PIVOTING) {
+        // MPC and multistage problems have block diagonal or block tridiagonal H, L of H = L_T * L
+        // keeps the band: O(n * bw^2) factorization and O(n * bw) solves instead of O(n^3) and O(n^2)
+        if (settings.hessianStructure != HessianStructure::DENSE) {
+            bandwidth = Bandwidth(problem.H);
+            banded = settings.hessianStructure == HessianStructure::BANDED || 4 * (bandwidth + 1) <= nVariables;
+        }
         CholetskyOutput cholOutput;
-        if(!ComputeCholFactorT(problem.H, ws.Chol, cholOutput)) {   // H = L_T * L
+        const bool factorized = banded ? ComputeBandCholFactorT(problem.H, bandwidth, ws.Chol, cholOutput)
+                                       : ComputeCholFactorT(problem.H, ws.Chol, cholOutput); // H = L_T * L
+        if (!factorized) {
             initStatus = InitStageStatus::CHOLETSKY;
+            profiler.End();
             return false;
         }
     } else if (settings.cholPvtStrategy == CholPivotingStrategy::FULL) {
@@ -141,47 +245,162 @@ bool Core::PrepareNNLS(const DenseQPProblem &problem) {
         // A * x <= b  A * P * x_n <= b  A_n = A * P   A_n * x_n <= b
         if (ComputeCholFactorTFullPivoting(ws.H, ws.Chol, ws.pmt) != 0) { // H -> H_n
             initStatus = InitStageStatus::CHOLETSKY;
+            profiler.End();
             return false;
         }
         PermuteColumns(ws.Jac, ws.pmt);
         PTV(ws.c, ws.pmt);
     }
-    TimePoint(uCallback -> initData.tChol);
-    InvertCholetsky(ws.Chol, ws.CholInv);   // Q^-1
-    TimePoint(uCallback -> initData.tInv);
-    Mult(ws.Jac, ws.CholInv, ws.M);           // M = A * Q^-1   nConstraints x nVariables
-    TimePoint(uCallback -> initData.tM);
-    MultTransp(ws.CholInv, ws.c, ws.v);    // v = Q^-T * d nVariables
-    std::vector<double> MByV(nConstraints);
-    Mult(ws.M, ws.v, MByV);                // M * v nConstraints
-    VSum(MByV, ws.b, ws.s);
-    ortScaler = std::make_unique<OrtScaler>(ws.M, ws.s);
-    ortScaler -> Scale();
-    const ScaleCoefs& sCoefs = ortScaler -> GetScaleCoefs();
-    scaleFactorDB = sCoefs.scaleFactorS;
-    settings.origPrimalFsb *= scaleFactorDB;
-    ScaleD();
+    profiler.End();
+    tChol = InitLap();
+    const double n = static_cast<double>(nVariables);
+    const double w = static_cast<double>(bandwidth + 1);
+    counters.Flops(SolverPhase::CHOLETSKY) = banded ? n * w * w : n * n * n / 3.0;
+    counters.Flops(SolverPhase::INVERSION) = banded ? 0.0 : n * n * n / 3.0;
+    counters.bandedFactorization = banded;
+    counters.hessianBandwidth = banded ? bandwidth : 0;
+    if (banded) {
+        ws.CholInv.clear();
+    } else {
+        PhaseProfiler::Scope scope(profiler, SolverPhase::INVERSION);
+        ws.CholInv.assign(nVariables, std::vector<double>(nVariables, 0.0));
+        InvertCholetsky(ws.Chol, ws.CholInv);   // Q^-1
+    }
+    tInv = InitLap();
+    if (cacheable) {
+        cachedH = problem.H;
+        cachedChol = ws.Chol;
+        cachedCholInv = ws.CholInv;
+        cachedBandwidth = bandwidth;
+        cachedBanded = banded;
+    }
+    return true;
+}
+double Core::InitLap() {
+    const double lap = 1.0e-9 * static_cast<double>(initTimer.NsFromStart());
+    initTimer.Start();
+    return lap;
+}
+bool Core::PrepareNNLS(const DenseQPProblem &userProblem) {
+    initStatus = InitStageStatus::SUCCESS;
+    profiler.Reset();
+    counters = SolverCounters();
+    tChol = 0.0;
+    tInv = 0.0;
+    tM = 0.0;
+    presolved = false;
+    if (settings.presolve) {
+        PhaseProfiler::Scope scope(profiler, SolverPhase::PRESOLVE);
+        presolved = presolver.Apply(userProblem);
+    }
+    const DenseQPProblem& presolvedProblem = presolved ? presolver.GetProblem() : userProblem;
+    if (presolved) {
+        counters.presolveRows = static_cast<unsg_t>(userProblem.A.size() - presolvedProblem.A.size());
+        counters.presolveVariables = static_cast<unsg_t>(userProblem.H.size() - presolvedProblem.H.size());
+    }
+    eliminated = false;
+    if (settings.eliminateEqualities && presolvedProblem.nEqConstraints > 0) {
+        PhaseProfiler::Scope scope(profiler, SolverPhase::PRESOLVE);
+        eliminated = nullSpace.Apply(presolvedProblem);
+        counters.eliminatedEqualities = eliminated ? presolvedProblem.nEqConstraints : 0;
+    }
+    const DenseQPProblem& problem = eliminated ? nullSpace.GetProblem() : presolvedProblem;
+    nUserEqConstraints = userProblem.nEqConstraints;
+    nVariables = static_cast<unsg_t>(problem.H.size());
+    nConstraints = static_cast<unsg_t>(problem.A.size());
+    nEqConstraints = problem.nEqConstraints;
+    ws.H = problem.H;
+    ws.c = problem.c;
+    ExtendJacobian(problem.A, problem.b, problem.bLw, problem.lw, problem.up);
+    SetRptInterval();
+    AllocateWs();
+    // origPrimalFsb is scaled below, keep the solver reusable for the next problem
+    settings.origPrimalFsb = userPrimalFsb;
+    if (!Factorize(problem)) {
+        return false;
+    }
+    const double n = static_cast<double>(nVariables);
+    const double nc = static_cast<double>(nConstraints);
+    const double nr = static_cast<double>(ws.Jac.size());
+    const double w = banded ? static_cast<double>(bandwidth + 1) : n;
+    counters.Flops(SolverPhase::M_FORMATION) = 2.0 * nr * n * w + 2.0 * n * w + 2.0 * nr * n + 2.0 * nc;
+    counters.Flops(SolverPhase::SCALING) = 2.0 * nr * n + 6.0 * nc;
+    initTimer.Start();
+    {
+        PhaseProfiler::Scope scope(profiler, SolverPhase::M_FORMATION);
+        if (banded && bandwidth == 0) {
+            // diagonal H: Q^-1 is diagonal, M scales the columns of A
+            std::vector<double> diagInv(nVariables);
+            for (unsg_t j = 0; j < nVariables; ++j) {
+                diagInv[j] = 1.0 / ws.Chol[j][j];
+                ws.v[j] = ws.c[j] * diagInv[j];
+            }
+            for (std::size_t i = 0; i < ws.Jac.size(); ++i) {
+                for (unsg_t j = 0; j < nVariables; ++j) {
+                    ws.M[i][j] = ws.Jac[i][j] * diagInv[j];
+                }
+            }
+        } else if (banded) {
+            for (std::size_t i = 0; i < ws.Jac.size(); ++i) {
+                SolveBandCholetskyT(ws.Chol, bandwidth, ws.Jac[i], ws.M[i]); // M_T = Q^-T * A_T
+            }
+            SolveBandCholetskyT(ws.Chol, bandwidth, ws.c, ws.v);
+        } else {
+            Mult(ws.Jac, ws.CholInv, ws.M);           // M = A * Q^-1   rows of Jac x nVariables
+            MultTransp(ws.CholInv, ws.c, ws.v);    // v = Q^-T * d nVariables
+        }
+        std::vector<double> MByV(nConstraints);
+        MultNNLS(ws.v, MByV);                  // M * v nConstraints
+        VSum(MByV, ws.b, ws.s);
+        ws.MF.clear();
+        if (settings.mixedPrecision) {
+            ws.MF.resize(ws.M.size());
+            for (std::size_t i = 0; i < ws.M.size(); ++i) {
+                ws.MF[i].assign(ws.M[i].begin(), ws.M[i].end());
+            }
+            ws.yF.resize(nVariables);
+            ws.rowProductF.resize(ws.M.size());
+        }
+    }
+    tM = InitLap();
+    {
+        PhaseProfiler::Scope scope(profiler, SolverPhase::SCALING);
+        std::vector<double> rowNorm2(ws.M.size(), 0.0);
+        for (std::size_t i = 0; i < ws.M.size(); ++i) {
+            rowNorm2[i] = DotProduct(ws.M[i], ws.M[i]);
+        }
+        std::vector<double> mNorm2(nConstraints);
+        for (unsg_t i = 0; i < nConstraints; ++i) {
+            mNorm2[i] = rowNorm2[ws.mRow[i]];
+        }
+        ortScaler = std::make_unique<OrtScaler>(std::move(mNorm2), ws.s);
+        ortScaler -> Scale();
+        for (unsg_t i = 0; i < nConstraints; ++i) {
+            ws.mCoef[i] *= ortScaler->GetRowScale(i);
+        }
+        const ScaleCoefs& sCoefs = ortScaler -> GetScaleCoefs();
+        scaleFactorDB = sCoefs.scaleFactorS;
+        settings.origPrimalFsb *= scaleFactorDB;
+        ScaleD();
+    }
     if (settings.linSolverType == LinSolverType::CUMULATIVE_LDLT) {
-        lSolver = std::make_unique<CumulativeLDLTSolver>(ws.M, ws.s);
+        lSolver = std::make_unique<CumulativeLDLTSolver>(nConstraints, nVariables);
     } else if (settings.linSolverType == LinSolverType::CUMULATIVE_EG_LDLT) {
-        lSolver = std::make_unique<CumulativeEGNSolver>(ws.M, ws.s);
+        lSolver = std::make_unique<CumulativeEGNSolver>(nConstraints, nVariables);
     }
     else if (settings.linSolverType == LinSolverType::MSS1) {
-        lSolver = std::make_unique<MssCumulativeSolver>(ws.M, ws.s);
+        if (settings.mixedPrecision) {
+            lSolver = std::make_unique<MssCumulativeSolverT<float>>(nConstraints, nVariables);
+        } else {
+            lSolver = std::make_unique<MssCumulativeSolver>(nConstraints, nVariables);
+        }
     }
+    retiredStats = LinSolverStats();
     return true;
 }
-void Core::TimePoint(std::string& buf) {
-    TimeIntervals tIntervals;
-    timer->toIntervals(timer->Ticks(), tIntervals);
-    buf = std::to_string(tIntervals.minutes) + " min " +
-          std::to_string(tIntervals.sec) + " sec " +
-          std::to_string(tIntervals.ms) + " ms " +
-          std::to_string(tIntervals.mus) + " mus";
-}
-
 bool Core::OrigInfeasible() {
-    MultTransp(ws.M, ws.primal, ws.activeConstraints, ws.MTY); // M_T * primal
+    counters.Flops(SolverPhase::PRICING) += 2.0 * (ws.activeConstraints.size() + 1) * (nVariables + 1);
+    MultTranspNNLS(ws.primal, ws.activeConstraints, ws.MTY); // M_T * primal
     styGamma = gamma + DotProduct(ws.s, ws.primal, ws.activeConstraints);
     rsNorm = DotProduct(ws.MTY, ws.MTY) + styGamma * styGamma;
     return rsNorm < settings.nnlsResidNormFsb;
@@ -191,7 +410,18 @@ bool Core::FullActiveSet() {
     return (static_cast<unsg_t>(ws.activeConstraints.size()) == nConstraints);
 }
 void Core::ComputeDualVariable() {
-    Mult(ws.M, ws.MTY, ws.dual); // M * M_T * primal
+    counters.Flops(SolverPhase::PRICING) += 2.0 * ws.M.size() * nVariables + 6.0 * nConstraints;
+    if (lowPrecision) {
+        // float M * M_T * primal, half the memory traffic of the double product
+        std::copy(ws.MTY.begin(), ws.MTY.end(), ws.yF.begin());
+        Mult(ws.MF, ws.yF, ws.rowProductF);
+        for (unsg_t i = 0; i < nConstraints; ++i) {
+            ws.dual[i] = ws.mCoef[i] * ws.rowProductF[ws.mRow[i]];
+        }
+        ++counters.lowPrecisionIterations;
+    } else {
+        MultNNLS(ws.MTY, ws.dual); // M * M_T * primal
+    }
     for (unsg_t i = 0; i < nConstraints; ++i) {
         ws.dual[i] += styGamma * ws.s[i];
     }
@@ -225,13 +455,18 @@ bool Core::SkipCandidate(unsg_t indx) {
 void Core::AddToActiveSet(unsg_t indx) {
     ws.activeConstraints.insert(indx);
     ws.addHistory.push_back(indx);
-    lSolver->Add(ws.M[indx], ws.s[indx], indx);
+    ++counters.activeSetAdds;
+    counters.peakActiveSet = std::max(counters.peakActiveSet, static_cast<unsg_t>(ws.activeConstraints.size()));
+    PhaseProfiler::Scope scope(profiler, SolverPhase::LS_ADD);
+    GetNNLSRow(indx, ws.nnlsRow);
+    lSolver->Add(ws.nnlsRow, ws.s[indx], indx);
 }
 void Core::RmvFromActiveSet(unsg_t indx) {
-    if (ws.linEqConstraints.find(indx) == ws.linEqConstraints.end()) {
-        ws.activeConstraints.erase(indx);
-        lSolver->Delete(indx);
+    if (ws.activeConstraints.erase(indx) > 0) {
+        ++counters.activeSetDeletes;
     }
+    PhaseProfiler::Scope scope(profiler, SolverPhase::LS_DELETE);
+    lSolver->Delete(indx);
 }
 
 bool Core::IsCandidateForNewActive(unsg_t indx, double toCompare, bool skip) {
@@ -283,7 +518,12 @@ unsg_t Core::SelectNewActiveComponent() {
 unsg_t Core::SolvePrimal() {
     const std::size_t nActive = ws.activeConstraints.size();
     lSolver->SetGamma(gamma);
+    profiler.Begin(SolverPhase::LS_SOLVE);
     const LinSolverOutput& output = lSolver -> Solve();
+    profiler.End();
+    if (output.nDNegative > 0 && output.nDNegative != std::numeric_limits<unsg_t>::max()) {
+        ++counters.singularSolves;
+    }
     std::fill(ws.zp.begin(), ws.zp.end(), 0.0);
     if (!settings.actSetUpdtSettings.rejectSingular) {
         //const auto& sol= linSolver.GetSolution();;
@@ -304,6 +544,7 @@ unsg_t Core::SolvePrimal() {
 }
 
 bool Core::MakeLineSearch() {
+    PhaseProfiler::Scope scope(profiler, SolverPhase::LINE_SEARCH);
     double minStep = std::numeric_limits<double>::max();
     bool stepFound = false;
     // case if all zp are non-negative must be proccessed before this function, negativePrimalIndices must not be empty
@@ -314,7 +555,10 @@ bool Core::MakeLineSearch() {
             stepFound = true;
         }
     }
+    counters.Flops(SolverPhase::LINE_SEARCH) += 3.0 * ws.negativeZp.size();
     if (stepFound) {
+        ++counters.lineSearchSteps;
+        counters.Flops(SolverPhase::LINE_SEARCH) += 3.0 * nConstraints;
         //primal_next = primal + step * (zp - primal)
         gammaCorrection = 0.0;
         for (unsg_t i = 0; i < nConstraints; ++i) {
@@ -398,12 +642,72 @@ void Core::ComputeCost() {
         cost += 0.5 * ws.H[i][i] * ws.x[i] * ws.x[i];
     }
 }
+double Core::ActiveSetResidual(std::vector<double>& r) {
+    const std::size_t k = ws.activeConstraints.size();
+    counters.Flops(SolverPhase::SOLUTION_RECOVERY) += 4.0 * k * nVariables + 2.0 * k;
+    MultTranspNNLS(ws.lambda, ws.activeConstraints, ws.MTY);
+    r.resize(k);
+    double rMax = 0.0;
+    std::size_t ii = 0;
+    for (auto i : ws.activeConstraints) {
+        r[ii] = ws.s[i] - ws.mCoef[i] * DotProduct(ws.M[ws.mRow[i]], ws.MTY);
+        rMax = std::fmax(rMax, std::fabs(r[ii++]));
+    }
+    return rMax;
+}
+bool Core::RefineLambdaOnActiveSet() {
+    // lambdas from the primal are corrected by M_A * M_A_T * d = r solved with the factorization
+    // the linear solver holds for the final active set, residuals are computed in double
+    double sMax = 0.0;
+    for (auto i : ws.activeConstraints) {
+        sMax = std::fmax(sMax, std::fabs(ws.s[i]));
+    }
+    const double target = settings.lambdaRefinementTol * std::fmax(sMax, 1.0);
+    std::vector<double> r;
+    std::vector<double> d;
+    std::vector<double> best(ws.activeConstraints.size());
+    double rMax = ActiveSetResidual(r);
+    for (unsg_t step = 0; step < settings.lambdaRefinementSteps && rMax > target; ++step) {
+        if (!lSolver->SolveGram(r, d)) {
+            if (step == 0) {
+                return false;
+            }
+            break;
+        }
+        std::size_t ii = 0;
+        for (auto i : ws.activeConstraints) {
+            best[ii] = ws.lambda[i];
+            ws.lambda[i] += d[ii++];
+        }
+        ++counters.lambdaRefinements;
+        const double rNext = ActiveSetResidual(r);
+        if (!(rNext < rMax)) {
+            // no progress: rounding of the factorization dominates, keep the previous iterate
+            ii = 0;
+            for (auto i : ws.activeConstraints) {
+                ws.lambda[i] = best[ii++];
+            }
+            break;
+        }
+        rMax = rNext;
+    }
+    counters.lambdaResidual = rMax;
+    counters.lambdaFactorizationReused = true;
+    return true;
+}
 void Core::ComputeExactLambdaOnActiveSet() {
     // Correct lambdas for active constraints to improve feasibility
+    if (ws.activeConstraints.empty() || RefineLambdaOnActiveSet()) {
+        return;
+    }
+    counters.lambdaFactorizationReused = false;
+    const double k = static_cast<double>(ws.activeConstraints.size());
+    counters.Flops(SolverPhase::SOLUTION_RECOVERY) += 2.0 * k * k * nVariables + k * k * k / 3.0 + 2.0 * k * k;
     matrix_t M;
     std::vector<double> s;
     for (auto i :ws.activeConstraints) {
-        M.push_back(ws.M[i]);
+        M.emplace_back();
+        GetNNLSRow(i, M.back());
         s.push_back(ws.s[i]);
     }
     if (M.empty()) {
@@ -419,23 +723,24 @@ void Core::ComputeExactLambdaOnActiveSet() {
 }
 
 void Core::ComputeDualityGap() {
+    counters.Flops(SolverPhase::DUALITY_GAP) += 6.0 * ws.M.size() * nVariables + nVariables * nVariables + 12.0 * nConstraints;
     // x, lambda must be correct!
     // For original problem
     // A * x_opt - b = -s - M * M_T * lambda
     // Compute -s - M * M_T * lambda
     std::vector<double> MMTL(nConstraints);
     std::vector<double> violations(nConstraints);
-    MultTransp(ws.M, ws.lambda, ws.MTY);
-    Mult(ws.M, ws.MTY, MMTL);
+    MultTranspNNLS(ws.lambda, ws.MTY);
+    MultNNLS(ws.MTY, MMTL);
     VSum(MMTL, ws.s, violations);
     const double lamTByS = DotProduct(ws.lambda, ws.s);
     const double vTv = DotProduct(ws.v, ws.v);
     const double mty2 = DotProduct(ws.MTY, ws.MTY);
     const double dualValue = -0.5 * (mty2 + vTv) - lamTByS;
-    std::vector<double> Ax(nConstraints);
+    std::vector<double> Ax(ws.Jac.size());
     Mult(ws.Jac, ws.x, Ax);
-    for (auto i = 0; i < nConstraints; ++i) {
-        ws.violations[i] = Ax[i] - ws.b[i];
+    for (unsg_t i = 0; i < nConstraints; ++i) {
+        ws.violations[i] = std::copysign(1.0, ws.mCoef[i]) * Ax[ws.mRow[i]] - ws.b[i];
     }
     const double fsb = DotProduct(ws.violations, ws.lambda);
     ComputeCost();
@@ -447,6 +752,9 @@ void Core::SetRptInterval(){
 }
 
 void Core::ComputeOrigSolution() {
+    const double k = static_cast<double>(ws.activeConstraints.size());
+    const double w = banded ? static_cast<double>(bandwidth + 1) : static_cast<double>(nVariables);
+    counters.Flops(SolverPhase::SOLUTION_RECOVERY) += 2.0 * k * nVariables + 2.0 * nVariables * w + 3.0 * nConstraints;
     double sty = DotProduct(ws.s, ws.primal, ws.activeConstraints);
     double lambdaTerm = -1.0 / (gamma + sty);
     for (unsg_t i = 0; i < nConstraints; ++i) {
@@ -454,12 +762,16 @@ void Core::ComputeOrigSolution() {
     }
     ComputeExactLambdaOnActiveSet();
     std::vector<double> u(nVariables, 0.0);
-    MultTransp(ws.M, ws.lambda, ws.activeConstraints, u);
+    MultTranspNNLS(ws.lambda, ws.activeConstraints, u);
     std::vector<double> u_v(nVariables);
     for (unsg_t i = 0; i < nVariables; ++i) {
         u_v[i] = u[i] - ws.v[i];
     }
-    Mult(ws.CholInv, u_v, ws.x);
+    if (banded) {
+        SolveBandCholetsky(ws.Chol, bandwidth, u_v, ws.x); // x = Q^-1 * (u - v)
+    } else {
+        Mult(ws.CholInv, u_v, ws.x);
+    }
     for (unsg_t i = 0; i < nConstraints; ++i) {
         ws.lambda[i] *= -1.0;
     }
@@ -472,7 +784,7 @@ void Core::FillOutput() {
     output.primalExitStatus = primalExitStatus;
     if (dualExitStatus != DualLoopExitStatus::INFEASIBILITY){
         output.x = ws.x;
-        const std::size_t nc = nConstraints - 2 * nVariables;
+        const std::size_t nc = ws.Jac.size() - nVariables;
         output.lambda.resize(nc, 0.0);
         output.lambdaLw.resize(nVariables, 0.0);
         output.lambdaUp.resize(nVariables, 0.0);
@@ -483,11 +795,57 @@ void Core::FillOutput() {
             output.lambdaUp[i] = ws.lambda[nc + 2 * i];
             output.lambdaLw[i] = ws.lambda[nc + 2 * i + 1];
         }
-        output.violations = ws.violations;
+        // multipliers of equality rows are signed, their lower sides are not part of the output layout
+        const std::size_t eqSides = nConstraints - nEqConstraints;
+        output.lambdaRowLw.clear();
+        if (eqSides > nc + 2 * nVariables) {
+            output.lambdaRowLw.resize(nc, 0.0);
+            for (std::size_t i = nc + 2 * nVariables; i < eqSides; ++i) {
+                output.lambdaRowLw[ws.mRow[i]] = ws.lambda[i];
+            }
+        }
+        for (std::size_t i = eqSides; i < nConstraints; ++i) {
+            output.lambda[ws.mRow[i]] -= ws.lambda[i];
+        }
+        output.violations.assign(ws.violations.begin(), ws.violations.begin() + eqSides);
+        output.activeSet.clear();
+        for (auto i : ws.activeConstraints) {
+            if (i < eqSides) {
+                output.activeSet.push_back(i);
+            } else if (ws.activeConstraints.find(ws.mRow[i]) == ws.activeConstraints.end()) {
+                output.activeSet.push_back(ws.mRow[i]);
+            }
+        }
+        std::sort(output.activeSet.begin(), output.activeSet.end());
         output.dualityGap = dualityGap;
         output.cost = cost;
+        if (eliminated || presolved) {
+            PhaseProfiler::Scope scope(profiler, SolverPhase::PRESOLVE);
+            if (eliminated) {
+                nullSpace.Postsolve(output);
+            }
+            if (presolved) {
+                presolver.Postsolve(output);
+            }
+        }
+        // violations of equality rows are A_i * x - b_i, both signs are infeasible
+        output.maxViolation = 0.0;
+        for (std::size_t i = 0; i < output.violations.size(); ++i) {
+            const double v = output.violations[i];
+            output.maxViolation = std::fmax(output.maxViolation, i < nUserEqConstraints ? std::fabs(v) : v);
+        }
     }
     output.nDualIterations = dualIteration;
+    profiler.Fill(output.profile);
+    output.counters = counters;
+    if (lSolver != nullptr) {
+        const LinSolverStats& stats = lSolver->GetStats();
+        output.counters.refactorizations = stats.refactorizations + retiredStats.refactorizations;
+        output.counters.activeSetChanges = stats.activeSetChanges + retiredStats.activeSetChanges;
+        output.counters.Flops(SolverPhase::LS_ADD) = stats.flopsAdd + retiredStats.flopsAdd;
+        output.counters.Flops(SolverPhase::LS_DELETE) = stats.flopsDelete + retiredStats.flopsDelete;
+        output.counters.Flops(SolverPhase::LS_SOLVE) = stats.flopsSolve + retiredStats.flopsSolve;
+    }
 }
 
 void Core::SetIterationData() {
@@ -521,39 +879,99 @@ void Core::SetFinalData() {
     uCallback->ProcessData(3);
 }
 
-void Core::Solve() {
-    dualExitStatus = DualLoopExitStatus::UNKNOWN;
-    primalExitStatus = PrimalLoopExitStatus::DIDNT_STARTED;
-    dualIteration = 0;
-    gamma = 1.0;
-    singularIndex = nConstraints;
+void Core::WarmStart() {
+    // hinted constraints form the initial passive set, entries with non-positive primal are dropped
+    // until the NNLS solution on the set is feasible, then dual iterations continue from there
+    std::vector<unsg_t> hint;
+    hint.swap(warmActiveSet);
+    if (presolved) {
+        hint = presolver.MapActiveSet(hint);
+    }
+    if (eliminated) {
+        hint = nullSpace.MapActiveSet(hint);
+    }
+    if (settings.actSetUpdtSettings.rejectSingular) {
+        return; // zp is not filled by SolvePrimal
+    }
+    for (unsg_t indx : hint) {
+        if (indx < nConstraints && ws.activeConstraints.find(indx) == ws.activeConstraints.end()) {
+            if (settings.gammaUpdate) {
+                gamma += std::fabs(ws.s[indx]);
+            }
+            AddToActiveSet(indx);
+        }
+    }
+    while (!ws.activeConstraints.empty()) {
+        ++counters.primalIterations;
+        SolvePrimal();
+        std::vector<unsg_t> toRemove;
+        for (auto indx : ws.activeConstraints) {
+            if (ws.zp[indx] < settings.prLtZero) {
+                toRemove.push_back(indx);
+            }
+        }
+        if (toRemove.empty()) {
+            ws.primal = ws.zp;
+            break;
+        }
+        gammaCorrection = 0.0;
+        for (auto indx : toRemove) {
+            gammaCorrection += std::fabs(ws.s[indx]);
+            RmvFromActiveSet(indx);
+        }
+        UpdateGammaOnPrimalIteration();
+    }
+    ws.addHistory.clear();
+    counters.warmStartSize = static_cast<unsg_t>(ws.activeConstraints.size());
+}
+
+void Core::DualLoop() {
     while (dualIteration < settings.nDualIterations) {
+        profiler.Begin(SolverPhase::PRICING);
         if (OrigInfeasible()) {
+            profiler.End();
             dualExitStatus = DualLoopExitStatus::INFEASIBILITY;
             break;
         }
         if (FullActiveSet()) {
+            profiler.End();
             dualExitStatus = DualLoopExitStatus::FULL_ACTIVE_SET;
             break;
         }
         ComputeDualVariable();
         dualTolerance = -styGamma * settings.origPrimalFsb; // primal feasiblility was scaled in DB scaling
         SelectNewActiveComponent();
+        if (timed) {
+            TrackBestIterate();
+        }
+        profiler.End();
         if(newActiveIndex == nConstraints) { //set to nConstraints in not found
             dualExitStatus = DualLoopExitStatus::ALL_DUAL_POSITIVE;
             break;
         }
+        if (lowPrecision && ws.activeConstraints.find(newActiveIndex) != ws.activeConstraints.end()) {
+            break; // rounding of the float product: dual of an active row is zero in exact arithmetic
+        }
+        if (Expired()) {
+            dualExitStatus = DualLoopExitStatus::TIME_LIMIT;
+            break;
+        }
         UpdateGammaOnDualIteration();
         AddToActiveSet(newActiveIndex);
         unsg_t primalIteration = 0;
         primalExitStatus = PrimalLoopExitStatus::UNKNOWN;
         singularIndex = nConstraints;
         while (primalIteration < settings.nPrimalIterations) {
+            if (Expired()) {
+                primalExitStatus = PrimalLoopExitStatus::TIME_LIMIT;
+                break;
+            }
             if (ws.activeConstraints.empty()) {
                 primalExitStatus = primalIteration == 0 ? PrimalLoopExitStatus::EMPTY_ACTIVE_SET_ON_ZERO_ITERATION :
                                                           PrimalLoopExitStatus::EMPTY_ACTIVE_SET;
                 break;
             }
+            ++counters.primalIterations;
             int prStat = UpdatePrimal();
             const bool success = (prStat == 0) ||((prStat == SINGULARITY)
                     && !settings.actSetUpdtSettings.rejectSingular);
@@ -581,11 +999,106 @@ void Core::Solve() {
 
         SetIterationData();
         ++dualIteration;
+        if (primalExitStatus == PrimalLoopExitStatus::TIME_LIMIT) {
+            dualExitStatus = DualLoopExitStatus::TIME_LIMIT;
+            break;
+        }
+        if (lowPrecision && ws.activeConstraints.find(newActiveIndex) == ws.activeConstraints.end()) {
+            // the entering row always stays in exact arithmetic, float pricing is not accurate enough here
+            break;
+        }
     }
+}
 
+void Core::TrackBestIterate() {
+    // dual = -(gamma + s_T * primal) * (A * x - b) for x recovered from the primal: the violation is free here
+    if (styGamma <= 0.0) {
+        return;
+    }
+    double minDual = 0.0;
+    for (unsg_t i = 0; i < nConstraints; ++i) {
+        minDual = std::fmin(minDual, ws.dual[i]);
+    }
+    const double violation = -minDual / styGamma;
+    if (ws.bestPrimal.empty() || violation < bestViolation) {
+        bestViolation = violation;
+        bestGamma = gamma;
+        ws.bestPrimal = ws.primal;
+        ws.bestActive = ws.activeConstraints;
+        counters.bestIteration = dualIteration;
+    }
+}
+
+void Core::RestoreBestIterate() {
+    // the linear solver follows the active set, its factorization is stale afterwards
+    if (ws.bestPrimal.empty()) {
+        return;
+    }
+    std::vector<unsg_t> toRemove;
+    for (auto indx : ws.activeConstraints) {
+        if (ws.bestActive.find(indx) == ws.bestActive.end()) {
+            toRemove.push_back(indx);
+        }
+    }
+    for (auto indx : toRemove) {
+        RmvFromActiveSet(indx);
+    }
+    for (auto indx : ws.bestActive) {
+        if (ws.activeConstraints.find(indx) == ws.activeConstraints.end()) {
+            AddToActiveSet(indx);
+        }
+    }
+    ws.primal = ws.bestPrimal;
+    gamma = bestGamma;
+}
+
+void Core::RefineInDouble() {
+    // float pricing may miss a dual violation near the tolerance and float solves may leave a slightly wrong
+    // active set: the set is handed to a double solver, entries with negative double solution are dropped
+    // and the dual loop continues in double, usually with a single pricing that confirms optimality
+    lowPrecision = false;
+    if (settings.linSolverType == LinSolverType::MSS1) {
+        retiredStats = lSolver->GetStats();
+        lSolver = std::make_unique<MssCumulativeSolver>(nConstraints, nVariables);
+        for (auto indx : ws.activeConstraints) {
+            GetNNLSRow(indx, ws.nnlsRow);
+            lSolver->Add(ws.nnlsRow, ws.s[indx], indx);
+        }
+    }
+    unsg_t primalIteration = 0;
+    while (!ws.activeConstraints.empty() && primalIteration++ < settings.nPrimalIterations) {
+        ++counters.primalIterations;
+        const int prStat = UpdatePrimal();
+        if (ws.negativeZp.empty() || (prStat & LINE_SEARCH_FAILED) || settings.actSetUpdtSettings.rejectSingular) {
+            break;
+        }
+    }
+    DualLoop();
+}
+
+void Core::Solve() {
+    dualExitStatus = DualLoopExitStatus::UNKNOWN;
+    primalExitStatus = PrimalLoopExitStatus::DIDNT_STARTED;
+    dualIteration = 0;
+    gamma = 1.0;
+    singularIndex = nConstraints;
+    lowPrecision = !ws.MF.empty();
+    timed = settings.timeLimit > std::chrono::nanoseconds::zero();
+    deadline = std::chrono::steady_clock::now() + settings.timeLimit;
+    ws.bestPrimal.clear();
+    WarmStart();
+    DualLoop();
+    if (lowPrecision && dualExitStatus != DualLoopExitStatus::TIME_LIMIT) {
+        // also when the float loop used up nDualIterations: the returned iterate is recovered in double,
+        // the double dual loop continues with the iterations left, if any
+        RefineInDouble();
+    }
     if (dualIteration >= settings.nDualIterations) {
         dualExitStatus = DualLoopExitStatus::ITERATIONS;
     }
+    if (dualExitStatus == DualLoopExitStatus::TIME_LIMIT) {
+        RestoreBestIterate();
+    }
     if (dualExitStatus == DualLoopExitStatus::ALL_DUAL_POSITIVE ||
         dualExitStatus == DualLoopExitStatus::FULL_ACTIVE_SET) {
         SolvePrimal();
@@ -595,10 +1108,16 @@ void Core::Solve() {
         dualExitStatus = DualLoopExitStatus::INFEASIBILITY;
     }
     if (dualExitStatus != DualLoopExitStatus::INFEASIBILITY) {
+        profiler.Begin(SolverPhase::SOLUTION_RECOVERY);
         ComputeOrigSolution();
+        profiler.End();
+        profiler.Begin(SolverPhase::DUALITY_GAP);
         ComputeDualityGap();
+        profiler.End();
+        profiler.Begin(SolverPhase::SOLUTION_RECOVERY);
         UnscaleD();
         ComputeCost();
+        profiler.End();
     }
     FillOutput();
     SetFinalData();
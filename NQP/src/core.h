@@ -4,8 +4,10 @@
 #include "types.h"
 #include "linSolvers.h"
 #include "scaler.h"
-#include "timers.h"
+#include "profiler.h"
 #include "callback.h"
+#include "presolve.h"
+#include "nullSpace.h"
 namespace QP_NNLS {
 class Core {
     struct WorkSpace {
@@ -24,9 +26,15 @@ class Core {
         std::vector<double> v;
         std::vector<double> slack;
         std::vector<double> violations;
+        std::vector<double> mCoef;     // NNLS row j is mCoef[j] * M[mRow[j]]: sign of the side and scale
+        std::vector<double> rowWeight; // per row of M, zero between calls of MultTranspNNLS
+        std::vector<double> rowProduct;
+        std::vector<double> nnlsRow;   // row handed to the linear solver on every add
+        std::vector<unsg_t> mRow;
+        std::vector<double> bestPrimal; // timeLimit: least violating iterate priced so far
+        std::set<unsigned int> bestActive;
         std::vector<int> pmt;
         std::set<unsigned int> activeConstraints;
-        std::set<unsigned int> linEqConstraints;
         std::unordered_set<unsigned int> negativeZp;
         matrix_t H;
         matrix_t M;
@@ -34,6 +42,9 @@ class Core {
         matrix_t Chol;
         matrix_t CholInv;
         matrix_t MS;
+        matrix_type<float> MF; // mixedPrecision: float copy of M for pricing
+        std::vector<float> yF;
+        std::vector<float> rowProductF;
         std::deque<unsg_t> addHistory;
         void Clear();
     };
@@ -49,6 +60,7 @@ public:
     void Set(const CoreSettings& settings);
     void ResetProblem();
     void SetCallback(std::unique_ptr<Callback> callback);
+    void SetWarmStart(const std::vector<unsg_t>& activeSet) { warmActiveSet = activeSet; } // used by next Solve
     bool InitProblem(const DenseQPProblem& problem);
     void Solve();
     const SolverOutput& GetOutput() { return output; }
@@ -57,6 +69,7 @@ private:
     unsg_t nVariables;
     unsg_t nConstraints;
     unsg_t nEqConstraints;
+    unsg_t nUserEqConstraints; // equality rows of the user problem, first rows of output.violations
     unsg_t newActiveIndex;
     unsg_t rptInterval;
     unsg_t singularIndex;
@@ -74,20 +87,52 @@ private:
     double cost;
     CoreSettings settings;
     WorkSpace ws;
-    std::unique_ptr<iTimer> timer;
+    PhaseProfiler profiler;
+    SolverCounters counters;
     std::unique_ptr<Callback> uCallback;
     std::unique_ptr<ILinSolver> lSolver;
     std::unique_ptr<OrtScaler> ortScaler;
     SolverOutput output;
     InitStageStatus initStatus;
-    bool PrepareNNLS(const DenseQPProblem& problem);
+    double userPrimalFsb;
+    std::vector<unsg_t> warmActiveSet;
+    matrix_t cachedH; // reuseFactorization: H of the last factorized problem
+    matrix_t cachedChol;
+    matrix_t cachedCholInv;
+    unsg_t cachedBandwidth = 0;
+    bool cachedBanded = false;
+    unsg_t bandwidth = 0; // of H, Chol has the same bandwidth
+    bool banded = false; // Chol is a band factor, M, v and x are formed by band solves, CholInv is not built
+    bool userCallback = false; // SetCallback installed a callback, it gets CholInv even for band factors
+    Presolver presolver;
+    bool presolved = false; // solver works on presolver.GetProblem()
+    NullSpaceReducer nullSpace;
+    bool eliminated = false; // solver works on nullSpace.GetProblem(), built from the presolved problem
+    bool lowPrecision = false; // mixedPrecision: float pricing and solves until RefineInDouble
+    LinSolverStats retiredStats; // of the float linear solver replaced by RefineInDouble
+    std::chrono::steady_clock::time_point deadline;
+    bool timed = false; // settings.timeLimit is set
+    double bestViolation = 0.0;
+    double bestGamma = 1.0;
+    wcTimer initTimer; // wall times of Cholesky, inversion and M for the trace, taken whether or not profiling is on
+    double tChol = 0.0; // seconds
+    double tInv = 0.0;
+    double tM = 0.0;
+    bool Factorize(const DenseQPProblem& problem);
+    double InitLap(); // seconds since the last lap of initTimer
+    void WarmStart();
+    void DualLoop();
+    void RefineInDouble();
+    bool Expired() const { return timed && std::chrono::steady_clock::now() >= deadline; }
+    void TrackBestIterate();
+    void RestoreBestIterate();
+    bool PrepareNNLS(const DenseQPProblem& userProblem);
     bool OrigInfeasible();
     bool FullActiveSet();
     bool SkipCandidate(unsg_t indx);
     bool MakeLineSearch();
     bool IsCandidateForNewActive(unsg_t index, double toCompare, bool skip = true);
     void SetDefaultSettings();
-    void TimePoint(std::string& buf);
     void ScaleD();
     void UnscaleD();
     void ComputeDualVariable();
@@ -97,10 +142,16 @@ private:
     void RmvFromActiveSet(unsg_t indx);
     void ResetPrimal();
     void AllocateWs();
-    void ExtendJacobian(const matrix_t& Jac, const std::vector<double>& b,
+    void ExtendJacobian(const matrix_t& Jac, const std::vector<double>& b, const std::vector<double>& bLw,
                         const std::vector<double>& lb, const std::vector<double>& ub);
+    void GetNNLSRow(unsg_t indx, std::vector<double>& row) const;
+    void MultNNLS(const std::vector<double>& v, std::vector<double>& Mv);
+    void MultTranspNNLS(const std::vector<double>& y, std::vector<double>& MTy);
+    void MultTranspNNLS(const std::vector<double>& y, const std::set<unsg_t>& indices, std::vector<double>& MTy);
     void ComputeOrigSolution();
     void ComputeExactLambdaOnActiveSet();
+    bool RefineLambdaOnActiveSet();
+    double ActiveSetResidual(std::vector<double>& r); // r = s_A - M_A * M_A_T * lambda_A, returns max |r|
     void ComputeCost();
     void ComputeDualityGap();
     void ComputeViolationsExplicitly();
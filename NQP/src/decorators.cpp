@@ -34,6 +34,9 @@ namespace QP_NNLS {
     void QPNNLSDense::Solve() {
         core->Solve();
     }
+    void QPNNLSDense::SetWarmStart(const std::vector<unsg_t>& activeSet) {
+        core->SetWarmStart(activeSet);
+    }
     InitStageStatus QPNNLSDense::GetInitStatus() {
         return core->GetInitStatus();
     }
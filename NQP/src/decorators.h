@@ -27,6 +27,8 @@ namespace QP_NNLS {
     public:
         bool SetProblem(const DenseQPProblem& problem);
         void Solve();
+        // active set of a previous output, e.g. of the previous SQP iteration; consumed by next Solve
+        void SetWarmStart(const std::vector<unsg_t>& activeSet);
         InitStageStatus GetInitStatus();
     };
 
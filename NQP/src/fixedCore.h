@@ -0,0 +1,516 @@
+#ifndef NNLS_FIXED_CORE_H
+#define NNLS_FIXED_CORE_H
+#include <array>
+#include <cmath>
+#include <limits>
+#include <cstddef>
+#include <utility>
+#include "types.h"
+namespace QP_NNLS {
+template <std::size_t NV, std::size_t NC, typename Scalar = double>
+struct FixedQPProblem {
+    // 1/2 x_T * H * x + c_T * x, A * x <= b, lw <= x <= up; missing bounds are +-1e20
+    std::array<std::array<Scalar, NV>, NV> H{};
+    std::array<std::array<Scalar, NV>, NC> A{};
+    std::array<Scalar, NC> b{};
+    std::array<Scalar, NV> c{};
+    std::array<Scalar, NV> lw{};
+    std::array<Scalar, NV> up{};
+};
+
+template <std::size_t NV, std::size_t NC, typename Scalar = double>
+struct FixedSolverOutput {
+    DualLoopExitStatus dualExitStatus = DualLoopExitStatus::UNKNOWN;
+    PrimalLoopExitStatus primalExitStatus = PrimalLoopExitStatus::DIDNT_STARTED;
+    unsg_t nDualIterations = 0;
+    Scalar cost = Scalar(0);
+    std::array<Scalar, NV> x{};
+    std::array<Scalar, NC> lambda{};
+    std::array<Scalar, NV> lambdaLw{};
+    std::array<Scalar, NV> lambdaUp{};
+};
+
+template <std::size_t NV, std::size_t NC, typename Scalar = double>
+class FixedCore {
+    // Core::Solve for compile time dimensions and the default active set strategy (MSS1 least squares,
+    // no repetition check, no singular rejection): all storage is std::array inside the object,
+    // loops have constant trip counts and are unrolled by the compiler, no allocation, exceptions or virtual calls.
+    // NNLS rows: A, then +e_i (upper) and -e_i (lower bound) of every variable, as in Core.
+    // Equality and ranged rows are not supported, split them into two inequality rows.
+public:
+    static constexpr std::size_t nRows = NC + 2 * NV;
+    static constexpr std::size_t nLs = NV + 1; // rows of the least squares subproblem [M_T; s_T]
+    using Problem = FixedQPProblem<NV, NC, Scalar>;
+    using Output = FixedSolverOutput<NV, NC, Scalar>;
+    FixedCore() = default;
+    ~FixedCore() = default;
+    void Set(const CoreSettings& coreSettings) {
+        nDualIterations = coreSettings.nDualIterations;
+        nPrimalIterations = coreSettings.nPrimalIterations;
+        nnlsResidNormFsb = static_cast<Scalar>(coreSettings.nnlsResidNormFsb);
+        userPrimalFsb = static_cast<Scalar>(coreSettings.origPrimalFsb);
+        nnlsPrimalZero = static_cast<Scalar>(coreSettings.nnlsPrimalZero);
+        prLtZero = static_cast<Scalar>(coreSettings.prLtZero);
+        gammaUpdate = coreSettings.gammaUpdate;
+    }
+    bool SetProblem(const Problem& problem) {
+        // false if H is not positive definite
+        H = problem.H;
+        c = problem.c;
+        if (!Factorize()) {
+            return false;
+        }
+        // M = [A; I; -I] * L^-1, v = L^-T * c, s = M * v + b
+        for (std::size_t i = 0; i < NC; ++i) {
+            for (std::size_t j = 0; j < NV; ++j) {
+                Scalar sum = Scalar(0);
+                for (std::size_t k = j; k < NV; ++k) {
+                    sum += problem.A[i][k] * cholInv[k][j];
+                }
+                M[i][j] = sum;
+            }
+            b[i] = problem.b[i];
+        }
+        for (std::size_t i = 0; i < NV; ++i) {
+            for (std::size_t j = 0; j < NV; ++j) {
+                M[NC + 2 * i][j] = cholInv[i][j];
+                M[NC + 2 * i + 1][j] = -cholInv[i][j];
+            }
+            b[NC + 2 * i] = problem.up[i];
+            b[NC + 2 * i + 1] = -problem.lw[i];
+        }
+        for (std::size_t j = 0; j < NV; ++j) {
+            Scalar sum = Scalar(0);
+            for (std::size_t k = j; k < NV; ++k) {
+                sum += cholInv[k][j] * c[k];
+            }
+            v[j] = sum;
+        }
+        for (std::size_t i = 0; i < nRows; ++i) {
+            s[i] = Dot(M[i], v) + b[i];
+        }
+        Scale();
+        return true;
+    }
+    void Solve() {
+        output = Output();
+        active.fill(false);
+        nActive = 0;
+        primal.fill(Scalar(0));
+        gamma = Scalar(1);
+        unsg_t dualIteration = 0;
+        DualLoopExitStatus dualStatus = DualLoopExitStatus::UNKNOWN;
+        PrimalLoopExitStatus primalStatus = PrimalLoopExitStatus::DIDNT_STARTED;
+        while (dualIteration < nDualIterations) {
+            if (OrigInfeasible()) {
+                dualStatus = DualLoopExitStatus::INFEASIBILITY;
+                break;
+            }
+            if (nActive == nRows) {
+                dualStatus = DualLoopExitStatus::FULL_ACTIVE_SET;
+                break;
+            }
+            const std::size_t newIndex = SelectNewActiveComponent();
+            if (newIndex == nRows || active[newIndex]) {
+                // an active row is selected only by rounding: its dual is zero in exact arithmetic,
+                // adding it again changes nothing and the loop would repeat the same iteration (Core::DualLoop in low precision)
+                dualStatus = DualLoopExitStatus::ALL_DUAL_POSITIVE;
+                break;
+            }
+            if (gammaUpdate) {
+                gamma += std::fabs(s[newIndex]);
+            }
+            active[newIndex] = true;
+            ++nActive;
+            unsg_t primalIteration = 0;
+            primalStatus = PrimalLoopExitStatus::UNKNOWN;
+            while (primalIteration < nPrimalIterations) {
+                if (nActive == 0) {
+                    primalStatus = primalIteration == 0 ? PrimalLoopExitStatus::EMPTY_ACTIVE_SET_ON_ZERO_ITERATION :
+                                                          PrimalLoopExitStatus::EMPTY_ACTIVE_SET;
+                    break;
+                }
+                if (!SolvePrimal()) {
+                    primal = zp;
+                    primalStatus = PrimalLoopExitStatus::ALL_PRIMAL_POSITIVE;
+                    break;
+                }
+                if (!MakeLineSearch()) {
+                    primalStatus = PrimalLoopExitStatus::LINE_SEARCH_FAILED;
+                    break;
+                }
+                ++primalIteration;
+            }
+            if (primalIteration >= nPrimalIterations) {
+                primalStatus = PrimalLoopExitStatus::ITERATIONS;
+            }
+            ++dualIteration;
+        }
+        if (dualIteration >= nDualIterations) {
+            dualStatus = DualLoopExitStatus::ITERATIONS;
+        }
+        if (dualStatus == DualLoopExitStatus::ALL_DUAL_POSITIVE || dualStatus == DualLoopExitStatus::FULL_ACTIVE_SET) {
+            SolvePrimal();
+            primal = zp;
+        }
+        if (OrigInfeasible()) {
+            dualStatus = DualLoopExitStatus::INFEASIBILITY;
+        }
+        output.dualExitStatus = dualStatus;
+        output.primalExitStatus = primalStatus;
+        output.nDualIterations = dualIteration;
+        if (dualStatus != DualLoopExitStatus::INFEASIBILITY) {
+            ComputeOrigSolution();
+        }
+    }
+    const Output& GetOutput() const { return output; }
+private:
+    static Scalar Dot(const std::array<Scalar, NV>& v1, const std::array<Scalar, NV>& v2) {
+        Scalar sum = Scalar(0);
+        for (std::size_t j = 0; j < NV; ++j) {
+            sum += v1[j] * v2[j];
+        }
+        return sum;
+    }
+    bool Factorize() {
+        // H = L_T * L as in ComputeCholFactorT, L^-1 as in InvertCholetsky
+        for (std::size_t r = NV; r-- > 0;) {
+            for (std::size_t col = r + 1; col-- > 0;) {
+                Scalar sum = Scalar(0);
+                for (std::size_t k = r + 1; k < NV; ++k) {
+                    sum += chol[k][col] * chol[k][r];
+                }
+                Scalar factor = H[r][col] - sum;
+                if (col == r) {
+                    if (std::fabs(factor) < static_cast<Scalar>(CONSTANTS::cholFactorZero)) {
+                        factor = static_cast<Scalar>(CONSTANTS::cholFactorZero);
+                    } else if (factor < Scalar(0)) {
+                        return false;
+                    }
+                    chol[r][r] = std::sqrt(factor);
+                } else {
+                    chol[r][col] = factor / chol[r][r];
+                }
+            }
+            for (std::size_t col = 0; col < r; ++col) {
+                chol[col][r] = Scalar(0);
+            }
+        }
+        for (std::size_t r = 0; r < NV; ++r) {
+            const Scalar diagInv = Scalar(1) / chol[r][r];
+            for (std::size_t col = 0; col < NV; ++col) {
+                Scalar sum = col == r ? Scalar(1) : Scalar(0);
+                for (std::size_t i = col; i < r; ++i) {
+                    sum -= chol[r][i] * cholInv[i][col];
+                }
+                cholInv[r][col] = col <= r ? sum * diagInv : Scalar(0);
+            }
+        }
+        return true;
+    }
+    void Scale() {
+        // OrtScaler::Scale and Core::ScaleD
+        const Scalar thMin = Scalar(1.0e-5);
+        const Scalar thMax = Scalar(1.0e5);
+        const Scalar minSf = Scalar(1.0e-8);
+        Scalar scaleFactorSL = Scalar(1);
+        Scalar scaleFactorSU = Scalar(1);
+        std::array<Scalar, nRows> norm2{};
+        for (std::size_t i = 0; i < nRows; ++i) {
+            norm2[i] = Dot(M[i], M[i]);
+            const Scalar rat = norm2[i] / (s[i] * s[i]);
+            if (thMin < rat && rat < thMax) {
+                scaleFactorSL = std::fmin(rat, scaleFactorSL);
+            } else {
+                Scalar bf = Scalar(1);
+                if (rat < thMin) {
+                    bf = rat / thMin;
+                } else if (rat > thMax) {
+                    bf = rat / thMax;
+                }
+                if (bf < scaleFactorSU) {
+                    scaleFactorSU = std::fmax(minSf, bf);
+                }
+            }
+        }
+        const bool blncL = scaleFactorSL == Scalar(1);
+        const bool blncU = scaleFactorSU == Scalar(1);
+        scaleFactor = blncL && !blncU ? scaleFactorSU : (blncL && blncU ? Scalar(1) : scaleFactorSL);
+        for (std::size_t i = 0; i < nRows; ++i) {
+            s[i] *= scaleFactor;
+            rowScale[i] = Scalar(1) / std::sqrt(norm2[i] + s[i] * s[i]);
+            s[i] *= rowScale[i];
+            for (std::size_t j = 0; j < NV; ++j) {
+                M[i][j] *= rowScale[i];
+            }
+            b[i] *= scaleFactor;
+        }
+        for (std::size_t j = 0; j < NV; ++j) {
+            v[j] *= scaleFactor;
+        }
+        origPrimalFsb = userPrimalFsb * scaleFactor;
+    }
+    bool OrigInfeasible() {
+        // M_T * primal and gamma + s_T * primal on the active set
+        styGamma = gamma;
+        MTY.fill(Scalar(0));
+        for (std::size_t i = 0; i < nRows; ++i) {
+            if (active[i]) {
+                styGamma += s[i] * primal[i];
+                for (std::size_t j = 0; j < NV; ++j) {
+                    MTY[j] += primal[i] * M[i][j];
+                }
+            }
+        }
+        return Dot(MTY, MTY) + styGamma * styGamma < nnlsResidNormFsb;
+    }
+    std::size_t SelectNewActiveComponent() {
+        // minimum dual component, inactive rows first
+        Scalar sty = gamma;
+        for (std::size_t i = 0; i < nRows; ++i) {
+            dual[i] = Dot(M[i], MTY) + styGamma * s[i];
+            sty += s[i] * primal[i];
+        }
+        const Scalar dualTolerance = -sty * origPrimalFsb;
+        std::size_t newIndex = nRows;
+        Scalar newActive = std::numeric_limits<Scalar>::max();
+        for (int pass = 0; pass < 2 && newIndex == nRows; ++pass) {
+            for (std::size_t i = 0; i < nRows; ++i) {
+                if (active[i] == (pass == 1) && dual[i] < dualTolerance && dual[i] < newActive) {
+                    newActive = dual[i];
+                    newIndex = i;
+                }
+            }
+        }
+        return newIndex;
+    }
+    bool SolvePrimal() {
+        // min || [M_A_T; s_A_T] * z - [0; -gamma] || by Householder QR with column pivoting as MSS1,
+        // columns beyond the numerical rank are zero; returns true if some z_i < nnlsPrimalZero
+        std::size_t k = 0;
+        for (std::size_t i = 0; i < nRows; ++i) {
+            if (active[i]) {
+                for (std::size_t j = 0; j < NV; ++j) {
+                    ls[k][j] = M[i][j];
+                }
+                ls[k][NV] = s[i];
+                lsIndex[k++] = i;
+            }
+        }
+        std::array<Scalar, nLs> rhs{};
+        rhs[NV] = -gamma;
+        std::array<Scalar, nRows> colNorm2{};
+        for (std::size_t col = 0; col < k; ++col) {
+            for (std::size_t r = 0; r < nLs; ++r) {
+                colNorm2[col] += ls[col][r] * ls[col][r];
+            }
+        }
+        const std::size_t steps = k < nLs ? k : nLs;
+        Scalar threshold = Scalar(0);
+        std::size_t rank = 0;
+        for (; rank < steps; ++rank) {
+            std::size_t pivot = rank;
+            for (std::size_t col = rank + 1; col < k; ++col) {
+                if (colNorm2[col] > colNorm2[pivot]) {
+                    pivot = col;
+                }
+            }
+            std::swap(ls[rank], ls[pivot]);
+            std::swap(lsIndex[rank], lsIndex[pivot]);
+            std::swap(colNorm2[rank], colNorm2[pivot]);
+            Scalar norm2 = Scalar(0);
+            for (std::size_t r = rank; r < nLs; ++r) {
+                norm2 += ls[rank][r] * ls[rank][r];
+            }
+            const Scalar norm = std::sqrt(norm2);
+            if (rank == 0) {
+                threshold = norm * std::numeric_limits<Scalar>::epsilon() * static_cast<Scalar>(nLs);
+            }
+            if (norm <= threshold) {
+                break;
+            }
+            // Householder reflection I - 2 * w * w_T / w_T * w zeroes column rank below the diagonal
+            const Scalar alpha = ls[rank][rank] > Scalar(0) ? -norm : norm;
+            std::array<Scalar, nLs> w{};
+            for (std::size_t r = rank; r < nLs; ++r) {
+                w[r] = ls[rank][r];
+            }
+            w[rank] -= alpha;
+            const Scalar wNorm2 = norm2 - ls[rank][rank] * ls[rank][rank] + w[rank] * w[rank];
+            ls[rank][rank] = alpha;
+            for (std::size_t r = rank + 1; r < nLs; ++r) {
+                ls[rank][r] = Scalar(0);
+            }
+            const auto reflect = [&](std::array<Scalar, nLs>& col) {
+                Scalar dot = Scalar(0);
+                for (std::size_t r = rank; r < nLs; ++r) {
+                    dot += w[r] * col[r];
+                }
+                const Scalar f = Scalar(2) * dot / wNorm2;
+                for (std::size_t r = rank; r < nLs; ++r) {
+                    col[r] -= f * w[r];
+                }
+            };
+            for (std::size_t col = rank + 1; col < k; ++col) {
+                reflect(ls[col]);
+                colNorm2[col] -= ls[col][rank] * ls[col][rank];
+            }
+            reflect(rhs);
+        }
+        zp.fill(Scalar(0));
+        std::array<Scalar, nLs> z{};
+        for (std::size_t r = rank; r-- > 0;) {
+            Scalar sum = rhs[r];
+            for (std::size_t col = r + 1; col < rank; ++col) {
+                sum -= ls[col][r] * z[col];
+            }
+            z[r] = sum / ls[r][r];
+            zp[lsIndex[r]] = z[r];
+        }
+        bool negative = false;
+        for (std::size_t col = 0; col < k; ++col) {
+            negative = negative || zp[lsIndex[col]] < nnlsPrimalZero;
+        }
+        return negative;
+    }
+    bool MakeLineSearch() {
+        Scalar minStep = std::numeric_limits<Scalar>::max();
+        bool stepFound = false;
+        for (std::size_t i = 0; i < nRows; ++i) {
+            if (active[i] && zp[i] < nnlsPrimalZero) {
+                const Scalar denominator = primal[i] - zp[i];
+                if (std::fabs(denominator) > Scalar(1.0e-16)) {
+                    minStep = std::fmin(minStep, primal[i] / denominator);
+                    stepFound = true;
+                }
+            }
+        }
+        if (!stepFound) {
+            return false;
+        }
+        Scalar gammaCorrection = Scalar(0);
+        for (std::size_t i = 0; i < nRows; ++i) {
+            primal[i] += minStep * (zp[i] - primal[i]);
+            if (std::fabs(primal[i]) < prLtZero && active[i]) {
+                gammaCorrection += std::fabs(s[i]);
+                active[i] = false;
+                --nActive;
+            }
+        }
+        if (gammaUpdate) {
+            gamma = std::fabs(gamma - gammaCorrection);
+        }
+        return true;
+    }
+    void ComputeOrigSolution() {
+        // lambda = -primal / (gamma + s_T * primal), exact on the active set: M_A * M_A_T * lambda_A = s_A (LDL_T),
+        // x = L^-1 * (M_T * lambda - v)
+        Scalar sty = gamma;
+        for (std::size_t i = 0; i < nRows; ++i) {
+            if (active[i]) {
+                sty += s[i] * primal[i];
+            }
+        }
+        std::array<Scalar, nRows> lambda{};
+        for (std::size_t i = 0; i < nRows; ++i) {
+            lambda[i] = -primal[i] / sty;
+        }
+        std::size_t k = 0;
+        for (std::size_t i = 0; i < nRows; ++i) {
+            if (active[i]) {
+                lsIndex[k++] = i;
+            }
+        }
+        const Scalar zeroTol = Scalar(1.0e-16);
+        std::array<Scalar, nRows> d{};
+        std::array<Scalar, nRows> y{};
+        for (std::size_t r = 0; r < k; ++r) {
+            for (std::size_t col = 0; col <= r; ++col) {
+                Scalar sum = Dot(M[lsIndex[r]], M[lsIndex[col]]);
+                for (std::size_t l = 0; l < col; ++l) {
+                    sum -= gram[r][l] * gram[col][l] * d[l];
+                }
+                if (col < r) {
+                    gram[r][col] = std::fabs(d[col]) < zeroTol ? Scalar(0) : sum / d[col];
+                } else {
+                    d[r] = sum;
+                }
+            }
+            Scalar sum = s[lsIndex[r]];
+            for (std::size_t l = 0; l < r; ++l) {
+                sum -= gram[r][l] * y[l];
+            }
+            y[r] = sum;
+        }
+        for (std::size_t r = k; r-- > 0;) {
+            Scalar sum = Scalar(0);
+            for (std::size_t l = r + 1; l < k; ++l) {
+                sum += gram[l][r] * lambda[lsIndex[l]];
+            }
+            lambda[lsIndex[r]] = std::fabs(d[r]) < zeroTol ? Scalar(0) : y[r] / d[r] - sum;
+        }
+        std::array<Scalar, NV> u{};
+        for (std::size_t r = 0; r < k; ++r) {
+            for (std::size_t j = 0; j < NV; ++j) {
+                u[j] += lambda[lsIndex[r]] * M[lsIndex[r]][j];
+            }
+        }
+        const Scalar invScaleFactor = Scalar(1) / scaleFactor;
+        for (std::size_t r = 0; r < NV; ++r) {
+            Scalar sum = Scalar(0);
+            for (std::size_t j = 0; j <= r; ++j) {
+                sum += cholInv[r][j] * (u[j] - v[j]);
+            }
+            output.x[r] = sum * invScaleFactor;
+        }
+        for (std::size_t i = 0; i < nRows; ++i) {
+            lambda[i] *= -rowScale[i] * invScaleFactor;
+        }
+        for (std::size_t i = 0; i < NC; ++i) {
+            output.lambda[i] = lambda[i];
+        }
+        for (std::size_t i = 0; i < NV; ++i) {
+            output.lambdaUp[i] = lambda[NC + 2 * i];
+            output.lambdaLw[i] = lambda[NC + 2 * i + 1];
+        }
+        output.cost = Dot(c, output.x);
+        for (std::size_t i = 0; i < NV; ++i) {
+            for (std::size_t j = 0; j < i; ++j) {
+                output.cost += H[i][j] * output.x[i] * output.x[j];
+            }
+            output.cost += Scalar(0.5) * H[i][i] * output.x[i] * output.x[i];
+        }
+    }
+    std::array<std::array<Scalar, NV>, NV> H{};
+    std::array<std::array<Scalar, NV>, NV> chol{};
+    std::array<std::array<Scalar, NV>, NV> cholInv{};
+    std::array<std::array<Scalar, NV>, nRows> M{};   // scaled NNLS rows
+    std::array<std::array<Scalar, nLs>, nRows> ls{}; // columns [M_i; s_i] of the active set, QR in place
+    std::array<std::array<Scalar, nRows>, nRows> gram{}; // L of the LDL_T of M_A * M_A_T
+    std::array<std::size_t, nRows> lsIndex{};
+    std::array<bool, nRows> active{};
+    std::array<Scalar, nRows> b{};
+    std::array<Scalar, nRows> s{};
+    std::array<Scalar, nRows> rowScale{};
+    std::array<Scalar, nRows> primal{};
+    std::array<Scalar, nRows> zp{};
+    std::array<Scalar, nRows> dual{};
+    std::array<Scalar, NV> c{};
+    std::array<Scalar, NV> v{};
+    std::array<Scalar, NV> MTY{};
+    std::size_t nActive = 0;
+    Scalar gamma = Scalar(1);
+    Scalar styGamma = Scalar(1);
+    Scalar scaleFactor = Scalar(1);
+    Scalar origPrimalFsb = Scalar(1.0e-6);
+    Scalar userPrimalFsb = Scalar(1.0e-6);
+    Scalar nnlsResidNormFsb = Scalar(1.0e-16);
+    Scalar nnlsPrimalZero = Scalar(-1.0e-7);
+    Scalar prLtZero = Scalar(1.0e-14);
+    unsg_t nDualIterations = 1000;
+    unsg_t nPrimalIterations = 100;
+    bool gammaUpdate = true;
+    Output output;
+};
+}
+#endif // NNLS_FIXED_CORE_H
@@ -1,23 +1,28 @@
 #include "linSolvers.h"
 #include "utils.h"
+#include <cmath>
+#include <limits>
 namespace QP_NNLS {
-CumulativeSolver::CumulativeSolver(const matrix_t& M,
-                                   const std::vector<double>& s ):
-    nConstraints(M.size()),
-    nVariables(0),
+CumulativeSolver::CumulativeSolver(unsg_t nConstraints, unsg_t nVariables):
+    nConstraints(nConstraints),
+    nVariables(nVariables),
     nActive(0),
     gamma(1.0),
-    M(M),
-    s(s)
+    M(nConstraints),
+    s(nConstraints, 0.0)
 {
-    if (nConstraints > 0) {
-        nVariables = M.front().size();
-    }
     activeSet.resize(nConstraints, false);
 }
 bool CumulativeSolver::Add(const std::vector<double>& mp, double sp, unsg_t indx) {
-    activeSet[indx] = true;
-    ++nActive;
+    // system is built in Solve()
+    // a row added again while active only refreshes its data
+    M[indx] = mp;
+    s[indx] = sp;
+    if (!activeSet[indx]) {
+        activeSet[indx] = true;
+        ++nActive;
+    }
+    ++stats.activeSetChanges;
     return true;
 }
 bool CumulativeSolver::Delete(unsg_t indx) {
@@ -26,12 +31,12 @@ bool CumulativeSolver::Delete(unsg_t indx) {
         if (nActive > 0) {
             --nActive;
         }
+        ++stats.activeSetChanges;
     }
     return true;
 }
-CumulativeLDLTSolver::CumulativeLDLTSolver(const matrix_t& M,
-                                           const std::vector<double>& s):
-    CumulativeSolver(M, s)
+CumulativeLDLTSolver::CumulativeLDLTSolver(unsg_t nConstraints, unsg_t nVariables):
+    CumulativeSolver(nConstraints, nVariables)
 {}
 
 const LinSolverOutput& CumulativeLDLTSolver::Solve() {
@@ -49,6 +54,10 @@ const LinSolverOutput& CumulativeLDLTSolver::Solve() {
         }
     }
     if (m.size() > 0) {
+        // m * m_T, LDLT, forward and backward substitutions
+        const double k = static_cast<double>(m.size());
+        stats.flopsSolve += 2.0 * k * k * (nVariables + 1) + k * k * k / 3.0 + 2.0 * k * k;
+        ++stats.refactorizations;
         MMTbSolver mmtb;
         int nDNegative = mmtb.Solve(m, b);
         output.nDNegative = nDNegative;
@@ -59,9 +68,8 @@ const LinSolverOutput& CumulativeLDLTSolver::Solve() {
     return output;
 }
 
-CumulativeEGNSolver::CumulativeEGNSolver(const matrix_t& M,
-                                         const std::vector<double>& s):
-    CumulativeSolver(M, s)
+CumulativeEGNSolver::CumulativeEGNSolver(unsg_t nConstraints, unsg_t nVariables):
+    CumulativeSolver(nConstraints, nVariables)
 {}
 
 const LinSolverOutput& CumulativeEGNSolver::Solve() {
@@ -91,6 +99,9 @@ const LinSolverOutput& CumulativeEGNSolver::Solve() {
                 ++ii;
             }
         }
+        const double k = static_cast<double>(nActive);
+        stats.flopsSolve += 2.0 * k * k * (nVariables + 1) + k * k * k / 3.0 + 2.0 * k * k;
+        ++stats.refactorizations;
         SolveByEGN(A, b);
     }
     return output;
@@ -102,18 +113,20 @@ void CumulativeEGNSolver::SolveByEGN(const Eigen::MatrixXd& A, const Eigen::Vect
         output.solution[i] = r[i];
     }
 }
-MssCumulativeSolver::MssCumulativeSolver(const matrix_t& M,
-                                         const std::vector<double>& s):
-    CumulativeSolver(M, s)
+template <typename Scalar>
+MssCumulativeSolverT<Scalar>::MssCumulativeSolverT(unsg_t nConstraints, unsg_t nVariables):
+    CumulativeSolver(nConstraints, nVariables)
 {}
 
-const LinSolverOutput& MssCumulativeSolver::Solve() {
+template <typename Scalar>
+const LinSolverOutput& MssCumulativeSolverT<Scalar>::Solve() {
     output.indices.clear();
+    factorized = false;
     if (nActive  == 0) {
         output.solution =  std::vector<double>(nConstraints, 0.0);
     } else {
-        Eigen::MatrixXd A(nVariables + 1, nActive);
-        Eigen::VectorXd b(nVariables + 1);
+        MatrixS A(nVariables + 1, nActive);
+        VectorS b(nVariables + 1);
         output.solution = std::vector<double>(nActive, 0.0);
         for (unsg_t r = 0; r < nVariables + 1; ++r) {
             b(r) = 0.0;
@@ -124,25 +137,77 @@ const LinSolverOutput& MssCumulativeSolver::Solve() {
                         output.indices.push_back(c);
                     }
                     if (r == nVariables) {
-                        A(r, act) = s[c];
+                        A(r, act) = static_cast<Scalar>(s[c]);
                     } else {
-                        A(r, act) = M[c][r];
+                        A(r, act) = static_cast<Scalar>(M[c][r]);
                     }
                     ++act;
                 }
             }
         }
-        b(nVariables) = -gamma;
+        b(nVariables) = static_cast<Scalar>(-gamma);
+        // Householder QR of (n + 1) x k matrix, Q_T * b and triangular solve
+        const double k = static_cast<double>(nActive);
+        const double rows = static_cast<double>(nVariables + 1);
+        stats.flopsSolve += 2.0 * k * k * (rows - k / 3.0) + 4.0 * rows * k + k * k;
+        ++stats.refactorizations;
         SolveByEGN(A, b);
+        sActive = A.row(nVariables).transpose();
+        factorized = true;
+        factorizedChanges = stats.activeSetChanges;
     }
     return output;
 }
 
-void MssCumulativeSolver::SolveByEGN(const Eigen::MatrixXd& A, const Eigen::VectorXd& b) {
-    Eigen::VectorXd r = A.colPivHouseholderQr().solve(b);
+template <typename Scalar>
+void MssCumulativeSolverT<Scalar>::SolveByEGN(const MatrixS& A, const VectorS& b) {
+    qr.compute(A);
+    VectorS r = qr.solve(b);
     for (unsg_t i = 0; i < nActive; ++i) {
-        output.solution[i] = r[i];
+        output.solution[i] = static_cast<double>(r[i]);
     }
 }
 
+template <typename Scalar>
+void MssCumulativeSolverT<Scalar>::SolveQRGram(const VectorS& rhs, VectorS& y) const {
+    // A * P = Q * R => A_T * A = P * R_T * R * P_T
+    const auto R = qr.matrixR().topLeftCorner(nActive, nActive).template triangularView<Eigen::Upper>();
+    VectorS w = qr.colsPermutation().transpose() * rhs;
+    R.transpose().solveInPlace(w);
+    R.solveInPlace(w);
+    y = qr.colsPermutation() * w;
+}
+
+template <typename Scalar>
+bool MssCumulativeSolverT<Scalar>::SolveGram(const std::vector<double>& rhs, std::vector<double>& y) {
+    // M_A * M_A_T = A_T * A - s_A * s_A_T, Sherman-Morrison with the QR of A, O(k^2)
+    if (!factorized || factorizedChanges != stats.activeSetChanges || rhs.size() != nActive ||
+        nActive > nVariables || qr.rank() < static_cast<Eigen::Index>(nActive)) {
+        return false;
+    }
+    VectorS r(nActive);
+    for (unsg_t i = 0; i < nActive; ++i) {
+        r(i) = static_cast<Scalar>(rhs[i]);
+    }
+    VectorS g;
+    VectorS t;
+    SolveQRGram(r, g);
+    SolveQRGram(sActive, t);
+    const Scalar denominator = Scalar(1) - sActive.dot(t);
+    if (!(std::abs(denominator) > std::numeric_limits<Scalar>::epsilon())) {
+        return false;
+    }
+    g += t * (sActive.dot(g) / denominator);
+    y.resize(nActive);
+    for (unsg_t i = 0; i < nActive; ++i) {
+        y[i] = static_cast<double>(g(i));
+    }
+    const double k = static_cast<double>(nActive);
+    stats.flopsSolve += 4.0 * k * k + 6.0 * k;
+    return true;
+}
+
+template class MssCumulativeSolverT<double>;
+template class MssCumulativeSolverT<float>;
+
 } //namespace QP_NNLS
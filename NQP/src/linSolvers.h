@@ -16,16 +16,22 @@ public:
     virtual bool Delete(unsg_t indx) = 0;
     virtual void SetGamma(double gamma) = 0;
     virtual const LinSolverOutput& Solve() = 0;
+    // M_A * M_A_T * y = rhs in the order of LinSolverOutput::indices with the factorization of the last Solve(),
+    // false if there is none or the active set changed since
+    virtual bool SolveGram(const std::vector<double>& /*rhs*/, std::vector<double>& /*y*/) { return false; }
+    const LinSolverStats& GetStats() const { return stats; }
 protected:
     ILinSolver() = default;
+    LinSolverStats stats;
 };
 
 class CumulativeSolver: public ILinSolver {
     // Add / Delete methods constructs linear system
     // Solve() solves pre-constructed linear system
+    // rows are copied on Add: NNLS rows of the core are views of shared rows of M
 public:
     CumulativeSolver() = delete;
-    CumulativeSolver(const matrix_t& M, const std::vector<double>& s);
+    CumulativeSolver(unsg_t nConstraints, unsg_t nVariables);
     virtual ~CumulativeSolver() override = default;
     virtual bool Add(const std::vector<double>& mp, double sp, unsg_t indx) override;
     virtual bool Delete(unsg_t indx) override;
@@ -36,8 +42,8 @@ protected:
     unsg_t nActive;
     double gamma;
     std::vector<bool> activeSet;
-    const matrix_t& M;
-    const std::vector<double>& s;
+    matrix_t M;
+    std::vector<double> s;
     LinSolverOutput output;
 
 };
@@ -46,7 +52,7 @@ class CumulativeLDLTSolver: public CumulativeSolver {
     // Solve linear system using custom LDLT decomposition
 public:
     CumulativeLDLTSolver() = delete;
-    CumulativeLDLTSolver(const matrix_t& M, const std::vector<double>& s);
+    CumulativeLDLTSolver(unsg_t nConstraints, unsg_t nVariables);
     virtual ~CumulativeLDLTSolver() override = default;
     const LinSolverOutput& Solve() override;
 };
@@ -55,22 +61,35 @@ class CumulativeEGNSolver : public CumulativeSolver {
     // Solve linear system using Eigen lib
 public:
     CumulativeEGNSolver() = delete;
-    CumulativeEGNSolver(const matrix_t& M, const std::vector<double>& s);
+    CumulativeEGNSolver(unsg_t nConstraints, unsg_t nVariables);
     virtual ~CumulativeEGNSolver() override = default;
     const LinSolverOutput& Solve() override;
 protected:
     void SolveByEGN(const Eigen::MatrixXd& A, const Eigen::VectorXd& b);
 };
 
-class MssCumulativeSolver : public CumulativeSolver {
+template <typename Scalar>
+class MssCumulativeSolverT : public CumulativeSolver {
+    // QR of the least squares system in Scalar, rows are kept and the solution is returned in double
 public:
-    MssCumulativeSolver() = delete;
-    MssCumulativeSolver(const matrix_t& M, const std::vector<double>& s);
-    virtual ~MssCumulativeSolver() override = default;
+    MssCumulativeSolverT() = delete;
+    MssCumulativeSolverT(unsg_t nConstraints, unsg_t nVariables);
+    virtual ~MssCumulativeSolverT() override = default;
     const LinSolverOutput& Solve() override;
+    bool SolveGram(const std::vector<double>& rhs, std::vector<double>& y) override;
 protected:
-    void SolveByEGN(const Eigen::MatrixXd& A, const Eigen::VectorXd& b);
+    using MatrixS = Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>;
+    using VectorS = Eigen::Matrix<Scalar, Eigen::Dynamic, 1>;
+    void SolveByEGN(const MatrixS& A, const VectorS& b);
+    void SolveQRGram(const VectorS& rhs, VectorS& y) const; // (A_T * A)^-1 * rhs
+    Eigen::ColPivHouseholderQR<MatrixS> qr; // of A = [M_A_T; s_A_T] of the last Solve()
+    VectorS sActive;
+    unsg_t factorizedChanges = 0; // stats.activeSetChanges at the last Solve()
+    bool factorized = false;
 };
+extern template class MssCumulativeSolverT<double>;
+extern template class MssCumulativeSolverT<float>;
+using MssCumulativeSolver = MssCumulativeSolverT<double>;
 
 
 class DynamicSolver : public ILinSolver {
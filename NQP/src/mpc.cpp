@@ -0,0 +1,187 @@
+#include "mpc.h"
+#include <cmath>
+namespace QP_NNLS {
+namespace {
+constexpr double infinity = 1.0e20;
+
+bool IsFinite(double bound) {
+    return std::fabs(bound) < CONSTANTS::infiniteBound;
+}
+
+bool HasSize(const matrix_t& M, std::size_t rows, std::size_t cols) {
+    if (M.size() != rows) {
+        return false;
+    }
+    for (const auto& row : M) {
+        if (row.size() != cols) {
+            return false;
+        }
+    }
+    return true;
+}
+
+Eigen::MatrixXd ToEigen(const matrix_t& M, std::size_t rows, std::size_t cols) {
+    Eigen::MatrixXd E(rows, cols);
+    for (std::size_t i = 0; i < rows; ++i) {
+        for (std::size_t j = 0; j < cols; ++j) {
+            E(i, j) = M[i][j];
+        }
+    }
+    return E;
+}
+
+double Bound(const std::vector<double>& bounds, std::size_t i, double unbounded) {
+    return bounds.empty() ? unbounded : bounds[i];
+}
+}
+
+bool MpcCondenser::CheckDimensions(const MpcProblem& mpc) const {
+    const std::size_t x = mpc.A.size();
+    const std::size_t u = mpc.B.empty() ? 0 : mpc.B.front().size();
+    const auto boundOk = [](const std::vector<double>& bounds, std::size_t size) {
+        return bounds.empty() || bounds.size() == size;
+    };
+    return x > 0 && u > 0 && mpc.horizon > 0 && HasSize(mpc.A, x, x) && HasSize(mpc.B, x, u) &&
+           HasSize(mpc.Q, x, x) && HasSize(mpc.R, u, u) && HasSize(mpc.P, x, x) &&
+           boundOk(mpc.xMin, x) && boundOk(mpc.xMax, x) && boundOk(mpc.uMin, u) && boundOk(mpc.uMax, u);
+}
+
+bool MpcCondenser::Set(const MpcProblem& mpc) {
+    if (!CheckDimensions(mpc)) {
+        return false;
+    }
+    nx = static_cast<unsg_t>(mpc.A.size());
+    nu = static_cast<unsg_t>(mpc.B.front().size());
+    horizon = mpc.horizon;
+    A = ToEigen(mpc.A, nx, nx);
+    B = ToEigen(mpc.B, nx, nu);
+    Q = ToEigen(mpc.Q, nx, nx);
+    R = ToEigen(mpc.R, nu, nu);
+    P = ToEigen(mpc.P, nx, nx);
+    AkB.resize(horizon);
+    AkB[0] = B;
+    for (unsg_t k = 1; k < horizon; ++k) {
+        AkB[k] = A * AkB[k - 1];
+    }
+    BuildHessian();
+    const unsg_t nU = horizon * nu;
+    problem.lw.resize(nU);
+    problem.up.resize(nU);
+    for (unsg_t k = 0; k < horizon; ++k) {
+        for (unsg_t s = 0; s < nu; ++s) {
+            problem.lw[k * nu + s] = Bound(mpc.uMin, s, -infinity);
+            problem.up[k * nu + s] = Bound(mpc.uMax, s, infinity);
+        }
+    }
+    BuildStateRows(mpc);
+    problem.nEqConstraints = 0;
+    Update(std::vector<double>(nx, 0.0));
+    return true;
+}
+
+void MpcCondenser::BuildHessian() {
+    // column block j: z_k = A^(k-1-j) * B is the response of x_k to u_j, k > j.
+    // lambda_N = P * z_N, lambda_k = Q * z_k + A_T * lambda_k+1, H_ij = B_T * lambda_i+1 for i >= j
+    const unsg_t nU = horizon * nu;
+    Eigen::MatrixXd H = Eigen::MatrixXd::Zero(nU, nU);
+    const Eigen::MatrixXd AT = A.transpose();
+    const Eigen::MatrixXd BT = B.transpose();
+    for (unsg_t j = 0; j < horizon; ++j) {
+        Eigen::MatrixXd lambda = P * AkB[horizon - 1 - j];
+        H.block(static_cast<Eigen::Index>((horizon - 1) * nu), j * nu, nu, nu) = BT * lambda;
+        for (unsg_t k = horizon - 1; k > j; --k) {
+            lambda = Q * AkB[k - 1 - j] + AT * lambda;
+            H.block(static_cast<Eigen::Index>((k - 1) * nu), j * nu, nu, nu) = BT * lambda;
+        }
+        H.block(j * nu, j * nu, nu, nu) += R;
+    }
+    // same recursion with z_k = A^k gives c = F * x0
+    std::vector<Eigen::MatrixXd> Ak(horizon + 1);
+    Ak[0] = Eigen::MatrixXd::Identity(nx, nx);
+    for (unsg_t k = 1; k <= horizon; ++k) {
+        Ak[k] = A * Ak[k - 1];
+    }
+    F.resize(nU, nx);
+    Eigen::MatrixXd lambda = P * Ak[horizon];
+    F.block((horizon - 1) * nu, 0, nu, nx) = BT * lambda;
+    for (unsg_t k = horizon - 1; k > 0; --k) {
+        lambda = Q * Ak[k] + AT * lambda;
+        F.block((k - 1) * nu, 0, nu, nx) = BT * lambda;
+    }
+    problem.H.assign(nU, std::vector<double>(nU, 0.0));
+    for (unsg_t i = 0; i < nU; ++i) {
+        for (unsg_t l = 0; l <= i; ++l) {
+            problem.H[i][l] = problem.H[l][i] = H(i, l); // lower block triangle is computed
+        }
+    }
+}
+
+void MpcCondenser::BuildStateRows(const MpcProblem& mpc) {
+    // row of x_k[s]: [(A^(k-1) * B)_s .. (A^0 * B)_s 0 .. 0], Toeplitz blocks are shared by all k
+    const unsg_t nU = horizon * nu;
+    problem.A.clear();
+    rowStep.clear();
+    rowState.clear();
+    rowSign.clear();
+    rowUp.clear();
+    rowLw.clear();
+    bool ranged = false;
+    for (unsg_t k = 1; k <= horizon; ++k) {
+        for (unsg_t s = 0; s < nx; ++s) {
+            const double lw = Bound(mpc.xMin, s, -infinity);
+            const double up = Bound(mpc.xMax, s, infinity);
+            if (!IsFinite(lw) && !IsFinite(up)) {
+                continue;
+            }
+            const double sign = IsFinite(up) ? 1.0 : -1.0;
+            problem.A.emplace_back(nU, 0.0);
+            for (unsg_t j = 0; j < k; ++j) {
+                for (unsg_t l = 0; l < nu; ++l) {
+                    problem.A.back()[j * nu + l] = sign * AkB[k - 1 - j](s, l);
+                }
+            }
+            rowStep.push_back(k - 1);
+            rowState.push_back(s);
+            rowSign.push_back(sign);
+            rowUp.push_back(sign > 0.0 ? up : -lw);
+            rowLw.push_back(sign > 0.0 && IsFinite(lw) ? lw : -infinity);
+            ranged = ranged || IsFinite(rowLw.back());
+        }
+    }
+    problem.b.resize(problem.A.size());
+    problem.bLw.clear();
+    if (ranged) {
+        problem.bLw.resize(problem.A.size());
+    }
+}
+
+const DenseQPProblem& MpcCondenser::Update(const std::vector<double>& x0) {
+    // c = F * x0, state rows are shifted by A^k * x0
+    const Eigen::Map<const Eigen::VectorXd> x(x0.data(), nx);
+    const Eigen::VectorXd c = F * x;
+    problem.c.assign(c.data(), c.data() + c.size());
+    std::vector<Eigen::VectorXd> response(horizon);
+    Eigen::VectorXd xk = x;
+    for (unsg_t k = 0; k < horizon; ++k) {
+        xk = A * xk;
+        response[k] = xk;
+    }
+    for (std::size_t i = 0; i < rowStep.size(); ++i) {
+        const double shift = rowSign[i] * response[rowStep[i]](rowState[i]);
+        problem.b[i] = rowUp[i] - shift;
+        if (!problem.bLw.empty()) {
+            problem.bLw[i] = IsFinite(rowLw[i]) ? rowLw[i] - shift : -infinity;
+        }
+    }
+    return problem;
+}
+
+void MpcCondenser::PredictStates(const std::vector<double>& x0, const std::vector<double>& u, matrix_t& states) const {
+    Eigen::VectorXd xk = Eigen::Map<const Eigen::VectorXd>(x0.data(), nx);
+    states.resize(horizon);
+    for (unsg_t k = 0; k < horizon; ++k) {
+        xk = A * xk + B * Eigen::Map<const Eigen::VectorXd>(u.data() + k * nu, nu);
+        states[k].assign(xk.data(), xk.data() + nx);
+    }
+}
+}
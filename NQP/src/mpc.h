@@ -0,0 +1,61 @@
+#ifndef NNLS_MPC_H
+#define NNLS_MPC_H
+#include <vector>
+#include "types.h"
+#include <Eigen/Core>
+#include <Eigen/Dense>
+namespace QP_NNLS {
+struct MpcProblem {
+    // x_k+1 = A * x_k + B * u_k, k = 0 .. horizon - 1
+    // min 1/2 sum_k (x_k_T * Q * x_k + u_k_T * R * u_k) + 1/2 x_N_T * P * x_N
+    // xMin <= x_k <= xMax for k = 1 .. N, uMin <= u_k <= uMax; empty bound vectors mean unbounded
+    matrix_t A;
+    matrix_t B;
+    matrix_t Q;
+    matrix_t R;
+    matrix_t P;
+    unsg_t horizon = 0;
+    std::vector<double> xMin;
+    std::vector<double> xMax;
+    std::vector<double> uMin;
+    std::vector<double> uMax;
+};
+
+class MpcCondenser {
+    // eliminates the states: X = Phi * x0 + Gamma * U, Gamma is block lower triangular Toeplitz
+    // with blocks A^(i - j) * B. Only the N blocks A^i * B are formed, H = Gamma_T * Q * Gamma + R
+    // is built column by column with the adjoint recursion lambda_k = Q_k * z_k + A_T * lambda_k+1,
+    // O(N^2 * nx^2 * nu) instead of O(N^3) products with the explicit Gamma.
+    // Variables are U = [u_0 .. u_N-1], input bounds are variable bounds, state bounds are ranged rows.
+public:
+    MpcCondenser() = default;
+    ~MpcCondenser() = default;
+    bool Set(const MpcProblem& mpc); // false on inconsistent dimensions, problem is not set then
+    // per tick path: only c, b and bLw depend on the initial state, H and A are kept
+    const DenseQPProblem& Update(const std::vector<double>& x0);
+    const DenseQPProblem& GetProblem() const { return problem; }
+    // x_1 .. x_N of the inputs u returned by the solver
+    void PredictStates(const std::vector<double>& x0, const std::vector<double>& u, matrix_t& states) const;
+private:
+    bool CheckDimensions(const MpcProblem& mpc) const;
+    void BuildHessian();
+    void BuildStateRows(const MpcProblem& mpc);
+    DenseQPProblem problem;
+    Eigen::MatrixXd A;
+    Eigen::MatrixXd B;
+    Eigen::MatrixXd Q;
+    Eigen::MatrixXd P;
+    Eigen::MatrixXd R;
+    std::vector<Eigen::MatrixXd> AkB; // A^k * B, k = 0 .. N - 1
+    Eigen::MatrixXd F;                // c = F * x0, N * nu x nx
+    std::vector<unsg_t> rowStep;      // state row -> k - 1 of x_k
+    std::vector<unsg_t> rowState;     // state row -> component of x_k
+    std::vector<double> rowSign;      // -1: only the lower bound is finite, the row is negated
+    std::vector<double> rowUp;        // upper side of the row without the x0 part
+    std::vector<double> rowLw;
+    unsg_t nx = 0;
+    unsg_t nu = 0;
+    unsg_t horizon = 0;
+};
+}
+#endif // NNLS_MPC_H
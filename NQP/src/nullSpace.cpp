@@ -0,0 +1,279 @@
+#include "nullSpace.h"
+#include <algorithm>
+#include <cmath>
+namespace QP_NNLS {
+namespace {
+constexpr double infinity = 1.0e20; // bound of the reduced variables, bounds live in rows of A
+constexpr double consistencyTol = 1.0e-9;
+
+bool IsFinite(double bound) {
+    return std::fabs(bound) < CONSTANTS::infiniteBound;
+}
+}
+
+bool NullSpaceReducer::IsRanged(unsg_t row) const {
+    return row >= original.nEqConstraints && row < original.bLw.size() && IsFinite(original.bLw[row]);
+}
+
+bool NullSpaceReducer::Apply(const DenseQPProblem& problem) {
+    const Eigen::Index n = static_cast<Eigen::Index>(problem.H.size());
+    const Eigen::Index p = static_cast<Eigen::Index>(problem.nEqConstraints);
+    stats = NullSpaceStats();
+    if (p == 0 || p > static_cast<Eigen::Index>(problem.A.size())) {
+        return false;
+    }
+    Eigen::MatrixXd FT(n, p);
+    Eigen::VectorXd g(p);
+    for (Eigen::Index i = 0; i < p; ++i) {
+        for (Eigen::Index j = 0; j < n; ++j) {
+            FT(j, i) = problem.A[i][j];
+        }
+        g(i) = problem.b[i];
+    }
+    qr.compute(FT);
+    const Eigen::Index r = qr.rank();
+    if (r == 0 || r == n) {
+        return false; // zero rows or no degrees of freedom left, nothing to gain
+    }
+    // P_T * F = R_T * Q_T, x0 = Q_1 * w with R_11_T * w = (P_T * g)_1 is the minimum norm solution
+    const Eigen::VectorXd pg = qr.colsPermutation().transpose() * g;
+    const Eigen::VectorXd w = qr.matrixR().topLeftCorner(r, r).triangularView<Eigen::Upper>().transpose().solve(pg.head(r));
+    const Eigen::MatrixXd Q = qr.householderQ();
+    x0 = Q.leftCols(r) * w;
+    Z = Q.rightCols(n - r);
+    stats.rank = static_cast<unsg_t>(r);
+    stats.dependentRows = static_cast<unsg_t>(p - r);
+    stats.eqResidual = (FT.transpose() * x0 - g).cwiseAbs().maxCoeff();
+    if (stats.eqResidual > consistencyTol * (1.0 + g.cwiseAbs().maxCoeff())) {
+        return false; // inconsistent equalities are left to the solver
+    }
+    original = problem;
+    BuildReduced();
+    return true;
+}
+
+void NullSpaceReducer::BuildReduced() {
+    const std::size_t n = original.H.size();
+    const std::size_t m = original.A.size();
+    const std::size_t p = original.nEqConstraints;
+    const std::size_t nr = static_cast<std::size_t>(Z.cols());
+    Eigen::MatrixXd H(n, n);
+    Eigen::VectorXd c(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t j = 0; j < n; ++j) {
+            H(i, j) = original.H[i][j];
+        }
+        c(i) = original.c[i];
+    }
+    // 1/2 y_T * Z_T * H * Z * y + (H * x0 + c)_T * Z * y + const
+    const Eigen::MatrixXd HZ = H * Z;
+    const Eigen::MatrixXd Hr = Z.transpose() * HZ;
+    const Eigen::VectorXd cr = Z.transpose() * (H * x0 + c);
+    reduced.H.assign(nr, std::vector<double>(nr, 0.0));
+    reduced.c.resize(nr);
+    for (std::size_t k = 0; k < nr; ++k) {
+        for (std::size_t l = 0; l < nr; ++l) {
+            reduced.H[k][l] = 0.5 * (Hr(k, l) + Hr(l, k));
+        }
+        reduced.c[k] = cr(k);
+    }
+    reduced.lw.assign(nr, -infinity);
+    reduced.up.assign(nr, infinity);
+    reduced.A.clear();
+    reduced.b.clear();
+    std::vector<double> bLw;
+    const auto addRow = [&](const Eigen::VectorXd& a, double sign, double rhs, double rhsLw) {
+        reduced.A.emplace_back(nr);
+        double ax0 = 0.0;
+        for (std::size_t j = 0; j < n; ++j) {
+            ax0 += a(j) * x0(j);
+        }
+        const Eigen::VectorXd aZ = Z.transpose() * a;
+        for (std::size_t k = 0; k < nr; ++k) {
+            reduced.A.back()[k] = sign * aZ(k);
+        }
+        reduced.b.push_back(rhs - sign * ax0);
+        bLw.push_back(IsFinite(rhsLw) ? rhsLw - ax0 : -infinity);
+        rangedPos.push_back(IsFinite(rhsLw) ? static_cast<int>(nRangedRows++) : -1);
+    };
+    rangedPos.clear();
+    nRangedRows = 0;
+    Eigen::VectorXd a(n);
+    for (std::size_t i = p; i < m; ++i) {
+        for (std::size_t j = 0; j < n; ++j) {
+            a(j) = original.A[i][j];
+        }
+        addRow(a, 1.0, original.b[i], IsRanged(static_cast<unsg_t>(i)) ? original.bLw[i] : -infinity);
+    }
+    boundVars.clear();
+    boundSign.clear();
+    for (std::size_t j = 0; j < n; ++j) {
+        const bool hasLw = IsFinite(original.lw[j]);
+        const bool hasUp = IsFinite(original.up[j]);
+        if (!hasLw && !hasUp) {
+            continue;
+        }
+        boundVars.push_back(static_cast<unsg_t>(j));
+        boundSign.push_back(hasUp ? 1.0 : -1.0);
+        a.setZero();
+        a(j) = 1.0;
+        if (hasUp) {
+            addRow(a, 1.0, original.up[j], hasLw ? original.lw[j] : -infinity);
+        } else {
+            addRow(a, -1.0, -original.lw[j], -infinity);
+        }
+    }
+    reduced.bLw.clear();
+    if (nRangedRows > 0) {
+        reduced.bLw = std::move(bLw);
+    }
+    reduced.nEqConstraints = 0;
+}
+
+std::vector<unsg_t> NullSpaceReducer::MapActiveSet(const std::vector<unsg_t>& activeSet) const {
+    const unsg_t n = static_cast<unsg_t>(original.H.size());
+    const unsg_t m = static_cast<unsg_t>(original.A.size());
+    const unsg_t p = original.nEqConstraints;
+    const unsg_t mi = m - p;
+    const unsg_t mr = static_cast<unsg_t>(reduced.A.size());
+    const unsg_t lowerSides = mr + 2 * static_cast<unsg_t>(reduced.H.size());
+    std::vector<int> boundRow(n, -1);
+    for (std::size_t k = 0; k < boundVars.size(); ++k) {
+        boundRow[boundVars[k]] = static_cast<int>(mi + k);
+    }
+    std::vector<unsg_t> rangedRows;
+    for (unsg_t i = p; i < m; ++i) {
+        if (IsRanged(i)) {
+            rangedRows.push_back(i);
+        }
+    }
+    std::vector<unsg_t> mapped;
+    for (unsg_t indx : activeSet) {
+        if (indx < m) {
+            if (indx >= p) {
+                mapped.push_back(indx - p); // equalities are eliminated
+            }
+        } else if (indx < m + 2 * n) {
+            const unsg_t j = (indx - m) / 2;
+            const bool upper = (indx - m) % 2 == 0;
+            const int row = boundRow[j];
+            if (row < 0) {
+                continue;
+            }
+            if ((boundSign[row - mi] > 0.0) == upper) {
+                mapped.push_back(static_cast<unsg_t>(row));
+            } else if (!upper && rangedPos[row] >= 0) {
+                mapped.push_back(lowerSides + static_cast<unsg_t>(rangedPos[row]));
+            }
+        } else if (indx - m - 2 * n < rangedRows.size()) {
+            const unsg_t row = rangedRows[indx - m - 2 * n] - p;
+            mapped.push_back(lowerSides + static_cast<unsg_t>(rangedPos[row]));
+        }
+    }
+    return mapped;
+}
+
+void NullSpaceReducer::Postsolve(SolverOutput& output) const {
+    const std::size_t n = original.H.size();
+    const std::size_t m = original.A.size();
+    const std::size_t p = original.nEqConstraints;
+    const std::size_t mi = m - p;
+    const Eigen::Index r = static_cast<Eigen::Index>(stats.rank);
+    const auto rowLw = [&output](std::size_t row) {
+        return output.lambdaRowLw.empty() ? 0.0 : output.lambdaRowLw[row];
+    };
+    Eigen::VectorXd y(Z.cols());
+    for (Eigen::Index k = 0; k < Z.cols(); ++k) {
+        y(k) = output.x[k];
+    }
+    const Eigen::VectorXd xe = x0 + Z * y;
+    std::vector<double> x(xe.data(), xe.data() + n);
+    std::vector<double> lambda(m, 0.0);
+    std::vector<double> lambdaLw(n, 0.0);
+    std::vector<double> lambdaUp(n, 0.0);
+    std::vector<double> lambdaRowLw;
+    if (!original.bLw.empty()) {
+        lambdaRowLw.assign(m, 0.0);
+    }
+    for (std::size_t i = 0; i < mi; ++i) {
+        lambda[p + i] = output.lambda[i];
+        if (!lambdaRowLw.empty()) {
+            lambdaRowLw[p + i] = rowLw(i);
+        }
+    }
+    for (std::size_t k = 0; k < boundVars.size(); ++k) {
+        const unsg_t j = boundVars[k];
+        if (boundSign[k] > 0.0) {
+            lambdaUp[j] = output.lambda[mi + k];
+            lambdaLw[j] = rowLw(mi + k);
+        } else {
+            lambdaLw[j] = output.lambda[mi + k];
+        }
+    }
+    // F_T * mu = -(H * x + c + A_I_T * lambda_I + lambdaUp - lambdaLw), least squares through the QR of F_T
+    Eigen::VectorXd rhs(n);
+    for (std::size_t j = 0; j < n; ++j) {
+        double v = original.c[j] + lambdaUp[j] - lambdaLw[j];
+        for (std::size_t l = 0; l < n; ++l) {
+            v += original.H[j][l] * x[l];
+        }
+        for (std::size_t i = p; i < m; ++i) {
+            v += original.A[i][j] * (lambda[i] - (lambdaRowLw.empty() ? 0.0 : lambdaRowLw[i]));
+        }
+        rhs(j) = -v;
+    }
+    const Eigen::VectorXd qtr = qr.householderQ().transpose() * rhs;
+    Eigen::VectorXd mu = Eigen::VectorXd::Zero(static_cast<Eigen::Index>(p));
+    mu.head(r) = qr.matrixR().topLeftCorner(r, r).triangularView<Eigen::Upper>().solve(qtr.head(r));
+    mu = qr.colsPermutation() * mu;
+    for (std::size_t i = 0; i < p; ++i) {
+        lambda[i] = mu(i);
+    }
+    output.cost = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        double hx = 0.0;
+        for (std::size_t j = 0; j < n; ++j) {
+            hx += original.H[i][j] * x[j];
+        }
+        output.cost += (0.5 * hx + original.c[i]) * x[i];
+    }
+    std::vector<unsg_t> activeSet;
+    std::vector<double> rangeViolations;
+    std::vector<unsg_t> rangeActive;
+    output.violations.assign(m + 2 * n, 0.0);
+    for (std::size_t i = 0; i < m; ++i) {
+        double ax = 0.0;
+        for (std::size_t j = 0; j < n; ++j) {
+            ax += original.A[i][j] * x[j];
+        }
+        output.violations[i] = ax - original.b[i];
+        if (lambda[i] > 0.0 || i < p) {
+            activeSet.push_back(static_cast<unsg_t>(i));
+        }
+        if (IsRanged(static_cast<unsg_t>(i))) {
+            if (lambdaRowLw[i] > 0.0) {
+                rangeActive.push_back(static_cast<unsg_t>(m + 2 * n + rangeViolations.size()));
+            }
+            rangeViolations.push_back(original.bLw[i] - ax);
+        }
+    }
+    for (std::size_t j = 0; j < n; ++j) {
+        output.violations[m + 2 * j] = x[j] - original.up[j];
+        output.violations[m + 2 * j + 1] = original.lw[j] - x[j];
+        if (lambdaUp[j] > 0.0) {
+            activeSet.push_back(static_cast<unsg_t>(m + 2 * j));
+        }
+        if (lambdaLw[j] > 0.0) {
+            activeSet.push_back(static_cast<unsg_t>(m + 2 * j + 1));
+        }
+    }
+    output.violations.insert(output.violations.end(), rangeViolations.begin(), rangeViolations.end());
+    activeSet.insert(activeSet.end(), rangeActive.begin(), rangeActive.end());
+    output.x = std::move(x);
+    output.lambda = std::move(lambda);
+    output.lambdaLw = std::move(lambdaLw);
+    output.lambdaUp = std::move(lambdaUp);
+    output.lambdaRowLw = std::move(lambdaRowLw);
+    output.activeSet = std::move(activeSet);
+}
+}
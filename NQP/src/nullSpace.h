@@ -0,0 +1,43 @@
+#ifndef NNLS_NULL_SPACE_H
+#define NNLS_NULL_SPACE_H
+#include <vector>
+#include "types.h"
+#include <Eigen/Core>
+#include <Eigen/Dense>
+namespace QP_NNLS {
+struct NullSpaceStats {
+    unsg_t rank = 0;            // independent equality rows
+    unsg_t dependentRows = 0;   // consistent equality rows dropped by the rank revealing QR
+    double eqResidual = 0.0;    // max |F * x0 - g| of the particular solution
+};
+
+class NullSpaceReducer {
+    // eliminates the equality rows F * x = g (first nEqConstraints rows of A):
+    // F_T * P = Q * R, x = x0 + Z * y with Z = last n - rank columns of Q and F * x0 = g.
+    // The reduced problem over y has no equalities, variable bounds become rows Z_j * y of A
+    // (ranged if both bounds are finite). Postsolve maps the solution back to the original layout.
+public:
+    NullSpaceReducer() = default;
+    ~NullSpaceReducer() = default;
+    bool Apply(const DenseQPProblem& problem); // false if there is nothing to eliminate or F is inconsistent
+    const DenseQPProblem& GetProblem() const { return reduced; }
+    const NullSpaceStats& GetStats() const { return stats; }
+    // NNLS indices (rows of A, bounds of every variable, lower sides of ranged rows) of original -> reduced problem
+    std::vector<unsg_t> MapActiveSet(const std::vector<unsg_t>& activeSet) const;
+    void Postsolve(SolverOutput& output) const; // x, cost, multipliers, violations and active set
+private:
+    void BuildReduced();
+    bool IsRanged(unsg_t row) const; // original row with a finite lower side
+    DenseQPProblem original;
+    DenseQPProblem reduced;
+    NullSpaceStats stats;
+    Eigen::ColPivHouseholderQR<Eigen::MatrixXd> qr; // of F_T
+    Eigen::MatrixXd Z;
+    Eigen::VectorXd x0;
+    std::vector<unsg_t> boundVars;   // variable of every bound row, bound rows follow the inequality rows
+    std::vector<double> boundSign;   // +1: Z_j * y <= up_j - x0_j, -1: -Z_j * y <= x0_j - lw_j (lower bound only)
+    std::vector<int> rangedPos;      // reduced row -> position among lower sides of ranged rows, -1 if one-sided
+    unsg_t nRangedRows = 0;
+};
+}
+#endif // NNLS_NULL_SPACE_H
@@ -0,0 +1,96 @@
+#include "perfCounters.h"
+#ifdef __linux__
+#include <cstring>
+#include <cstdint>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+namespace QP_NNLS {
+#ifdef __linux__
+namespace {
+int OpenEvent(std::uint64_t config, int groupFd) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.disabled = groupFd < 0 ? 1 : 0;
+    attr.exclude_kernel = 1; // allowed with perf_event_paranoid = 2
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+    return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, groupFd, 0));
+}
+}
+
+bool PerfCounters::Open() {
+    Close();
+    constexpr std::array<std::uint64_t, nHwCounters> configs = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES
+    };
+    for (std::size_t i = 0; i < nHwCounters; ++i) {
+        fds[i] = OpenEvent(configs[i], leader);
+        if (fds[i] < 0) {
+            if (leader < 0) {
+                // no cycles counter, treat perf events as unavailable
+                return false;
+            }
+            continue;
+        }
+        if (leader < 0) {
+            leader = fds[i];
+        }
+        slots[i] = nOpened++;
+    }
+    ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    return true;
+}
+
+void PerfCounters::Close() {
+    for (auto& fd : fds) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        fd = -1;
+    }
+    leader = -1;
+    nOpened = 0;
+}
+
+void PerfCounters::Read(HwCounts& counts) {
+    counts = HwCounts();
+    if (leader < 0) {
+        return;
+    }
+    std::uint64_t buf[1 + nHwCounters];
+    const ssize_t size = read(leader, buf, sizeof(buf));
+    if (size < static_cast<ssize_t>(sizeof(std::uint64_t)) || buf[0] != nOpened) {
+        return;
+    }
+    for (std::size_t i = 0; i < nHwCounters; ++i) {
+        if (fds[i] >= 0) {
+            counts.values[i] = buf[1 + slots[i]];
+        }
+    }
+}
+#else
+bool PerfCounters::Open() {
+    return false;
+}
+
+void PerfCounters::Close() {}
+
+void PerfCounters::Read(HwCounts& counts) {
+    counts = HwCounts();
+}
+#endif
+
+PerfCounters::~PerfCounters() {
+    Close();
+}
+}
@@ -0,0 +1,27 @@
+#ifndef NNLS_QP_SOLVER_PERF_COUNTERS_H
+#define NNLS_QP_SOLVER_PERF_COUNTERS_H
+#include <array>
+#include "types.h"
+namespace QP_NNLS {
+class PerfCounters {
+    // hardware counters of the calling thread via perf_event_open (linux only),
+    // Open() returns false if perf events are not available, counters not supported
+    // by the cpu / hypervisor stay zero
+public:
+    PerfCounters() = default;
+    ~PerfCounters();
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+    bool Open();
+    void Close();
+    bool IsOpen() const { return leader >= 0; }
+    bool IsSupported(HwCounter counter) const { return fds[static_cast<std::size_t>(counter)] >= 0; }
+    void Read(HwCounts& counts); // values from Open()
+private:
+    std::array<int, nHwCounters> fds{-1, -1, -1, -1};
+    std::array<std::size_t, nHwCounters> slots{}; // position in the group read buffer
+    int leader = -1;
+    std::size_t nOpened = 0;
+};
+}
+#endif // NNLS_QP_SOLVER_PERF_COUNTERS_H
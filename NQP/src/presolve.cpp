@@ -0,0 +1,389 @@
+#include "presolve.h"
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+namespace QP_NNLS {
+namespace {
+constexpr double feasibilityTol = 1.0e-9;
+constexpr double parallelTol = 1.0e-12;
+
+bool IsFinite(double bound) {
+    return std::fabs(bound) < CONSTANTS::infiniteBound;
+}
+}
+
+bool Presolver::IsRanged(unsg_t row) const {
+    return row >= original.nEqConstraints && row < bLw.size() && IsFinite(bLw[row]);
+}
+
+bool Presolver::Apply(const DenseQPProblem& problem) {
+    const unsg_t n = static_cast<unsg_t>(problem.H.size());
+    const unsg_t m = static_cast<unsg_t>(problem.A.size());
+    stats = PresolveStats();
+    original = problem;
+    b = problem.b;
+    bLw = problem.bLw;
+    lw = problem.lw;
+    up = problem.up;
+    fixedValue.assign(n, 0.0);
+    lwSource.assign(n, -1);
+    upSource.assign(n, -1);
+    rowActive.assign(m, true);
+    varActive.assign(n, true);
+    bool changed = true;
+    while (changed) {
+        changed = FixVariables();
+        changed = ReduceRows() || changed;
+        changed = RemoveDuplicates() || changed;
+    }
+    BuildReduced();
+    if (keptVars.empty() || (keptVars.size() == n && keptRows.size() == m)) {
+        // nothing to gain or nothing left to solve
+        return false;
+    }
+    return true;
+}
+
+bool Presolver::FixVariables() {
+    bool changed = false;
+    std::size_t nActive = std::count(varActive.begin(), varActive.end(), true);
+    for (unsg_t j = 0; j < varActive.size(); ++j) {
+        if (!varActive[j] || !IsFinite(lw[j]) || !IsFinite(up[j]) || up[j] > lw[j]) {
+            continue;
+        }
+        if (lw[j] - up[j] > feasibilityTol * (1.0 + std::fabs(lw[j])) || nActive == 1) {
+            continue; // infeasible bounds are left to the solver, at least one variable is kept
+        }
+        varActive[j] = false;
+        --nActive;
+        fixedValue[j] = lw[j];
+        for (unsg_t i = 0; i < original.A.size(); ++i) {
+            b[i] -= original.A[i][j] * fixedValue[j];
+            if (IsRanged(i)) {
+                bLw[i] -= original.A[i][j] * fixedValue[j];
+            }
+        }
+        ++stats.fixedVariables;
+        changed = true;
+    }
+    return changed;
+}
+
+unsg_t Presolver::NActiveVariables(unsg_t row, unsg_t& lastVariable) const {
+    unsg_t nnz = 0;
+    const std::vector<double>& a = original.A[row];
+    for (unsg_t j = 0; j < a.size(); ++j) {
+        if (varActive[j] && a[j] != 0.0) {
+            lastVariable = j;
+            ++nnz;
+        }
+    }
+    return nnz;
+}
+
+bool Presolver::ReduceRows() {
+    bool changed = false;
+    for (unsg_t i = original.nEqConstraints; i < original.A.size(); ++i) {
+        if (!rowActive[i] || IsRanged(i)) {
+            continue;
+        }
+        const std::vector<double>& a = original.A[i];
+        unsg_t j = 0;
+        const unsg_t nnz = NActiveVariables(i, j);
+        if (nnz == 0) {
+            if (b[i] >= -feasibilityTol * (1.0 + std::fabs(b[i]))) {
+                rowActive[i] = false;
+                ++stats.emptyRows;
+                changed = true;
+            }
+        } else if (nnz == 1) {
+            // a_j * x_j <= b  ->  x_j <= b / a_j or x_j >= b / a_j
+            const double bound = b[i] / a[j];
+            if (a[j] > 0.0 && bound < up[j]) {
+                up[j] = bound;
+                upSource[j] = static_cast<int>(i);
+            } else if (a[j] < 0.0 && bound > lw[j]) {
+                lw[j] = bound;
+                lwSource[j] = static_cast<int>(i);
+            }
+            rowActive[i] = false;
+            ++stats.singletonRows;
+            changed = true;
+        } else {
+            // max of a * x over the box
+            double maxActivity = 0.0;
+            bool finite = true;
+            for (unsg_t k = 0; k < a.size() && finite; ++k) {
+                if (!varActive[k] || a[k] == 0.0) {
+                    continue;
+                }
+                const double bound = a[k] > 0.0 ? up[k] : lw[k];
+                finite = IsFinite(bound);
+                maxActivity += a[k] * bound;
+            }
+            if (finite && maxActivity <= b[i]) {
+                rowActive[i] = false;
+                ++stats.redundantRows;
+                changed = true;
+            }
+        }
+    }
+    return changed;
+}
+
+bool Presolver::RemoveDuplicates() {
+    // rows are normalized by max |a_ij|, positive scaling keeps the direction of the inequality
+    bool changed = false;
+    std::unordered_map<std::size_t, std::vector<unsg_t>> buckets;
+    std::vector<double> scales(original.A.size(), 0.0);
+    for (unsg_t i = original.nEqConstraints; i < original.A.size(); ++i) {
+        if (!rowActive[i] || IsRanged(i)) {
+            continue;
+        }
+        const std::vector<double>& a = original.A[i];
+        double scale = 0.0;
+        for (unsg_t j = 0; j < a.size(); ++j) {
+            if (varActive[j]) {
+                scale = std::max(scale, std::fabs(a[j]));
+            }
+        }
+        if (scale == 0.0) {
+            continue;
+        }
+        scales[i] = scale;
+        std::size_t key = 0;
+        for (unsg_t j = 0; j < a.size(); ++j) {
+            if (varActive[j] && a[j] != 0.0) {
+                const long long q = std::llround(a[j] / scale * 1.0e8);
+                key ^= std::hash<long long>()(q) + 0x9e3779b97f4a7c15ULL + (key << 6) + (key >> 2) + j;
+            }
+        }
+        std::vector<unsg_t>& bucket = buckets[key];
+        bool duplicate = false;
+        for (unsg_t& k : bucket) {
+            const std::vector<double>& ak = original.A[k];
+            bool same = true;
+            for (unsg_t j = 0; j < a.size() && same; ++j) {
+                same = !varActive[j] || std::fabs(a[j] / scale - ak[j] / scales[k]) <= parallelTol;
+            }
+            if (!same) {
+                continue;
+            }
+            // keep the tighter row in the bucket
+            if (b[i] / scale < b[k] / scales[k]) {
+                rowActive[k] = false;
+                k = i;
+            } else {
+                rowActive[i] = false;
+            }
+            ++stats.duplicateRows;
+            duplicate = true;
+            changed = true;
+            break;
+        }
+        if (!duplicate) {
+            bucket.push_back(i);
+        }
+    }
+    return changed;
+}
+
+void Presolver::BuildReduced() {
+    const std::size_t n = original.H.size();
+    const std::size_t m = original.A.size();
+    keptRows.clear();
+    keptVars.clear();
+    rowMap.assign(m, -1);
+    varMap.assign(n, -1);
+    for (unsg_t j = 0; j < n; ++j) {
+        if (varActive[j]) {
+            varMap[j] = static_cast<int>(keptVars.size());
+            keptVars.push_back(j);
+        }
+    }
+    for (unsg_t i = 0; i < m; ++i) {
+        if (rowActive[i]) {
+            rowMap[i] = static_cast<int>(keptRows.size());
+            keptRows.push_back(i);
+        }
+    }
+    const std::size_t nr = keptVars.size();
+    reduced.H.assign(nr, std::vector<double>(nr, 0.0));
+    reduced.c.resize(nr);
+    reduced.lw.resize(nr);
+    reduced.up.resize(nr);
+    for (std::size_t k = 0; k < nr; ++k) {
+        const unsg_t j = keptVars[k];
+        // c_R + H_RF * x_F
+        double c = original.c[j];
+        for (unsg_t f = 0; f < n; ++f) {
+            if (!varActive[f]) {
+                c += original.H[j][f] * fixedValue[f];
+            }
+        }
+        reduced.c[k] = c;
+        reduced.lw[k] = lw[j];
+        reduced.up[k] = up[j];
+        for (std::size_t l = 0; l < nr; ++l) {
+            reduced.H[k][l] = original.H[j][keptVars[l]];
+        }
+    }
+    reduced.A.assign(keptRows.size(), std::vector<double>(nr, 0.0));
+    reduced.b.resize(keptRows.size());
+    reduced.bLw.clear();
+    if (!bLw.empty()) {
+        reduced.bLw.resize(keptRows.size());
+    }
+    for (std::size_t r = 0; r < keptRows.size(); ++r) {
+        const unsg_t i = keptRows[r];
+        for (std::size_t k = 0; k < nr; ++k) {
+            reduced.A[r][k] = original.A[i][keptVars[k]];
+        }
+        reduced.b[r] = b[i];
+        if (!bLw.empty()) {
+            reduced.bLw[r] = bLw[i];
+        }
+    }
+    reduced.nEqConstraints = original.nEqConstraints; // equality and ranged rows are never removed
+}
+
+std::vector<unsg_t> Presolver::MapActiveSet(const std::vector<unsg_t>& activeSet) const {
+    const unsg_t m = static_cast<unsg_t>(original.A.size());
+    const unsg_t mr = static_cast<unsg_t>(keptRows.size());
+    const unsg_t n = static_cast<unsg_t>(varMap.size());
+    const unsg_t nr = static_cast<unsg_t>(keptVars.size());
+    std::vector<unsg_t> mapped;
+    for (unsg_t indx : activeSet) {
+        if (indx < m) {
+            if (rowMap[indx] >= 0) {
+                mapped.push_back(static_cast<unsg_t>(rowMap[indx]));
+                continue;
+            }
+            // singleton row became a bound
+            for (unsg_t k = 0; k < keptVars.size(); ++k) {
+                if (upSource[keptVars[k]] == static_cast<int>(indx)) {
+                    mapped.push_back(mr + 2 * k);
+                } else if (lwSource[keptVars[k]] == static_cast<int>(indx)) {
+                    mapped.push_back(mr + 2 * k + 1);
+                }
+            }
+        } else if (indx >= m + 2 * n) {
+            // lower sides of ranged rows, all ranged rows are kept in the same order
+            mapped.push_back(indx - m - 2 * n + mr + 2 * nr);
+        } else {
+            const unsg_t j = (indx - m) / 2;
+            const bool upper = (indx - m) % 2 == 0;
+            if (varActive[j] && (upper ? upSource[j] : lwSource[j]) < 0) {
+                mapped.push_back(mr + 2 * static_cast<unsg_t>(varMap[j]) + (upper ? 0 : 1));
+            }
+        }
+    }
+    return mapped;
+}
+
+void Presolver::Postsolve(SolverOutput& output) const {
+    const std::size_t n = original.H.size();
+    const std::size_t m = original.A.size();
+    const std::size_t mr = keptRows.size();
+    std::vector<double> x(n);
+    std::vector<double> lambda(m, 0.0);
+    std::vector<double> lambdaLw(n, 0.0);
+    std::vector<double> lambdaUp(n, 0.0);
+    std::vector<double> lambdaRowLw;
+    std::vector<unsg_t> activeSet;
+    for (std::size_t j = 0; j < n; ++j) {
+        x[j] = varActive[j] ? output.x[varMap[j]] : fixedValue[j];
+    }
+    for (std::size_t r = 0; r < mr; ++r) {
+        lambda[keptRows[r]] = output.lambda[r];
+    }
+    if (!output.lambdaRowLw.empty()) {
+        lambdaRowLw.assign(m, 0.0);
+        for (std::size_t r = 0; r < mr; ++r) {
+            lambdaRowLw[keptRows[r]] = output.lambdaRowLw[r];
+        }
+    }
+    // multipliers of tightened bounds belong to the singleton rows which defined them
+    const auto setUp = [&](std::size_t j, double mult) {
+        if (upSource[j] >= 0) {
+            lambda[upSource[j]] = mult / original.A[upSource[j]][j];
+        } else {
+            lambdaUp[j] = mult;
+        }
+    };
+    const auto setLw = [&](std::size_t j, double mult) {
+        if (lwSource[j] >= 0) {
+            lambda[lwSource[j]] = -mult / original.A[lwSource[j]][j];
+        } else {
+            lambdaLw[j] = mult;
+        }
+    };
+    for (std::size_t k = 0; k < keptVars.size(); ++k) {
+        setUp(keptVars[k], output.lambdaUp[k]);
+        setLw(keptVars[k], output.lambdaLw[k]);
+    }
+    // fixed variables: H_j * x + c_j + A_j^T * lambda + lambdaUp_j - lambdaLw_j = 0
+    for (std::size_t j = 0; j < n; ++j) {
+        if (varActive[j]) {
+            continue;
+        }
+        double r = original.c[j];
+        for (std::size_t l = 0; l < n; ++l) {
+            r += original.H[j][l] * x[l];
+        }
+        for (std::size_t i = 0; i < m; ++i) {
+            r += original.A[i][j] * (lambda[i] - (lambdaRowLw.empty() ? 0.0 : lambdaRowLw[i]));
+        }
+        if (r < 0.0) {
+            setUp(j, -r);
+        } else {
+            setLw(j, r);
+        }
+    }
+    output.cost = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        double hx = 0.0;
+        for (std::size_t j = 0; j < n; ++j) {
+            hx += original.H[i][j] * x[j];
+        }
+        output.cost += (0.5 * hx + original.c[i]) * x[i];
+    }
+    output.violations.assign(m + 2 * n, 0.0);
+    std::vector<double> rangeViolations;
+    std::vector<unsg_t> rangeActive;
+    for (std::size_t i = 0; i < m; ++i) {
+        double ax = 0.0;
+        for (std::size_t j = 0; j < n; ++j) {
+            ax += original.A[i][j] * x[j];
+        }
+        output.violations[i] = ax - original.b[i];
+        if (lambda[i] > 0.0 || i < original.nEqConstraints) {
+            activeSet.push_back(static_cast<unsg_t>(i));
+        }
+        if (IsRanged(static_cast<unsg_t>(i))) {
+            if (!lambdaRowLw.empty() && lambdaRowLw[i] > 0.0) {
+                rangeActive.push_back(static_cast<unsg_t>(m + 2 * n + rangeViolations.size()));
+            }
+            rangeViolations.push_back(original.bLw[i] - ax);
+        }
+    }
+    for (std::size_t j = 0; j < n; ++j) {
+        output.violations[m + 2 * j] = x[j] - original.up[j];
+        output.violations[m + 2 * j + 1] = original.lw[j] - x[j];
+        if (lambdaUp[j] > 0.0) {
+            activeSet.push_back(static_cast<unsg_t>(m + 2 * j));
+        }
+        if (lambdaLw[j] > 0.0) {
+            activeSet.push_back(static_cast<unsg_t>(m + 2 * j + 1));
+        }
+    }
+    output.violations.insert(output.violations.end(), rangeViolations.begin(), rangeViolations.end());
+    activeSet.insert(activeSet.end(), rangeActive.begin(), rangeActive.end());
+    output.x = std::move(x);
+    output.lambda = std::move(lambda);
+    output.lambdaLw = std::move(lambdaLw);
+    output.lambdaUp = std::move(lambdaUp);
+    output.lambdaRowLw = std::move(lambdaRowLw);
+    output.activeSet = std::move(activeSet);
+}
+}
@@ -0,0 +1,51 @@
+#ifndef NNLS_PRESOLVE_H
+#define NNLS_PRESOLVE_H
+#include <vector>
+#include "types.h"
+namespace QP_NNLS {
+struct PresolveStats {
+    unsg_t emptyRows = 0;
+    unsg_t duplicateRows = 0;    // parallel rows with the same direction, the tighter one is kept
+    unsg_t singletonRows = 0;    // moved to variable bounds
+    unsg_t redundantRows = 0;    // can't be active within variable bounds
+    unsg_t fixedVariables = 0;   // lw == up, substituted
+};
+
+class Presolver {
+    // reductions of A * x <= b, lw <= x <= up before NNLS setup; equality and ranged rows are kept
+    // and only get fixed variables substituted. Postsolve maps the solution back to the original layout.
+public:
+    Presolver() = default;
+    ~Presolver() = default;
+    bool Apply(const DenseQPProblem& problem); // false if nothing was removed, reduced problem is not set then
+    const DenseQPProblem& GetProblem() const { return reduced; }
+    const PresolveStats& GetStats() const { return stats; }
+    // NNLS indices (rows of A, then upper and lower bound of every variable) of original -> reduced problem
+    std::vector<unsg_t> MapActiveSet(const std::vector<unsg_t>& activeSet) const;
+    void Postsolve(SolverOutput& output) const; // x, cost, multipliers, violations and active set
+private:
+    bool FixVariables();
+    bool ReduceRows();
+    bool RemoveDuplicates();
+    void BuildReduced();
+    unsg_t NActiveVariables(unsg_t row, unsg_t& lastVariable) const;
+    bool IsRanged(unsg_t row) const; // original row with a finite lower side
+    DenseQPProblem original;
+    DenseQPProblem reduced;
+    PresolveStats stats;
+    std::vector<double> b;
+    std::vector<double> bLw;
+    std::vector<double> lw;
+    std::vector<double> up;
+    std::vector<double> fixedValue;
+    std::vector<int> lwSource;     // singleton row defining the bound, -1 if original bound
+    std::vector<int> upSource;
+    std::vector<bool> rowActive;
+    std::vector<bool> varActive;
+    std::vector<unsg_t> keptRows;  // reduced -> original
+    std::vector<unsg_t> keptVars;
+    std::vector<int> rowMap;       // original -> reduced, -1 if removed
+    std::vector<int> varMap;
+};
+}
+#endif // NNLS_PRESOLVE_H
@@ -0,0 +1,113 @@
+#include "profiler.h"
+namespace QP_NNLS {
+namespace {
+constexpr double nsToSec = 1.0e-9;
+}
+PhaseProfiler::PhaseProfiler():
+    wallClock(std::make_unique<wcTimer>()),
+    cpuClock(std::make_unique<cpuTimer>())
+{
+    stack.reserve(nSolverPhases);
+}
+
+void PhaseProfiler::Enable(bool enable, bool cpuTime, bool hwCounters) {
+    enabled = enable;
+    this->cpuTime = cpuTime;
+    this->hwCounters = hwCounters;
+    if (!enabled || !hwCounters) {
+        perf.Close();
+    }
+}
+
+void PhaseProfiler::Reset() {
+    stack.clear();
+    phases.fill(Accumulator());
+    wallClock->Start();
+    if (cpuTime) {
+        cpuClock->Start();
+    }
+    if (enabled && hwCounters && !perf.IsOpen()) {
+        perf.Open(); // stays closed if perf events are not available
+    }
+    perf.Read(hwStart);
+}
+
+void PhaseProfiler::Begin(SolverPhase phase) {
+    if (!enabled) {
+        return;
+    }
+    stack.push_back({phase, wallClock->NsFromStart(), cpuTime ? cpuClock->NsFromStart() : 0, 0, 0, {}, {}});
+    if (perf.IsOpen()) {
+        perf.Read(stack.back().hwBegin);
+    }
+}
+
+void PhaseProfiler::End() {
+    if (!enabled || stack.empty()) {
+        return;
+    }
+    const Frame& frame = stack.back();
+    const ticks_t wall = wallClock->NsFromStart() - frame.wallBegin;
+    const ticks_t cpu = cpuTime ? cpuClock->NsFromStart() - frame.cpuBegin : 0;
+    HwCounts hw;
+    if (perf.IsOpen()) {
+        perf.Read(hw);
+        for (std::size_t i = 0; i < nHwCounters; ++i) {
+            hw.values[i] -= frame.hwBegin.values[i];
+        }
+    }
+    Accumulator& acc = phases[static_cast<std::size_t>(frame.phase)];
+    acc.wall += wall;
+    acc.cpu += cpu;
+    // clock resolutions differ, children may take longer than parent for very short phases
+    acc.selfWall += wall > frame.childWall ? wall - frame.childWall : 0;
+    acc.selfCpu += cpu > frame.childCpu ? cpu - frame.childCpu : 0;
+    ++acc.calls;
+    for (std::size_t i = 0; i < nHwCounters; ++i) {
+        acc.hw.values[i] += hw.values[i];
+        const unsigned long long child = frame.childHw.values[i];
+        acc.selfHw.values[i] += hw.values[i] > child ? hw.values[i] - child : 0;
+    }
+    stack.pop_back();
+    if (!stack.empty()) {
+        stack.back().childWall += wall;
+        stack.back().childCpu += cpu;
+        for (std::size_t i = 0; i < nHwCounters; ++i) {
+            stack.back().childHw.values[i] += hw.values[i];
+        }
+    }
+}
+
+void PhaseProfiler::Fill(SolverProfile& profile) {
+    if (!enabled) {
+        profile = SolverProfile();
+        return;
+    }
+    profile.enabled = true;
+    profile.cpuTime = cpuTime;
+    profile.hwCounters = perf.IsOpen();
+    for (std::size_t i = 0; i < nSolverPhases; ++i) {
+        profile.phases[i].wall = nsToSec * phases[i].wall;
+        profile.phases[i].cpu = nsToSec * phases[i].cpu;
+        profile.phases[i].selfWall = nsToSec * phases[i].selfWall;
+        profile.phases[i].selfCpu = nsToSec * phases[i].selfCpu;
+        profile.phases[i].calls = phases[i].calls;
+        profile.phases[i].hw = phases[i].hw;
+        profile.phases[i].selfHw = phases[i].selfHw;
+    }
+    if (perf.IsOpen()) {
+        perf.Read(profile.hw);
+        for (std::size_t i = 0; i < nHwCounters; ++i) {
+            profile.hw.values[i] -= hwStart.values[i];
+        }
+    } else {
+        profile.hw = HwCounts();
+    }
+    profile.wall = nsToSec * wallClock->NsFromStart();
+    profile.cpu = cpuTime ? nsToSec * cpuClock->NsFromStart() : 0.0;
+}
+
+double PhaseProfiler::GetWall(SolverPhase phase) const {
+    return nsToSec * phases[static_cast<std::size_t>(phase)].wall;
+}
+}
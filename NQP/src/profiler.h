@@ -0,0 +1,67 @@
+#ifndef NNLS_QP_SOLVER_PROFILER_H
+#define NNLS_QP_SOLVER_PROFILER_H
+#include <memory>
+#include <vector>
+#include "types.h"
+#include "timers.h"
+#include "perfCounters.h"
+namespace QP_NNLS {
+class PhaseProfiler {
+    // accumulates wall and cpu time per solver phase, nested phases are allowed
+public:
+    class Scope {
+    public:
+        Scope() = delete;
+        Scope(PhaseProfiler& profiler, SolverPhase phase):
+            profiler(profiler)
+        {
+            profiler.Begin(phase);
+        }
+        ~Scope() {
+            profiler.End();
+        }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    private:
+        PhaseProfiler& profiler;
+    };
+
+    PhaseProfiler();
+    ~PhaseProfiler() = default;
+    void Enable(bool enable, bool cpuTime, bool hwCounters = false);
+    void Reset();
+    void Begin(SolverPhase phase);
+    void End();
+    void Fill(SolverProfile& profile);
+    double GetWall(SolverPhase phase) const; // seconds
+private:
+    struct Frame {
+        SolverPhase phase;
+        ticks_t wallBegin;
+        ticks_t cpuBegin;
+        ticks_t childWall;
+        ticks_t childCpu;
+        HwCounts hwBegin;
+        HwCounts childHw;
+    };
+    struct Accumulator {
+        ticks_t wall = 0;
+        ticks_t cpu = 0;
+        ticks_t selfWall = 0;
+        ticks_t selfCpu = 0;
+        unsg_t calls = 0;
+        HwCounts hw;
+        HwCounts selfHw;
+    };
+    std::unique_ptr<iTimer> wallClock;
+    std::unique_ptr<iTimer> cpuClock;
+    std::vector<Frame> stack;
+    std::array<Accumulator, nSolverPhases> phases{};
+    PerfCounters perf;
+    HwCounts hwStart;
+    bool enabled = false;
+    bool cpuTime = false;
+    bool hwCounters = false;
+};
+}
+#endif // NNLS_QP_SOLVER_PROFILER_H
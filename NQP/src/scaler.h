@@ -3,6 +3,7 @@
 #include "types.h"
 #include "utils.h"
 #include <cmath>
+#include <utility>
 namespace QP_NNLS {
 
 class MBScaler {
@@ -29,25 +30,23 @@ struct ScaleCoefs {
 class OrtScaler {
 public:
     OrtScaler() = delete;
-    OrtScaler(matrix_t& M, std::vector<double>& s):
-        M(M), s(s)
+    // mNorm2: squared norms of NNLS rows of M, rows are not modified, row scales are applied by the caller
+    OrtScaler(std::vector<double> mNorm2, std::vector<double>& s):
+        mNorm2(std::move(mNorm2)), s(s)
     {}
     ~OrtScaler() = default;
 
     void Scale() {
-        scaleCoefs.resize(M.size());
-        balanceFactor.resize(M.size(), 1.0);
+        scaleCoefs.resize(s.size());
+        balanceFactor.resize(s.size(), 1.0);
         const double thMin = 1.0e-5;
         const double thMax = 1.0e5;
         const double minSf = 1.0e-8;
         bool scaleLimited = true;
         double scaleFactorSL = 1.0;
         double scaleFactorSU = 1.0;
-        for (std::size_t i = 0; i < M.size(); ++i) {
-            double norm2 = 0.0;
-            for (std::size_t j = 0; j < M[i].size(); ++j) {
-                norm2 += M[i][j] * M[i][j];
-            }
+        for (std::size_t i = 0; i < s.size(); ++i) {
+            const double norm2 = mNorm2[i];
             double s2 = s[i] * s[i];
             const double rat = norm2 / s2;
             if (thMin < rat && rat < thMax) {
@@ -87,13 +86,10 @@ public:
         }
 
 
-        for (std::size_t i = 0; i < M.size(); ++i) {
+        for (std::size_t i = 0; i < s.size(); ++i) {
             s[i] *= scaleFactorS;
             scaleCoefs[i] = 1.0 / sqrt(scaleCoefs[i] + s[i] * s[i]);
             s[i] *= scaleCoefs[i];
-            for (std::size_t j = 0; j < M[i].size(); ++j) {
-                M[i][j] *= scaleCoefs[i];
-            }
         }
         sCoefs.scaleFactorS = scaleFactorS;
     }
@@ -105,8 +101,9 @@ public:
     const ScaleCoefs& GetScaleCoefs() {
         return sCoefs;
     }
+    double GetRowScale(std::size_t i) const { return scaleCoefs[i]; }
 private:
-    matrix_t& M;
+    std::vector<double> mNorm2;
     std::vector<double>& s;
     double scaleFactorS = 1.0;
     std::vector<double> scaleCoefs;
@@ -0,0 +1,65 @@
+#ifndef QP_NNLS_SPSC_RING_H
+#define QP_NNLS_SPSC_RING_H
+#include <atomic>
+#include <vector>
+#include <cstddef>
+namespace QP_NNLS {
+template<typename T> class SpscRing {
+    // Bounded lock-free ring for exactly one producer and one consumer thread.
+    // Slots are allocated once and reused, so a producer that assigns into
+    // BeginPush() keeps the capacity of vectors inside T and does not allocate.
+    // Capacity is rounded up to a power of two.
+public:
+    SpscRing() = delete;
+    explicit SpscRing(std::size_t capacity):
+        slots(RoundUp(capacity)),
+        mask(slots.size() - 1)
+    {}
+    ~SpscRing() = default;
+    SpscRing(const SpscRing& other) = delete;
+    SpscRing& operator=(const SpscRing& other) = delete;
+    T* BeginPush() {
+        // producer: returns free slot or nullptr if the ring is full
+        const std::size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == slots.size()) {
+            return nullptr;
+        }
+        return &slots[t & mask];
+    }
+    void EndPush() {
+        // producer: publish slot returned by BeginPush()
+        tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+    T* Front() {
+        // consumer: returns oldest published slot or nullptr if the ring is empty
+        const std::size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        return &slots[h & mask];
+    }
+    void Pop() {
+        // consumer: release slot returned by Front()
+        head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+    bool Empty() const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+    std::size_t Capacity() const {
+        return slots.size();
+    }
+private:
+    static std::size_t RoundUp(std::size_t n) {
+        std::size_t p = 1;
+        while (p < n) {
+            p <<= 1;
+        }
+        return p;
+    }
+    std::vector<T> slots;
+    const std::size_t mask;
+    alignas(64) std::atomic<std::size_t> head{0}; // written by consumer only
+    alignas(64) std::atomic<std::size_t> tail{0}; // written by producer only
+};
+}
+#endif // QP_NNLS_SPSC_RING_H
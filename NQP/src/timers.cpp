@@ -1,6 +1,25 @@
 #include "timers.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
 
 namespace QP_NNLS {
+namespace {
+void SplitToIntervals(ticks_t time, TimeIntervals& intervals) {
+	using ull = unsigned long long;
+	constexpr ull musInHour = 1000U * 1000U * 3600U;
+	constexpr ull musInMinute = 1000U * 1000U * 60U;
+	constexpr ull musInSec = 1000U * 1000U;
+	constexpr ull musInMs = 1000U;
+	intervals.hours = time / musInHour;
+	intervals.minutes = (time - intervals.hours * musInHour) / musInMinute;
+	intervals.sec = (time - intervals.hours * musInHour - intervals.minutes * musInMinute) / musInSec;
+	intervals.ms = (time - intervals.hours * musInHour - intervals.minutes * musInMinute - intervals.sec * musInSec) / musInMs;
+	intervals.mus = time % 1000;
+}
+}
 
 wcTimer::wcTimer() {
 	active = false;
@@ -28,17 +47,66 @@ void wcTimer::Reset() {
 	active = false;
 }
 
+ticks_t wcTimer::NsFromStart() {
+	return active ? std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - tStart).count() : 0;
+}
+
 void wcTimer::toIntervals(ticks_t time, TimeIntervals& intervals) {
-	using ull = unsigned long long;
-	constexpr ull musInHour = 1000U * 1000U * 3600U;
-	constexpr ull musInMinute = 1000U * 1000U * 60U;
-	constexpr ull musInSec = 1000U * 1000U;
-	constexpr ull musInMs = 1000U;
-	intervals.hours = time / musInHour;
-	intervals.minutes = (time - intervals.hours * musInHour) / musInMinute;
-	intervals.sec = (time - intervals.hours * musInHour - intervals.minutes * musInMinute) / musInSec;
-	intervals.ms = (time - intervals.hours * musInHour - intervals.minutes * musInMinute - intervals.sec * musInSec) / musInMs;
-	intervals.mus = time % 1000;
+	SplitToIntervals(time, intervals);
+}
+
+cpuTimer::cpuTimer() {
+	active = false;
+}
+
+ticks_t cpuTimer::ThreadTimeNs() {
+#ifdef _WIN32
+	FILETIME creation, exit, kernel, user;
+	if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user)) {
+		return 0;
+	}
+	const ticks_t kernel100ns = (static_cast<ticks_t>(kernel.dwHighDateTime) << 32) | kernel.dwLowDateTime;
+	const ticks_t user100ns = (static_cast<ticks_t>(user.dwHighDateTime) << 32) | user.dwLowDateTime;
+	return (kernel100ns + user100ns) * 100U;
+#else
+	timespec ts;
+	if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) {
+		return 0;
+	}
+	return static_cast<ticks_t>(ts.tv_sec) * 1000000000U + static_cast<ticks_t>(ts.tv_nsec);
+#endif
+}
+
+void cpuTimer::Start() {
+	active = true;
+	tStart = ThreadTimeNs();
+	tCur = tStart;
+}
+
+ticks_t cpuTimer::Ticks() {
+	if (!active) {
+		return 0;
+	}
+	const ticks_t timePoint = ThreadTimeNs();
+	ticks = (timePoint - tCur) / 1000U;
+	tCur = timePoint;
+	return ticks;
+}
+
+ticks_t cpuTimer::TimeFromStart() {
+	return active ? (ThreadTimeNs() - tStart) / 1000U : 0;
+}
+
+ticks_t cpuTimer::NsFromStart() {
+	return active ? ThreadTimeNs() - tStart : 0;
+}
+
+void cpuTimer::Reset() {
+	active = false;
+}
+
+void cpuTimer::toIntervals(ticks_t time, TimeIntervals& intervals) {
+	SplitToIntervals(time, intervals);
 }
 
 }
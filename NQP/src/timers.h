@@ -24,6 +24,7 @@ public:
 	virtual ticks_t Ticks() = 0;  //number of ticks from start
 	virtual void Reset() = 0;
 	virtual ticks_t TimeFromStart() = 0;
+	virtual ticks_t NsFromStart() = 0; // nanoseconds, for short intervals
 	virtual void toIntervals(ticks_t time, TimeIntervals& intervals) = 0;
 protected:
 	iTimer() = default;
@@ -38,12 +39,32 @@ public:
 	void Reset() override;
 	void toIntervals(ticks_t time, TimeIntervals& intervals) override;
 	ticks_t TimeFromStart() override;
+	ticks_t NsFromStart() override;
 protected:
 	ticks_t ticks = 0;
 	std::chrono::time_point<std::chrono::steady_clock> tStart{};
 	std::chrono::time_point<std::chrono::steady_clock> tCur{};
 	bool active = false;
 };
+
+class cpuTimer : public iTimer {
+	// cpu time of the calling thread
+public:
+	cpuTimer();
+	virtual ~cpuTimer() = default;
+	void Start() override;
+	ticks_t Ticks() override;
+	void Reset() override;
+	void toIntervals(ticks_t time, TimeIntervals& intervals) override;
+	ticks_t TimeFromStart() override;
+	ticks_t NsFromStart() override;
+protected:
+	static ticks_t ThreadTimeNs();
+	ticks_t ticks = 0;
+	ticks_t tStart = 0;
+	ticks_t tCur = 0;
+	bool active = false;
+};
 }
 #endif
 
@@ -1,6 +1,7 @@
 
 #ifndef NNLS_QP_SOLVER_TYPES_H
 #define NNLS_QP_SOLVER_TYPES_H
+#include <array>
 #include <vector>
 #include <list>
 #include <string>
@@ -9,11 +10,14 @@
 #include <set>
 #include "timers.h"
 namespace QP_NNLS {
-using matrix_t = std::vector<std::vector<double>>;
+template <typename Scalar>
+using matrix_type = std::vector<std::vector<Scalar>>;
+using matrix_t = matrix_type<double>;
 using unsg_t = unsigned int;
 namespace CONSTANTS {
     constexpr double cholFactorZero = 1.0e-7;
     constexpr double pivotZero = 1.0e-7;
+    constexpr double infiniteBound = 1.0e19; // problems store missing bounds as +-1e20
 }
 static_assert(CONSTANTS::cholFactorZero > 0.0);
 static_assert(CONSTANTS::pivotZero > 0.0);
@@ -59,6 +63,12 @@ enum class CholPivotingStrategy {
 	UNKNOWN
 };
 
+enum class HessianStructure {
+    AUTO = 0, // band Cholesky when the bandwidth of H is small
+    DENSE,
+    BANDED, // band Cholesky with the bandwidth of H, diagonal H is bandwidth 0
+};
+
 enum class GammaUpdateStrategyDual {
 	NO_UPDATE = 0,
 	INCREMENT_BY_S_COMPONENT,
@@ -77,6 +87,14 @@ struct LinSolverOutput {
     std::list<unsg_t>  indices;
 };
 
+struct LinSolverStats {
+    unsg_t refactorizations = 0; // factorizations from scratch
+    unsg_t activeSetChanges = 0; // Add / Delete calls, the cumulative solvers refactorize in the next Solve
+    double flopsAdd = 0.0;
+    double flopsDelete = 0.0;
+    double flopsSolve = 0.0;
+};
+
 struct ActiveSetUpdateSettings {
     int rptInterval = 0;
     bool rejectSingular = false;
@@ -89,6 +107,7 @@ struct CoreSettings {
     LinSolverType linSolverType = LinSolverType::MSS1;
     DBScalerStrategy dbScalerStrategy = DBScalerStrategy::SCALE_FACTOR;
     CholPivotingStrategy cholPvtStrategy = CholPivotingStrategy::NO_PIVOTING;
+    HessianStructure hessianStructure = HessianStructure::AUTO; // NO_PIVOTING only
     unsg_t nDualIterations = 1000;
     unsg_t nPrimalIterations = 100;
     double nnlsResidNormFsb = 1.0e-16;
@@ -96,7 +115,17 @@ struct CoreSettings {
     double nnlsPrimalZero = -1.0e-7; //-1.0e-7; //zp < 0 => zp < nnlsPrimalZero
     double minNNLSDualTol = -1.0e-12;
     double prLtZero = 1.0e-14;
+    unsg_t lambdaRefinementSteps = 3; // corrections of the active set multipliers with the factorization of the linear solver
+    double lambdaRefinementTol = 0.0; // on max |s_A - M_A * M_A_T * lambda_A| relative to max |s_A|, 0: until no progress
     bool gammaUpdate = true;
+    bool profile = false; // per phase timings in SolverOutput::profile, a clock read per phase call
+    bool profileCpuTime = false; // also measure cpu time of the solver thread
+    bool profileHwCounters = false; // perf_event counters per phase (linux), ~1 mus per phase call
+    bool reuseFactorization = false; // keep Cholesky factor of H, skipped on next problem with the same H
+    bool presolve = false; // remove empty, duplicate, singleton and redundant rows and fixed variables
+    bool eliminateEqualities = false; // solve over the null space of the equality rows, bounds become rows
+    std::chrono::nanoseconds timeLimit = std::chrono::nanoseconds::zero(); // wall time budget of Solve, zero: none
+    bool mixedPrecision = false; // pricing and MSS1 solves in float, the final active set is refined in double
     ActiveSetUpdateSettings actSetUpdtSettings;
 };
 
@@ -125,13 +154,15 @@ struct DenseQPProblem {
 	//1/2xtHx + cx
 	//Ax <= b
 	//Fx = g
+	//bLw <= Ax for ranged rows
 	matrix_t H;
     matrix_t A;
     std::vector<double> b;
+    std::vector<double> bLw; // empty or A.size(), entries <= -infiniteBound are one-sided, ignored for equality rows
     std::vector<double> c;
     std::vector<double> up;
     std::vector<double> lw;
-    unsg_t nEqConstraints;
+    unsg_t nEqConstraints = 0; // first rows of A, F * x = g
 };
 
 struct SparseQPProblem {
@@ -154,7 +185,8 @@ enum class DualLoopExitStatus {
 	FULL_ACTIVE_SET,
 	ITERATIONS,
 	INFEASIBILITY,
-	UNKNOWN
+	UNKNOWN,
+	TIME_LIMIT, // CoreSettings::timeLimit expired, the least violating iterate is returned
 };
 
 enum class PrimalLoopExitStatus {
@@ -165,7 +197,8 @@ enum class PrimalLoopExitStatus {
 	SINGULAR_MATRIX,
 	DIDNT_STARTED,
     LINE_SEARCH_FAILED,
-	UNKNOWN
+	UNKNOWN,
+	TIME_LIMIT,
 };
 
 enum class SolverExitStatus {
@@ -181,18 +214,102 @@ enum class PreprocStatus {
     INIT_FAILED
 };
 
+enum class SolverPhase {
+    CHOLETSKY = 0,
+    INVERSION,
+    M_FORMATION,
+    SCALING,
+    PRICING,
+    LS_ADD,
+    LS_DELETE,
+    LS_SOLVE,
+    LINE_SEARCH,
+    SOLUTION_RECOVERY,
+    DUALITY_GAP,
+    PRESOLVE, // presolve, equality elimination and postsolve
+    N_PHASES
+};
+constexpr std::size_t nSolverPhases = static_cast<std::size_t>(SolverPhase::N_PHASES);
+
+enum class HwCounter {
+    CYCLES = 0,
+    INSTRUCTIONS,
+    CACHE_MISSES,
+    BRANCH_MISSES,
+    N_COUNTERS
+};
+constexpr std::size_t nHwCounters = static_cast<std::size_t>(HwCounter::N_COUNTERS);
+
+struct HwCounts {
+    unsigned long long operator[](HwCounter counter) const { return values[static_cast<std::size_t>(counter)]; }
+    std::array<unsigned long long, nHwCounters> values{};
+};
+
+struct PhaseTime {
+    // seconds, self time excludes nested phases
+    double wall = 0.0;
+    double cpu = 0.0;
+    double selfWall = 0.0;
+    double selfCpu = 0.0;
+    unsg_t calls = 0;
+    HwCounts hw; // zero if SolverProfile::hwCounters is false
+    HwCounts selfHw;
+};
+
+struct SolverProfile {
+    const PhaseTime& operator[](SolverPhase phase) const { return phases[static_cast<std::size_t>(phase)]; }
+    std::array<PhaseTime, nSolverPhases> phases{};
+    double wall = 0.0; // InitProblem + Solve
+    double cpu = 0.0;
+    HwCounts hw;
+    bool enabled = false;
+    bool cpuTime = false;
+    bool hwCounters = false; // requested and perf events are available
+};
+
+struct SolverCounters {
+    const double& Flops(SolverPhase phase) const { return flops[static_cast<std::size_t>(phase)]; }
+    double& Flops(SolverPhase phase) { return flops[static_cast<std::size_t>(phase)]; }
+    unsg_t primalIterations = 0;
+    unsg_t activeSetAdds = 0;
+    unsg_t activeSetDeletes = 0;
+    unsg_t lineSearchSteps = 0;
+    unsg_t singularSolves = 0; // linear solver reported nDNegative > 0
+    unsg_t refactorizations = 0;
+    unsg_t activeSetChanges = 0; // Add / Delete calls of the linear solver
+    unsg_t peakActiveSet = 0;
+    unsg_t warmStartSize = 0; // active set taken from the warm start hint
+    unsg_t presolveRows = 0; // rows of A removed by presolve
+    unsg_t presolveVariables = 0; // fixed variables removed by presolve
+    unsg_t eliminatedEqualities = 0; // equality rows removed by the null space reduction
+    unsg_t hessianBandwidth = 0; // bandwidth used by the band Cholesky
+    unsg_t lowPrecisionIterations = 0; // mixedPrecision: dual iterations priced in float
+    unsg_t lambdaRefinements = 0; // corrections applied to the active set multipliers
+    double lambdaResidual = 0.0; // max |s_A - M_A * M_A_T * lambda_A| after the refinement, scaled problem
+    bool lambdaFactorizationReused = false; // false: multipliers from a fresh LDL of M_A * M_A_T
+    unsg_t bestIteration = 0; // TIME_LIMIT: dual iteration of the returned iterate
+    bool bandedFactorization = false;
+    bool factorizationReused = false;
+    std::array<double, nSolverPhases> flops{}; // estimates per kernel
+};
+
 struct SolverOutput {
     DualLoopExitStatus dualExitStatus;
     PrimalLoopExitStatus primalExitStatus;
     unsg_t nDualIterations;
-	double maxViolation;
+	double maxViolation = 0.0; // max of violations, abs on equality rows; TIME_LIMIT: distance to feasibility of the returned iterate
 	double dualityGap;
     double cost;
     std::vector<double> x;
-    std::vector<double> lambda;
+    std::vector<double> lambda; // rows of A, signed for equality rows
     std::vector<double> lambdaLw;
     std::vector<double> lambdaUp;
+    std::vector<double> lambdaRowLw; // lower sides of ranged rows, empty without them
     std::vector<double> violations;
+    // NNLS indices: rows of A, then upper and lower bound of every variable, then lower sides of ranged rows
+    std::vector<unsg_t> activeSet;
+    SolverProfile profile;
+    SolverCounters counters;
 };
 
 }
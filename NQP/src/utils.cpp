@@ -1,5 +1,6 @@
 #include "utils.h"
 #include <cmath>
+#include <algorithm>
 #include <iostream>
 
 #include <Eigen/Dense>
@@ -391,6 +392,96 @@ namespace QP_NNLS {
             }
         }
     }
+    unsg_t Bandwidth(const matrix_t& M) {
+        const std::size_t n = M.size();
+        std::size_t bw = 0;
+        for (std::size_t r = 0; r < n; ++r) {
+            for (std::size_t c = 0; c + bw < r; ++c) {
+                if (M[r][c] != 0.0 || M[c][r] != 0.0) {
+                    bw = r - c;
+                    break;
+                }
+            }
+        }
+        return static_cast<unsg_t>(bw);
+    }
+    bool ComputeBandCholFactorT(const matrix_t& M, unsg_t bw, matrix_t& cholF, CholetskyOutput& output) {
+        // ComputeCholFactorT restricted to the band: L[k][c] = 0 for k - c > bw,
+        // the skipped terms of the sums are exact zeros, the factor is the same as the dense one
+        output.negativeBlocking = 1.0;
+        output.negativeDiag.clear();
+        output.pivoting = false;
+        const int n = static_cast<int>(M.size());
+        const int w = static_cast<int>(bw);
+        for (int row = n - 1; row >= 0; --row) {
+            const int colBegin = std::max(0, row - w);
+            std::fill(cholF[row].begin(), cholF[row].begin() + colBegin, 0.0);
+            for (int col = row; col >= colBegin; --col) {
+                double sum = 0.0;
+                for (int k = std::min(n - 1, col + w); k > row; --k) {
+                    sum += cholF[k][col] * cholF[k][row];
+                }
+                double factor = M[row][col] - sum;
+                if (col == row) {
+                    if (std::fabs(factor) < CONSTANTS::cholFactorZero) {
+                        output.negativeDiag.emplace_back(row, factor);
+                        factor = CONSTANTS::cholFactorZero;
+                    } else if (factor < 0.0) {
+                        output.negativeBlocking = factor;
+                        return false;
+                    }
+                    cholF[row][col] = sqrt(factor);
+                } else {
+                    cholF[row][col] = (1.0 / cholF[row][row]) * factor;
+                }
+            }
+        }
+        return true;
+    }
+    void InvertBandCholetsky(const matrix_t& Chol, unsg_t bw, matrix_t& Inv) {
+        // InvertCholetsky with the sum over the band of row r, Inv is dense low triangular
+        const std::size_t n = Chol.size();
+        for (std::size_t r = 0; r < n; ++r) {
+            const double diagInv = 1.0 / Chol[r][r];
+            const std::size_t iBegin = r > bw ? r - bw : 0;
+            for (std::size_t c = 0; c <= r; ++c) {
+                Inv[r][c] = (c == r) ? 1.0 : 0.0;
+                for (std::size_t i = std::max(iBegin, c); i < r; ++i) {
+                    Inv[r][c] -= Chol[r][i] * Inv[i][c];
+                }
+                Inv[r][c] *= diagInv;
+            }
+        }
+    }
+    void SolveBandCholetskyT(const matrix_t& Chol, unsg_t bw, const std::vector<double>& rhs, std::vector<double>& y) {
+        // Chol_T * y = rhs, backward: y_r = (rhs_r - sum_{k = r + 1 .. r + bw} Chol[k][r] * y_k) / Chol[r][r]
+        const std::size_t n = Chol.size();
+        y.assign(n, 0.0);
+        std::size_t last = n;
+        while (last > 0 && rhs[last - 1] == 0.0) {
+            --last; // y_r = 0 below the last nonzero of rhs, bound rows of the jacobian are unit vectors
+        }
+        for (std::size_t r = last; r-- > 0;) {
+            double sum = rhs[r];
+            const std::size_t kEnd = std::min(last, r + bw + 1);
+            for (std::size_t k = r + 1; k < kEnd; ++k) {
+                sum -= Chol[k][r] * y[k];
+            }
+            y[r] = sum / Chol[r][r];
+        }
+    }
+    void SolveBandCholetsky(const matrix_t& Chol, unsg_t bw, const std::vector<double>& rhs, std::vector<double>& y) {
+        // Chol * y = rhs, forward: y_r = (rhs_r - sum_{k = r - bw .. r - 1} Chol[r][k] * y_k) / Chol[r][r]
+        const std::size_t n = Chol.size();
+        y.resize(n);
+        for (std::size_t r = 0; r < n; ++r) {
+            double sum = rhs[r];
+            for (std::size_t k = r > bw ? r - bw : 0; k < r; ++k) {
+                sum -= Chol[r][k] * y[k];
+            }
+            y[r] = sum / Chol[r][r];
+        }
+    }
 #ifdef EIGEN
 	void InvertEigen(const matrix_t& M, matrix_t& Inv) {
 		const int m = M.size();
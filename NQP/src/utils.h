@@ -33,6 +33,19 @@ namespace QP_NNLS {
 
 	void Mult(const matrix_t& M, const std::vector<double>& v, std::vector<double>& Mv); // Mv = M * v
 
+	template <typename Scalar>
+	void Mult(const matrix_type<Scalar>& M, const std::vector<Scalar>& v, std::vector<Scalar>& Mv) { // Mv = M * v in Scalar
+		const std::size_t m = v.size();
+		for (std::size_t i = 0; i < M.size(); ++i) {
+			const Scalar* row = M[i].data();
+			Scalar sum = Scalar(0);
+			for (std::size_t j = 0; j < m; ++j) {
+				sum += row[j] * v[j];
+			}
+			Mv[i] = sum;
+		}
+	}
+
 	void VSum(const std::vector<double>& v1, const std::vector<double>& v2, std::vector<double>& sum); // sum = v1 + v2
 
 	void VAdd(std::vector<double>& v1, const std::vector<double>& v2); // v1 += v2
@@ -71,6 +84,16 @@ namespace QP_NNLS {
 
     void InvertCholetsky(const matrix_t& Chol, matrix_t& Inv); // invert hemitian matrix M using it's Choletsky decomposition M = L * L_T
 
+    unsg_t Bandwidth(const matrix_t& M); // max |i - j| over M[i][j] != 0, 0 for diagonal M
+
+    bool ComputeBandCholFactorT(const matrix_t& M, unsg_t bw, matrix_t& cholF, CholetskyOutput& output); // M = cholF_T * cholF, M has bandwidth bw, O(n * bw^2)
+
+    void InvertBandCholetsky(const matrix_t& Chol, unsg_t bw, matrix_t& Inv); // Chol^-1, Chol is low triangular with bandwidth bw, O(n^2 * bw)
+
+    void SolveBandCholetskyT(const matrix_t& Chol, unsg_t bw, const std::vector<double>& rhs, std::vector<double>& y); // y = Chol^-T * rhs, O(n * bw)
+
+    void SolveBandCholetsky(const matrix_t& Chol, unsg_t bw, const std::vector<double>& rhs, std::vector<double>& y); // y = Chol^-1 * rhs, O(n * bw)
+
 	matrix_t& operator-(matrix_t& M); // M -> -M
 
 	static inline bool isSame(double cand, double val, double tol = 1.0e-16) {
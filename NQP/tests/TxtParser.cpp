@@ -1,50 +1,74 @@
 #include "TxtParser.h"
 #include <cassert>
+#include <charconv>
 #include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <algorithm>
+#include <string>
+#include <thread>
 namespace TXT_QP_PARSER {
-TxtParser::TxtParser():
-    file(),
-    stages(std::vector<bool>(nstages, false))
-{}
-const QP_NNLS::DenseQPProblem& TxtParser::Parse(const std::string& file, bool& status) {
-    stages = std::vector<bool>(nstages, false);
-    if (OpenFile(file)) {
-        status = true;
-        try {
-            ParseHessian();
-            ParseJacobian();
-            ParseCVector();
-            ParseLb();
-            ParseUb();
-            for (auto res: stages) {
-                if (!res) {
-                    status = false;
-                }
+namespace {
+inline bool IsSeparator(char c) {
+    return c == ' ' || c == ',' || c == '\n' || c == '\r' || c == '\t';
+}
+
+bool ParseValues(const char* bg, const char* en, std::vector<double>& v) {
+    // comma / white space separated values of [bg, en)
+    v.clear();
+    v.reserve(std::count(bg, en, ',') + 1);
+    const char* p = bg;
+    while (true) {
+        while (p < en && IsSeparator(*p)) {
+            ++p;
+        }
+        if (p == en) {
+            return true;
+        }
+        if (*p == '+') {
+            ++p; // from_chars does not accept explicit plus sign
+        }
+        double value = 0.0;
+        const auto [ptr, ec] = std::from_chars(p, en, value);
+        if (ec == std::errc::result_out_of_range) {
+            // from_chars leaves value untouched: overflow is a missing bound, underflow is zero
+            value = std::strtod(std::string(p, ptr).c_str(), nullptr);
+            if (std::isinf(value)) {
+                value = std::copysign(1.0e20, value);
             }
-        } catch (...) {
-            fid.close();
-            status = false;
+        } else if (ec != std::errc()) {
+            return false;
         }
-        fid.close();
-    } else {
-        status = false;
+        v.push_back(value);
+        p = ptr;
     }
-    std::cout << "read";
-    return problem;
+}
 }
 
-bool TxtParser::OpenFile(const std::string& file) {
-    fid = std::ifstream(file , std::ifstream::in);
-    if (fid.is_open()) {
-        fid.seekg(0, fid.end);
-        fSize = fid.tellg();
-        curPos = 0;
-        bufPos = 0;
-        fid.seekg(0, fid.beg);
-        return true;
+TxtParser::TxtParser():
+    stages(std::vector<bool>(nstages, false))
+{}
+void TxtParser::SetParallel(unsigned int nThreads, std::size_t minSectionSize) {
+    this->nThreads = nThreads;
+    minParallelSize = minSectionSize;
+}
+const QP_NNLS::DenseQPProblem& TxtParser::Parse(const std::string& fileName, bool& status) {
+    stages = std::vector<bool>(nstages, false);
+    status = false;
+    if (!file.Open(fileName)) {
+        return problem;
     }
-    return false;
+    cur = file.Data();
+    end = cur + file.Size();
+    ParseHessian();
+    ParseJacobian();
+    ParseCVector();
+    ParseLb();
+    ParseUb();
+    status = std::all_of(stages.begin(), stages.end(), [](bool res) { return res; });
+    file.Close();
+    cur = end = nullptr;
+    return problem;
 }
 
 void TxtParser::ParseHessian() {
@@ -73,86 +97,101 @@ void TxtParser::ParseUb(){
     }
 }
 bool TxtParser::ReadMatrix(QP_NNLS::matrix_t& m) {
-    m.clear();
-    assert(fSize > curPos);
-    const unsigned int rSize = std::min(BUFFER_SIZE, fSize - curPos);
-    if (fid.tellg() != -1) {
-        std::cout << " off" << fid.tellg();
-        fid.read(&buf[0], rSize);
-        bufPos = 0;
+    // {{row}, {row}, ...}, rows are located first and parsed in place, by several threads if large
+    if (!FindNextToken('{')) {
+        return false;
     }
-    bool matBgFound = false;
+    const char* const bg = ++cur;
+    rows.clear();
     while (true) {
-        const char nextToken = FindNextToken();
-        if (!matBgFound) {
-            if (nextToken == '{') {
-                matBgFound = true;
-            }
-        } else {
-            if (nextToken == '{') {
-                m.emplace_back();
-                ReadVector(m.back());
-                if (m.size() > 1 && (m.back().size() != m[m.size() - 2].size())) {
-                    return false;
-                }
-            } else if (nextToken == '}') {
-                ++curPos;
-                ++bufPos;
-                return true;
-            } else {
-                abort();
+        while (cur < end && IsSeparator(*cur)) {
+            ++cur;
+        }
+        if (cur == end) {
+            return false;
+        } else if (*cur == '}') {
+            ++cur;
+            break;
+        } else if (*cur != '{') {
+            return false;
+        }
+        const char* rowEnd = static_cast<const char*>(std::memchr(cur, '}', end - cur));
+        if (rowEnd == nullptr) {
+            return false;
+        }
+        rows.emplace_back(cur + 1, rowEnd);
+        cur = rowEnd + 1;
+    }
+    m.resize(rows.size());
+    const std::size_t sectionSize = cur - bg;
+    const unsigned int nWorkers = std::min<std::size_t>(rows.size(),
+                                  nThreads > 0 ? nThreads : std::max(1U, std::thread::hardware_concurrency()));
+    bool ok = true;
+    if (nWorkers <= 1 || sectionSize < minParallelSize) {
+        ok = ReadRows(m, 0, rows.size());
+    } else {
+        // contiguous row ranges of similar byte size
+        std::vector<std::thread> workers;
+        std::vector<char> results(nWorkers, 1);
+        std::size_t first = 0;
+        for (unsigned int w = 0; w < nWorkers; ++w) {
+            const char* const target = bg + sectionSize * (w + 1) / nWorkers;
+            std::size_t last = first;
+            while (last < rows.size() && (rows[last].first < target || w + 1 == nWorkers)) {
+                ++last;
             }
+            workers.emplace_back([this, &m, &results, w, first, last]() {
+                results[w] = ReadRows(m, first, last) ? 1 : 0;
+            });
+            first = last;
         }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        ok = std::all_of(results.begin(), results.end(), [](char res) { return res != 0; });
+    }
+    if (!ok) {
+        return false;
     }
-    return false;
+    for (std::size_t i = 1; i < m.size(); ++i) {
+        if (m[i].size() != m.front().size()) {
+            return false;
+        }
+    }
+    return true;
 }
-bool TxtParser::ReadVector(std::vector<double>& v) {
-    v.clear();
-    bool bgFound = false;
-    std::string value;
-    while (curPos < fSize) {
-        const char el = buf[bufPos];
-        if (!bgFound) {
-            if (el == '{') {
-                bgFound = true;
-            }
-        } else {
-            if (el == ',') {
-                if (!value.empty()) {
-                    v.push_back(std::stod(value));
-                }
-                value.clear();
-            }
-            else if (('0' <= el && el <= '9') || el == '.' || el == '-' || el == 'e' || el == '+'){
-                value.push_back(el);
-            }
-            else if (el == '}') {
-                if (!value.empty()) {
-                    v.push_back(std::stod(value));
-                }
-                ++curPos;
-                ++bufPos;
-                return true;
-            } else {
-
-            }
+bool TxtParser::ReadRows(QP_NNLS::matrix_t& m, std::size_t first, std::size_t last) {
+    for (std::size_t i = first; i < last; ++i) {
+        if (!ParseValues(rows[i].first, rows[i].second, m[i])) {
+            return false;
         }
-        ++curPos;
-        ++bufPos;
     }
-    return false;
+    return true;
+}
+bool TxtParser::ReadVector(std::vector<double>& v) {
+    if (!FindNextToken('{')) {
+        return false;
+    }
+    const char* vecEnd = static_cast<const char*>(std::memchr(cur, '}', end - cur));
+    if (vecEnd == nullptr) {
+        return false;
+    }
+    const bool ok = ParseValues(cur + 1, vecEnd, v);
+    cur = vecEnd + 1;
+    return ok;
 }
 
-char TxtParser::FindNextToken() {
-    while (curPos < fSize) {
-        const char token = buf[bufPos];
-        if (token == '{' || token == '}') {
-            return token;
-        }
-        ++curPos;
-        ++bufPos;
+bool TxtParser::FindNextToken(char token) {
+    if (cur == nullptr) {
+        return false;
+    }
+    const char* pos = static_cast<const char*>(std::memchr(cur, token, end - cur));
+    if (pos == nullptr) {
+        cur = end;
+        return false;
     }
-    return '!'; // not found
+    cur = pos;
+    return true;
 }
 
 DenseProblemFormatter::DenseProblemFormatter() = default;
@@ -216,41 +255,45 @@ const QP_NNLS::DenseQPProblem& DenseProblemFormatter::PrepareProblem(const std::
 }
 
 void DenseProblemFormatter::GenJac(DENSE_PROBLEM_FORMAT fmt) {
+    // equality rows first, then RIGHT: a * x <= up and -a * x <= -lw per row,
+    // LEFT_RIGHT: one ranged row lw <= a * x <= up
     const std::size_t nv = pt.H.size();
-    const std::size_t nc = pt.A.size();
     const std::size_t nb = pt.lw.size();
-    const std::size_t nEqC = linEqC.size();
     const std::size_t nConstraints = nb - nv; // min number of constraints
-    if (fmt == DENSE_PROBLEM_FORMAT::RIGHT) {
-        problem.A.clear();
-        problem.b.clear();
-        for (auto i : linEqC) {
-            problem.A.emplace_back(nv, 0.0);
-            if (i >= nConstraints) {
-               std::size_t ix = i - nConstraints;
-               problem.A.back()[ix] = 1.0;
-            } else {
-                for (std::size_t j = 0; j < nv; ++j) {
-                    problem.A.back()[j] = pt.A[i][j];
-                }
+    const bool ranged = fmt == DENSE_PROBLEM_FORMAT::LEFT_RIGHT;
+    problem.A.clear();
+    problem.b.clear();
+    problem.bLw.clear();
+    for (auto i : linEqC) {
+        problem.A.emplace_back(nv, 0.0);
+        if (i >= nConstraints) {
+           std::size_t ix = i - nConstraints;
+           problem.A.back()[ix] = 1.0;
+        } else {
+            for (std::size_t j = 0; j < nv; ++j) {
+                problem.A.back()[j] = pt.A[i][j];
             }
-            problem.b.push_back(pt.up[i]);
         }
-        for (std::size_t i = 0; i < nConstraints; ++i) {
-            if (std::find(linEqC.begin(), linEqC.end(), i) == linEqC.end()) {
-                std::size_t sz = problem.A.size() + 2;
-                problem.A.resize(sz, std::vector<double>(nv));
-                problem.b.resize(sz);
-                for (std::size_t j = 0; j < nv; ++j) {
-                    problem.A[sz - 2][j] = pt.A[i][j];
-                    problem.A[sz - 1][j] = -pt.A[i][j];
-                    problem.b[sz - 2] = pt.up[i];
-                    problem.b[sz - 1] = -pt.lw[i];
-                }
+        problem.b.push_back(pt.up[i]);
+        if (ranged) {
+            problem.bLw.push_back(pt.lw[i]);
+        }
+    }
+    for (std::size_t i = 0; i < nConstraints; ++i) {
+        if (std::find(linEqC.begin(), linEqC.end(), i) != linEqC.end()) {
+            continue;
+        }
+        problem.A.emplace_back(pt.A[i].begin(), pt.A[i].begin() + nv);
+        problem.b.push_back(pt.up[i]);
+        if (ranged) {
+            problem.bLw.push_back(pt.lw[i]);
+        } else {
+            problem.A.emplace_back(nv);
+            for (std::size_t j = 0; j < nv; ++j) {
+                problem.A.back()[j] = -pt.A[i][j];
             }
+            problem.b.push_back(-pt.lw[i]);
         }
-    } else if (fmt == DENSE_PROBLEM_FORMAT::LEFT_RIGHT) {
-        problem.A = QP_NNLS::matrix_t(pt.A.begin(), pt.A.begin() + nConstraints);
     }
 }
 
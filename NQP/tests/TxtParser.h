@@ -1,15 +1,13 @@
 #ifndef TXTPARSER_H
 #define TXTPARSER_H
 #include <iostream>
-#include <fstream>
+#include "mapped_file.h"
 #include "types.h"
 
 
 namespace TXT_QP_PARSER {
 
-const unsigned int MAX_VALUE_LENGTH = 20U;
-const unsigned int MAX_VALUES = 1000000U;
-const unsigned int BUFFER_SIZE = 100 * MAX_VALUE_LENGTH * MAX_VALUES;
+const std::size_t PARALLEL_SECTION_SIZE = 1U << 20; // matrices larger than this are parsed by several threads
 
 enum class DENSE_PROBLEM_FORMAT {
     LEFT_RIGHT = 0, // lw <= Ax <= up
@@ -22,21 +20,23 @@ struct ProblemFormatterStatus {
 };
 
 class TxtParser {
+    // file is memory mapped, values are parsed with from_chars directly into the problem
 public:
     TxtParser();
     ~TxtParser() = default;
     const QP_NNLS::DenseQPProblem& Parse(const std::string& file, bool& status);
+    // nThreads = 0: hardware concurrency
+    void SetParallel(unsigned int nThreads, std::size_t minSectionSize = PARALLEL_SECTION_SIZE);
 private:
     const unsigned int nstages = 5;
-    std::string file;
     std::vector<bool> stages;
     QP_NNLS::DenseQPProblem problem;
-    std::ifstream fid;
-    char buf[BUFFER_SIZE];
-    unsigned int fSize = 0;
-    unsigned int curPos = 0;
-    unsigned int bufPos = 0;
-    bool OpenFile(const std::string& file);
+    MappedFile file;
+    const char* cur = nullptr;
+    const char* end = nullptr;
+    unsigned int nThreads = 0;
+    std::size_t minParallelSize = PARALLEL_SECTION_SIZE;
+    std::vector<std::pair<const char*, const char*>> rows; // row contents between braces
     void ParseHessian();
     void ParseJacobian();
     void ParseCVector();
@@ -44,7 +44,8 @@ private:
     void ParseUb();
     bool ReadMatrix(QP_NNLS::matrix_t& m);
     bool ReadVector(std::vector<double>& v);
-    char FindNextToken();
+    bool ReadRows(QP_NNLS::matrix_t& m, std::size_t first, std::size_t last);
+    bool FindNextToken(char token);
 };
 
 class DenseProblemFormatter {
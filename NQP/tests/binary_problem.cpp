@@ -0,0 +1,277 @@
+#include "binary_problem.h"
+#include <cstring>
+#include <fstream>
+#include <vector>
+namespace BINARY_QP_FORMAT {
+using namespace QP_NNLS;
+namespace {
+std::uint64_t Align(std::uint64_t offset) {
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+template<typename T>
+void Append(std::vector<char>& buf, const T* data, std::size_t n) {
+    const char* bytes = reinterpret_cast<const char*>(data);
+    buf.insert(buf.end(), bytes, bytes + n * sizeof(T));
+}
+
+std::size_t CountNonZeros(const matrix_t& m) {
+    std::size_t nnz = 0;
+    for (const auto& row : m) {
+        for (double v : row) {
+            nnz += v != 0.0 ? 1 : 0;
+        }
+    }
+    return nnz;
+}
+
+void Encode(const matrix_t& m, std::size_t cols, double sparseDensity, Section& section, std::vector<char>& buf) {
+    section.rows = static_cast<std::uint32_t>(m.size());
+    section.cols = static_cast<std::uint32_t>(cols);
+    const std::size_t nnz = CountNonZeros(m);
+    const std::size_t nElements = m.size() * cols;
+    if (nElements > 0 && nnz < sparseDensity * nElements) {
+        section.storage = Storage::SPARSE;
+        section.nnz = nnz;
+        std::vector<std::uint64_t> rowPtr(1, 0);
+        std::vector<std::uint32_t> colIndices;
+        std::vector<double> values;
+        colIndices.reserve(nnz);
+        values.reserve(nnz);
+        for (const auto& row : m) {
+            for (std::size_t j = 0; j < row.size(); ++j) {
+                if (row[j] != 0.0) {
+                    colIndices.push_back(static_cast<std::uint32_t>(j));
+                    values.push_back(row[j]);
+                }
+            }
+            rowPtr.push_back(values.size());
+        }
+        if (colIndices.size() % 2 != 0) {
+            colIndices.push_back(0); // values stay 8 bytes aligned
+        }
+        Append(buf, rowPtr.data(), rowPtr.size());
+        Append(buf, colIndices.data(), colIndices.size());
+        Append(buf, values.data(), values.size());
+    } else {
+        section.storage = Storage::DENSE;
+        section.nnz = nElements;
+        for (const auto& row : m) {
+            Append(buf, row.data(), row.size());
+        }
+    }
+}
+
+void Encode(const std::vector<double>& v, Section& section, std::vector<char>& buf) {
+    section.storage = Storage::DENSE;
+    section.rows = 1;
+    section.cols = static_cast<std::uint32_t>(v.size());
+    section.nnz = v.size();
+    Append(buf, v.data(), v.size());
+}
+}
+
+bool WriteProblem(const std::string& filePath, const DenseQPProblem& problem, std::uint16_t flags, double sparseDensity) {
+    const std::size_t nV = problem.H.size();
+    Header header{};
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = version;
+    header.flags = flags;
+    header.endianTag = endianTag;
+    header.nVariables = static_cast<std::uint32_t>(nV);
+    header.nConstraints = static_cast<std::uint32_t>(problem.A.size());
+    header.nEqConstraints = problem.nEqConstraints;
+    header.nSections = static_cast<std::uint32_t>(nSections);
+    Section sections[nSections]{};
+    std::vector<char> data[nSections];
+    Encode(problem.H, nV, sparseDensity, sections[0], data[0]);
+    Encode(problem.A, nV, sparseDensity, sections[1], data[1]);
+    Encode(problem.b, sections[2], data[2]);
+    Encode(problem.c, sections[3], data[3]);
+    Encode(problem.lw, sections[4], data[4]);
+    Encode(problem.up, sections[5], data[5]);
+    Encode(problem.bLw, sections[6], data[6]);
+    std::uint64_t offset = Align(sizeof(Header) + sizeof(sections));
+    for (std::size_t i = 0; i < nSections; ++i) {
+        sections[i].id = static_cast<SectionId>(i);
+        sections[i].offset = offset;
+        sections[i].size = data[i].size();
+        offset = Align(offset + data[i].size());
+    }
+    std::ofstream fid(filePath, std::ios::binary | std::ios::trunc);
+    if (!fid.is_open()) {
+        return false;
+    }
+    const char padding[alignment] = {};
+    fid.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    fid.write(reinterpret_cast<const char*>(sections), sizeof(sections));
+    std::uint64_t written = sizeof(header) + sizeof(sections);
+    for (std::size_t i = 0; i < nSections; ++i) {
+        fid.write(padding, sections[i].offset - written);
+        fid.write(data[i].data(), data[i].size());
+        written = sections[i].offset + data[i].size();
+    }
+    fid.write(padding, Align(written) - written);
+    return fid.good();
+}
+
+bool ProblemFile::Open(const std::string& filePath) {
+    errMsg.clear();
+    if (!file.Open(filePath)) {
+        return Fail("failed to open " + filePath);
+    }
+    if (file.Size() < sizeof(Header) + sizeof(sections)) {
+        return Fail("file is too short");
+    }
+    std::memcpy(&header, file.Data(), sizeof(Header));
+    if (std::memcmp(header.magic, magic, sizeof(magic)) != 0) {
+        return Fail("not a binary problem file");
+    }
+    if (header.version != version) {
+        return Fail("unsupported version " + std::to_string(header.version));
+    }
+    if (header.endianTag != endianTag) {
+        return Fail("file was written with different byte order");
+    }
+    if (header.nSections != nSections) {
+        return Fail("unexpected number of sections");
+    }
+    std::memcpy(sections, file.Data() + sizeof(Header), sizeof(sections));
+    for (std::size_t i = 0; i < nSections; ++i) {
+        if (sections[i].id != static_cast<SectionId>(i) || !Validate(sections[i])) {
+            return Fail("corrupted section " + std::to_string(i));
+        }
+    }
+    const std::uint32_t nV = header.nVariables;
+    const std::uint32_t nC = header.nConstraints;
+    const Section& H = GetSection(SectionId::H);
+    const Section& A = GetSection(SectionId::A);
+    if (H.rows != nV || H.cols != nV || A.rows != nC || (nC > 0 && A.cols != nV) ||
+        header.nEqConstraints > nC) {
+        return Fail("section dimensions don't match header");
+    }
+    for (SectionId id : {SectionId::B, SectionId::C, SectionId::LW, SectionId::UP, SectionId::BLW}) {
+        // vectors are always written dense as a single row
+        const Section& v = GetSection(id);
+        if (v.storage != Storage::DENSE || v.rows != 1) {
+            return Fail("corrupted section " + std::to_string(static_cast<std::size_t>(id)));
+        }
+    }
+    if (GetSection(SectionId::B).cols != nC || GetSection(SectionId::C).cols != nV ||
+        GetSection(SectionId::LW).cols != nV || GetSection(SectionId::UP).cols != nV ||
+        (GetSection(SectionId::BLW).cols != 0 && GetSection(SectionId::BLW).cols != nC)) {
+        return Fail("section dimensions don't match header");
+    }
+    return true;
+}
+
+bool ProblemFile::Fail(const std::string& msg) {
+    errMsg = msg;
+    file.Close();
+    return false;
+}
+
+bool ProblemFile::Validate(const Section& section) {
+    // offset and size come from the file, compare against the remaining size so nothing can overflow
+    if (section.offset % alignment != 0 || section.offset > file.Size() || section.size > file.Size() - section.offset) {
+        return false;
+    }
+    const std::uint64_t rows = section.rows;
+    const std::uint64_t cols = section.cols;
+    if (section.storage == Storage::DENSE) {
+        // rows * cols of two u32 fits u64, the byte count may not
+        return section.size % sizeof(double) == 0 && section.size / sizeof(double) == rows * cols;
+    } else if (section.storage == Storage::SPARSE) {
+        if (section.nnz > rows * cols || section.nnz > section.size / sizeof(double)) {
+            return false;
+        }
+        const std::uint64_t nIndices = section.nnz + section.nnz % 2;
+        if (section.size != (rows + 1) * sizeof(std::uint64_t) + nIndices * sizeof(std::uint32_t) +
+                            section.nnz * sizeof(double)) {
+            return false;
+        }
+        const SparseView view = Sparse(section.id);
+        if (view.rowPtr[0] != 0 || view.rowPtr[rows] != section.nnz) {
+            return false;
+        }
+        for (std::uint64_t i = 0; i < rows; ++i) {
+            if (view.rowPtr[i] > view.rowPtr[i + 1]) {
+                return false;
+            }
+        }
+        for (std::uint64_t k = 0; k < section.nnz; ++k) {
+            if (view.colIndices[k] >= cols) {
+                return false;
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+DenseView ProblemFile::Dense(SectionId id) const {
+    const Section& section = GetSection(id);
+    DenseView view;
+    if (section.storage == Storage::DENSE) {
+        view.data = reinterpret_cast<const double*>(file.Data() + section.offset);
+        view.rows = section.rows;
+        view.cols = section.cols;
+    }
+    return view;
+}
+
+SparseView ProblemFile::Sparse(SectionId id) const {
+    const Section& section = GetSection(id);
+    SparseView view;
+    if (section.storage == Storage::SPARSE) {
+        const char* base = file.Data() + section.offset;
+        view.rows = section.rows;
+        view.cols = section.cols;
+        view.nnz = section.nnz;
+        view.rowPtr = reinterpret_cast<const std::uint64_t*>(base);
+        view.colIndices = reinterpret_cast<const std::uint32_t*>(base + (view.rows + 1) * sizeof(std::uint64_t));
+        view.values = reinterpret_cast<const double*>(base + (view.rows + 1) * sizeof(std::uint64_t) +
+                                                      (view.nnz + view.nnz % 2) * sizeof(std::uint32_t));
+    }
+    return view;
+}
+
+void ProblemFile::CopyMatrix(SectionId id, matrix_t& m) const {
+    const Section& section = GetSection(id);
+    m.resize(section.rows);
+    if (section.storage == Storage::DENSE) {
+        const DenseView view = Dense(id);
+        for (std::size_t i = 0; i < view.rows; ++i) {
+            m[i].assign(view.Row(i), view.Row(i) + view.cols);
+        }
+    } else {
+        const SparseView view = Sparse(id);
+        for (std::size_t i = 0; i < view.rows; ++i) {
+            m[i].assign(view.cols, 0.0);
+            for (std::uint64_t k = view.rowPtr[i]; k < view.rowPtr[i + 1]; ++k) {
+                m[i][view.colIndices[k]] = view.values[k];
+            }
+        }
+    }
+}
+
+void ProblemFile::CopyVector(SectionId id, std::vector<double>& v) const {
+    const DenseView view = Dense(id);
+    v.assign(view.data, view.data + view.cols);
+}
+
+bool ProblemFile::ToProblem(DenseQPProblem& problem) const {
+    if (!file.IsOpen()) {
+        return false;
+    }
+    CopyMatrix(SectionId::H, problem.H);
+    CopyMatrix(SectionId::A, problem.A);
+    CopyVector(SectionId::B, problem.b);
+    CopyVector(SectionId::C, problem.c);
+    CopyVector(SectionId::LW, problem.lw);
+    CopyVector(SectionId::UP, problem.up);
+    CopyVector(SectionId::BLW, problem.bLw);
+    problem.nEqConstraints = header.nEqConstraints;
+    return true;
+}
+}
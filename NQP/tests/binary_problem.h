@@ -0,0 +1,107 @@
+#ifndef NNLS_TESTS_BINARY_PROBLEM_H
+#define NNLS_TESTS_BINARY_PROBLEM_H
+#include <cstdint>
+#include <string>
+#include "mapped_file.h"
+#include "types.h"
+namespace BINARY_QP_FORMAT {
+// Binary container of DenseQPProblem, little endian.
+// header:   "NQPB" | u16 version | u16 flags | u32 endian tag | u32 nVariables | u32 nConstraints
+//           | u32 nEqConstraints | u32 nSections
+// sections: table of Section entries, then section data, every data block 64 bytes aligned
+// dense:    rows * cols doubles, row major
+// sparse:   CSR, u64 rowPtr[rows + 1] | u32 colIndices[nnz] (padded to 8 bytes) | double values[nnz]
+constexpr char magic[4] = {'N', 'Q', 'P', 'B'};
+constexpr std::uint16_t version = 2; // 2: BLW section
+constexpr std::uint32_t endianTag = 0x01020304;
+constexpr std::size_t alignment = 64;
+constexpr std::uint16_t flagLeftRight = 0x01; // A rows are lw <= Ax <= up, DENSE_PROBLEM_FORMAT::LEFT_RIGHT
+
+enum class SectionId : std::uint32_t {
+    H = 0,
+    A,
+    B,
+    C,
+    LW,
+    UP,
+    BLW, // lower sides of ranged rows, empty if the problem has none
+    N_SECTIONS
+};
+constexpr std::size_t nSections = static_cast<std::size_t>(SectionId::N_SECTIONS);
+
+enum class Storage : std::uint32_t {
+    DENSE = 0,
+    SPARSE
+};
+
+struct Header {
+    char magic[4];
+    std::uint16_t version;
+    std::uint16_t flags;
+    std::uint32_t endianTag;
+    std::uint32_t nVariables;
+    std::uint32_t nConstraints;
+    std::uint32_t nEqConstraints;
+    std::uint32_t nSections;
+    std::uint32_t reserved;
+};
+static_assert(sizeof(Header) == 32, "binary problem header layout");
+
+struct Section {
+    SectionId id;
+    Storage storage;
+    std::uint64_t offset; // from file begin
+    std::uint64_t size;   // bytes
+    std::uint32_t rows;   // vectors: rows = 1
+    std::uint32_t cols;
+    std::uint64_t nnz;    // sparse only
+};
+static_assert(sizeof(Section) == 40, "binary problem section layout");
+
+struct DenseView {
+    const double* data = nullptr;
+    std::size_t rows = 0;
+    std::size_t cols = 0;
+    const double* Row(std::size_t i) const { return data + i * cols; }
+    double operator()(std::size_t i, std::size_t j) const { return data[i * cols + j]; }
+};
+
+struct SparseView {
+    const std::uint64_t* rowPtr = nullptr;
+    const std::uint32_t* colIndices = nullptr;
+    const double* values = nullptr;
+    std::size_t rows = 0;
+    std::size_t cols = 0;
+    std::size_t nnz = 0;
+};
+
+// sections with density below sparseDensity are written in CSR, vectors are always dense
+bool WriteProblem(const std::string& filePath, const QP_NNLS::DenseQPProblem& problem,
+                  std::uint16_t flags = 0, double sparseDensity = 0.25);
+
+class ProblemFile {
+    // views point into the mapped file and are valid until Close / next Open
+public:
+    ProblemFile() = default;
+    ~ProblemFile() = default;
+    bool Open(const std::string& filePath);
+    void Close() { file.Close(); }
+    const std::string& GetError() const { return errMsg; }
+    const Header& GetHeader() const { return header; }
+    const Section& GetSection(SectionId id) const { return sections[static_cast<std::size_t>(id)]; }
+    bool IsSparse(SectionId id) const { return GetSection(id).storage == Storage::SPARSE; }
+    DenseView Dense(SectionId id) const;   // empty view for sparse sections
+    SparseView Sparse(SectionId id) const; // empty view for dense sections
+    bool ToProblem(QP_NNLS::DenseQPProblem& problem) const; // copies views to problem storage
+private:
+    bool Fail(const std::string& msg); // closes file
+    bool Validate(const Section& section);
+    void CopyMatrix(SectionId id, QP_NNLS::matrix_t& m) const;
+    void CopyVector(SectionId id, std::vector<double>& v) const;
+    TXT_QP_PARSER::MappedFile file;
+    Header header{};
+    Section sections[nSections]{};
+    std::string errMsg;
+};
+}
+#endif // NNLS_TESTS_BINARY_PROBLEM_H
@@ -0,0 +1,28 @@
+#ifndef NNLS_TESTS_MAPPED_FILE_H
+#define NNLS_TESTS_MAPPED_FILE_H
+#include <cstddef>
+#include <string>
+namespace TXT_QP_PARSER {
+class MappedFile {
+    // read only memory mapping of a whole file, unmapped in destructor
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    bool Open(const std::string& filePath);
+    void Close();
+    bool IsOpen() const { return isOpen; }
+    const char* Data() const { return data; }
+    std::size_t Size() const { return size; }
+private:
+    const char* data = nullptr;
+    std::size_t size = 0;
+    bool isOpen = false;
+#ifdef _WIN32
+    void* file = nullptr;
+    void* mapping = nullptr;
+#endif
+};
+}
+#endif // NNLS_TESTS_MAPPED_FILE_H
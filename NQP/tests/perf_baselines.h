@@ -0,0 +1,30 @@
+#ifndef NNLS_TESTS_PERF_BASELINES_H
+#define NNLS_TESTS_PERF_BASELINES_H
+#include "types.h"
+namespace PERF_BASELINES {
+struct PerfBaseline {
+    const char* name;
+    QP_NNLS::unsg_t dualIterations;
+    QP_NNLS::unsg_t primalIterations;
+    double budget; // median setup + solve time in units of the calibration workload
+};
+// regenerate with NQP_PERF_RECORD=<file> nnls_tests --gtest_filter=*PerfGate* and paste the file here,
+// budgets are recorded with the profiler off. Maros-Meszaros entries are skipped when
+// TST_CONFIG::DENSE_ONLY_INQ_CONSTR_PATH does not exist
+constexpr PerfBaseline baselines[] = {
+    {"case_1", 14, 16, 1.09},
+    {"case_2", 1, 1, 0.0358},
+    {"case_3", 2, 2, 0.0665},
+    {"case_4", 2, 2, 0.0708},
+    {"s2f_0_9", 22, 32, 2.36},
+    {"s2f_0_12", 21, 30, 2.41},
+    {"gen_box_100", 82, 82, 147},
+    {"gen_mpc_100", 51, 51, 67},
+    {"gen_portfolio_100", 92, 95, 196},
+    {"gen_svm_100", 110, 136, 308},
+    {"gen_tall_50", 66, 85, 70.5},
+    {"HS21", 1, 1, 0.0286},
+    {"HS35", 1, 1, 0.03},
+};
+}
+#endif // NNLS_TESTS_PERF_BASELINES_H
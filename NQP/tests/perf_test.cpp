@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include "configuration.h"
+#include "decorators.h"
+#include "perf_baselines.h"
+#include "qp_generator.h"
+#include "test_data.h"
+#include "test_utils.h"
+#include "TxtParser.h"
+#include "utils.h"
+// Performance gates, registered in ctest under the "perf" label:
+// iteration counts must not grow, normalized time must stay within budget * NQP_PERF_TIME_MARGIN
+namespace PERF_BASELINES {
+void PrintTo(const PerfBaseline& baseline, std::ostream* os) {
+    *os << baseline.name;
+}
+}
+
+namespace PERF_GATES {
+using namespace PERF_BASELINES;
+using namespace QP_NNLS_TEST_DATA;
+using Clock = std::chrono::steady_clock;
+
+double EnvDouble(const char* name, double defaultValue) {
+    const char* value = std::getenv(name);
+    return value == nullptr ? defaultValue : std::atof(value);
+}
+
+template<typename F>
+double MedianTime(F&& f, double minBatch = 0.02) {
+    // batches of doubling size until one takes minBatch, median of 5 batches per call
+    int calls = 1;
+    while (true) {
+        const auto tStart = Clock::now();
+        for (int i = 0; i < calls; ++i) {
+            f();
+        }
+        if (std::chrono::duration<double>(Clock::now() - tStart).count() >= minBatch || calls >= (1 << 16)) {
+            break;
+        }
+        calls *= 2;
+    }
+    std::vector<double> samples;
+    for (int s = 0; s < 5; ++s) {
+        const auto tStart = Clock::now();
+        for (int i = 0; i < calls; ++i) {
+            f();
+        }
+        samples.push_back(std::chrono::duration<double>(Clock::now() - tStart).count() / calls);
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+double CalibrationTime() {
+    // dense product built with the solver's flags, machine speed unit for budgets
+    static const double time = []() {
+        const std::size_t n = 64;
+        matrix_t M1(n, std::vector<double>(n));
+        matrix_t M2(n, std::vector<double>(n));
+        matrix_t M(n, std::vector<double>(n));
+        for (std::size_t i = 0; i < n; ++i) {
+            for (std::size_t j = 0; j < n; ++j) {
+                M1[i][j] = 1.0 / (1.0 + i + j);
+                M2[i][j] = 1.0 / (1.0 + i * j);
+            }
+        }
+        return MedianTime([&]() { Mult(M1, M2, M); });
+    }();
+    return time;
+}
+
+bool GetProblem(const std::string& name, DenseQPProblem& problem) {
+    const std::vector<std::pair<std::string, const QPProblem*>> cases = {
+        {"case_1", &case_1}, {"case_2", &case_2}, {"case_3", &case_3}, {"case_4", &case_4},
+        {"s2f_0_9", &s2f_0_9}, {"s2f_0_12", &s2f_0_12}};
+    for (const auto& [caseName, qp] : cases) {
+        if (name == caseName) {
+            ProblemReader pr;
+            pr.Init(qp->H, qp->c, qp->A, qp->b);
+            problem = pr.getProblem();
+            return true;
+        }
+    }
+    const std::string genPrefix = "gen_";
+    if (name.rfind(genPrefix, 0) == 0) {
+        // gen_<family>_<n>
+        const std::size_t sep = name.rfind('_');
+        QP_GENERATOR::QPFamily family;
+        if (!QP_GENERATOR::FromString(name.substr(genPrefix.size(), sep - genPrefix.size()), family)) {
+            return false;
+        }
+        const unsigned int n = static_cast<unsigned int>(std::stoi(name.substr(sep + 1)));
+        problem = QP_GENERATOR::Generate(family, n, family == QP_GENERATOR::QPFamily::TALL ? 4 * n : n / 20, 1);
+        return true;
+    }
+    // Maros-Meszaros problem, skipped when the benchmark set is not available
+    const std::string file = TST_CONFIG::DENSE_ONLY_INQ_CONSTR_PATH + name + ".txt";
+    if (!std::filesystem::exists(file)) {
+        return false;
+    }
+    TXT_QP_PARSER::DenseProblemFormatter fmt;
+    problem = fmt.PrepareProblem(file);
+    return fmt.GetRetStatus().status;
+}
+
+class PerfGate : public ::testing::TestWithParam<PerfBaseline> {};
+
+TEST_P(PerfGate, IterationsAndTime) {
+    const PerfBaseline& baseline = GetParam();
+    DenseQPProblem problem;
+    if (!GetProblem(baseline.name, problem)) {
+        GTEST_SKIP() << baseline.name << " is not available";
+    }
+    SolverOutput output;
+    Settings settings = NqpTestSettingsDefault;
+    settings.coreSettings.profile = false; // budgets are recorded without profiler overhead
+    const double time = MedianTime([&]() {
+        // new solver each time: settings are modified during initialization
+        QPNNLSDense solver;
+        solver.Init(settings);
+        solver.SetProblem(problem);
+        solver.Solve();
+        output = solver.GetOutput();
+    });
+    const double normalized = time / CalibrationTime();
+    if (const char* record = std::getenv("NQP_PERF_RECORD")) {
+        std::ofstream fid(record, std::ios::app);
+        fid << "    {\"" << baseline.name << "\", " << output.nDualIterations << ", "
+            << output.counters.primalIterations << ", " << normalized << "},\n";
+        return;
+    }
+    const double margin = EnvDouble("NQP_PERF_TIME_MARGIN", 3.0);
+    EXPECT_LE(output.nDualIterations, baseline.dualIterations);
+    EXPECT_LE(output.counters.primalIterations, baseline.primalIterations);
+    EXPECT_LE(normalized, baseline.budget * margin) << "time " << time << " s, calibration "
+                                                    << CalibrationTime() << " s";
+    if (output.nDualIterations < baseline.dualIterations) {
+        std::cout << baseline.name << ": " << output.nDualIterations << " dual iterations, baseline "
+                  << baseline.dualIterations << " can be lowered\n";
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(Baselines, PerfGate, ::testing::ValuesIn(baselines),
+                         [](const ::testing::TestParamInfo<PerfBaseline>& info) { return std::string(info.param.name); });
+}
@@ -692,6 +692,12 @@ Two alternative definitions are provided in order to give ANSI
 compliance.
 (Thanks got to Martin Wauchope for providing this correction)
 */
+static integer iterc = 0; // iterations of the last ql0002_ call
+
+int ql0001_iterations() {
+    return iterc;
+}
+
 #ifdef C_PLUS_PLUS
 int ql0002_(const integer *n, const integer *m, const integer *meq, const integer *mmax,
             const integer *mn, const integer *mnn, const integer *nmax,
@@ -736,7 +742,7 @@ integer *lw;
     static doublereal diagr;
     static integer ifinc, kfinc, jfinc, mflag, nflag;
     static doublereal vfact, tempa;
-    static integer iterc, itref;
+    static integer itref;
     static doublereal cvmax, ratio, xmagr;
     static integer kdrop;
     static logical lower;
@@ -6,5 +6,6 @@ int ql0001_(const int * m, const int * me, const int * mmax, const int * n, cons
             const double * xu, double * x, double * u, const int * iout, int * ifail,
             const int * log_level, double * war, int * lwar, int * iwar, int * liwar,
             const double * eps1); 
+int ql0001_iterations(); // iterations of the last ql0001_ call
 }
 #endif
\ No newline at end of file
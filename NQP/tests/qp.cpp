@@ -2,7 +2,6 @@
 #include "qld.h"
 #include <cassert>
 #include <cmath>
-#include <gtest/gtest.h>
 
 namespace QP_SOLVERS {
     
@@ -20,7 +19,7 @@ namespace QP_SOLVERS {
     void solveQLD(const QPInput& input, QPOutput& output){
         int nMax = static_cast<int>(input.m_H.size());
         int nConstraints = static_cast<int>(input.m_A.size());
-        int nEqConstraints = 0;
+        int nEqConstraints = input.m_nEqConstraints;
         int nVariables = static_cast<int>(input.m_x0.size());
         int mRows = std::max(nConstraints, 1);
         int mPlus2N = nConstraints + 2 * nVariables;
@@ -68,7 +67,7 @@ namespace QP_SOLVERS {
         }
      
         output.exitStatus = status == 0 ? 0 : 1;
-        std::cout << "QLD status " << status << std::endl;
+        output.nIterations = ql0001_iterations();
         if (status == 0) {
             output.m_x = x;
             output.m_cost = cost;
@@ -182,68 +181,4 @@ void solveDAQP(const QPInput& input, QPOutput& output) {
     }
 }
 #endif
-  
-void solveQP(const std::string& logfile, unsigned int iteration,
-            QP_SOLVER_TYPE solverType, FSQP_QP_PROBLEM_TYPE fsqpQPType, QPOutput& output) {
-    using namespace FSQP_LOG_PARSER;
-    IterationData iterData;
-    ReadIteration(logfile, iteration, iterData);
-    QPInput input;
-    input.m_H = iterData.m_hessianD0;
-    input.m_A = iterData.m_jacobianD0;
-    input.m_cV = iterData.m_cVectorD0;
-    input.m_bV = iterData.m_bVectorD0;
-    input.m_lower = iterData.m_lower;
-    input.m_upper = iterData.m_upper;
-    assert(input.m_A.size() == input.m_bV.size());
-    assert(input.m_lower.size() == input.m_upper.size());
-    const std::size_t nX = input.m_lower.size();
-    std::size_t hessSize = 0;
-    if (fsqpQPType == FSQP_QP_PROBLEM_TYPE::D0) {
-        input.m_lower = iterData.m_lowerD0;
-        input.m_upper = iterData.m_upperD0;
-        hessSize = nX + 1;
-    } else {
-        hessSize = nX;
-    }
-    assert(input.m_H.size() ==  hessSize);
-    if  (fsqpQPType == FSQP_QP_PROBLEM_TYPE::D0) {
-        input.m_H.resize(nX);
-        for (auto& row : input.m_H) {
-            assert(row.size() == hessSize);
-            row.resize(nX);
-        }
-    }
-    std::size_t nVars = input.m_H.size();
-    assert(input.m_cV.size() == nX); 
-    for (std::size_t iConstr = 0; iConstr < input.m_A.size(); ++iConstr) {
-        assert(input.m_A[iConstr].size() == nX);
-    }
-    input.m_x0 = std::vector<double>(nX, 0.0);
-    if (solverType == QP_SOLVER_TYPE::QLD) {
-        solveQLD(input, output);
-    } else {
-#ifdef DAQP
-        solveDAQP(input, output);
-#endif
-    }
-
-    ASSERT_EQ(iterData.m_d0.size(), output.m_x.size());
-
-    for (std::size_t i = 0; i < output.m_x.size(); ++i) {
-        EXPECT_GT(output.m_x[i], input.m_lower[i]) << "iteration/i = " << iteration << "/" << i;
-        EXPECT_LT(output.m_x[i], input.m_upper[i]) << "iteration/i = " << iteration << "/" << i;
-        EXPECT_NEAR(iterData.m_d0[i], output.m_x[i], 1e-6) << "iteration/i = " << iteration << "/" << i;
-    }
-    ASSERT_EQ(input.m_A.size(), output.m_lambda.size());
-    for (std::size_t i = 0; i < input.m_A.size(); ++i) {
-        EXPECT_NEAR(iterData.m_lambdaD0[i], output.m_lambda[i], 1e-4) << "iteration/i = " << iteration << "/" << i;
-    }
-    ASSERT_EQ(nX, output.m_lambdaU.size());
-    ASSERT_EQ(nX, output.m_lambdaL.size());
-    for (std::size_t i = 0; i < nX; ++i) {
-        EXPECT_NEAR(iterData.m_lambdaD0[input.m_A.size() + i], output.m_lambdaL[i], 1e-4) << "iteration/i = " << iteration << "/" << i;
-        EXPECT_NEAR(iterData.m_lambdaD0[input.m_A.size() + nX + i], output.m_lambdaU[i], 1e-4) << "iteration/i = " << iteration << "/" << i;
-    }
 }
-}
\ No newline at end of file
@@ -19,11 +19,13 @@ namespace QP_SOLVERS {
         std::vector<double> m_upper;
         matrix_t m_H; 
         matrix_t m_A;
+        int m_nEqConstraints = 0; // first rows of m_A
     };
     struct QPOutput {
         std::string m_errMsg;
         double m_cost;
         int exitStatus; // 0 - OK, 1 - INFEASIBLE
+        int nIterations = 0;
         std::vector<double> m_x;
         std::vector<double> m_lambda;
         std::vector<double> m_lambdaU;
@@ -35,6 +37,9 @@ namespace QP_SOLVERS {
                  QP_SOLVER_TYPE solverType, FSQP_QP_PROBLEM_TYPE fsqpQPType,
                  QPOutput& output);
     void solveQLD(const QPInput& input, QPOutput& output);
+#ifdef DAQP
+    void solveDAQP(const QPInput& input, QPOutput& output);
+#endif
 }
 
 #endif
\ No newline at end of file
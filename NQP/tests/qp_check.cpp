@@ -0,0 +1,71 @@
+#include "qp.h"
+#include <cassert>
+#include <gtest/gtest.h>
+
+// solveQP checks the reference solvers against the FSQP log with gtest assertions,
+// it is kept apart from qp.cpp so that nnls_bench does not depend on gtest
+namespace QP_SOLVERS {
+void solveQP(const std::string& logfile, unsigned int iteration,
+            QP_SOLVER_TYPE solverType, FSQP_QP_PROBLEM_TYPE fsqpQPType, QPOutput& output) {
+    using namespace FSQP_LOG_PARSER;
+    IterationData iterData;
+    ReadIteration(logfile, iteration, iterData);
+    QPInput input;
+    input.m_H = iterData.m_hessianD0;
+    input.m_A = iterData.m_jacobianD0;
+    input.m_cV = iterData.m_cVectorD0;
+    input.m_bV = iterData.m_bVectorD0;
+    input.m_lower = iterData.m_lower;
+    input.m_upper = iterData.m_upper;
+    assert(input.m_A.size() == input.m_bV.size());
+    assert(input.m_lower.size() == input.m_upper.size());
+    const std::size_t nX = input.m_lower.size();
+    std::size_t hessSize = 0;
+    if (fsqpQPType == FSQP_QP_PROBLEM_TYPE::D0) {
+        input.m_lower = iterData.m_lowerD0;
+        input.m_upper = iterData.m_upperD0;
+        hessSize = nX + 1;
+    } else {
+        hessSize = nX;
+    }
+    assert(input.m_H.size() ==  hessSize);
+    if  (fsqpQPType == FSQP_QP_PROBLEM_TYPE::D0) {
+        input.m_H.resize(nX);
+        for (auto& row : input.m_H) {
+            assert(row.size() == hessSize);
+            row.resize(nX);
+        }
+    }
+    std::size_t nVars = input.m_H.size();
+    assert(input.m_cV.size() == nX); 
+    for (std::size_t iConstr = 0; iConstr < input.m_A.size(); ++iConstr) {
+        assert(input.m_A[iConstr].size() == nX);
+    }
+    input.m_x0 = std::vector<double>(nX, 0.0);
+    if (solverType == QP_SOLVER_TYPE::QLD) {
+        solveQLD(input, output);
+    } else {
+#ifdef DAQP
+        solveDAQP(input, output);
+#endif
+    }
+
+    ASSERT_EQ(iterData.m_d0.size(), output.m_x.size());
+
+    for (std::size_t i = 0; i < output.m_x.size(); ++i) {
+        EXPECT_GT(output.m_x[i], input.m_lower[i]) << "iteration/i = " << iteration << "/" << i;
+        EXPECT_LT(output.m_x[i], input.m_upper[i]) << "iteration/i = " << iteration << "/" << i;
+        EXPECT_NEAR(iterData.m_d0[i], output.m_x[i], 1e-6) << "iteration/i = " << iteration << "/" << i;
+    }
+    ASSERT_EQ(input.m_A.size(), output.m_lambda.size());
+    for (std::size_t i = 0; i < input.m_A.size(); ++i) {
+        EXPECT_NEAR(iterData.m_lambdaD0[i], output.m_lambda[i], 1e-4) << "iteration/i = " << iteration << "/" << i;
+    }
+    ASSERT_EQ(nX, output.m_lambdaU.size());
+    ASSERT_EQ(nX, output.m_lambdaL.size());
+    for (std::size_t i = 0; i < nX; ++i) {
+        EXPECT_NEAR(iterData.m_lambdaD0[input.m_A.size() + i], output.m_lambdaL[i], 1e-4) << "iteration/i = " << iteration << "/" << i;
+        EXPECT_NEAR(iterData.m_lambdaD0[input.m_A.size() + nX + i], output.m_lambdaU[i], 1e-4) << "iteration/i = " << iteration << "/" << i;
+    }
+}
+}
\ No newline at end of file
@@ -0,0 +1,210 @@
+#include "qp_generator.h"
+#include <algorithm>
+#include <cmath>
+namespace QP_GENERATOR {
+using namespace QP_NNLS;
+namespace {
+constexpr double inf = 1.0e20;
+
+matrix_t RandomPD(Rng& rng, unsigned int n, double ridge) {
+    // H = G * G_T / n + ridge * I
+    matrix_t G(n, std::vector<double>(n));
+    for (auto& row : G) {
+        for (auto& v : row) {
+            v = rng.Uniform(-1.0, 1.0);
+        }
+    }
+    matrix_t H(n, std::vector<double>(n, 0.0));
+    for (unsigned int i = 0; i < n; ++i) {
+        for (unsigned int j = 0; j <= i; ++j) {
+            double sum = 0.0;
+            for (unsigned int k = 0; k < n; ++k) {
+                sum += G[i][k] * G[j][k];
+            }
+            H[i][j] = H[j][i] = sum / n;
+        }
+        H[i][i] += ridge;
+    }
+    return H;
+}
+
+void AddEquality(DenseQPProblem& problem, const std::vector<double>& row, double rhs) {
+    problem.A.push_back(row);
+    problem.b.push_back(rhs);
+    problem.A.emplace_back(row.size());
+    for (std::size_t j = 0; j < row.size(); ++j) {
+        problem.A.back()[j] = -row[j];
+    }
+    problem.b.push_back(-rhs);
+}
+
+void Box(Rng& rng, unsigned int n, DenseQPProblem& problem) {
+    problem.H = RandomPD(rng, n, 0.1);
+    for (unsigned int i = 0; i < n; ++i) {
+        problem.c[i] = rng.Uniform(-2.0, 2.0);
+        problem.lw[i] = -1.0;
+        problem.up[i] = 1.0;
+    }
+}
+
+void Mpc(Rng& rng, unsigned int n, DenseQPProblem& problem) {
+    // tracking of a random reference with input rate penalty, bandwidth 2
+    for (unsigned int i = 0; i < n; ++i) {
+        problem.H[i][i] = 1.0 + 2.0 * 0.5 + 2.0 * 0.1;
+        if (i + 1 < n) {
+            problem.H[i][i + 1] = problem.H[i + 1][i] = -0.5;
+        }
+        if (i + 2 < n) {
+            problem.H[i][i + 2] = problem.H[i + 2][i] = 0.1;
+        }
+        problem.c[i] = -std::sin(0.1 * i) * rng.Uniform(1.0, 3.0);
+        problem.lw[i] = -1.0;
+        problem.up[i] = 1.0;
+    }
+    const double du = 0.2;
+    for (unsigned int i = 0; i + 1 < n; ++i) {
+        std::vector<double> row(n, 0.0);
+        row[i] = -1.0;
+        row[i + 1] = 1.0;
+        problem.A.push_back(row);
+        problem.b.push_back(du);
+        row[i] = 1.0;
+        row[i + 1] = -1.0;
+        problem.A.push_back(row);
+        problem.b.push_back(du);
+    }
+}
+
+void Portfolio(Rng& rng, unsigned int n, unsigned int nSectors, DenseQPProblem& problem) {
+    // covariance of a factor model, expected returns in c
+    const unsigned int nFactors = std::max(1U, n / 10);
+    matrix_t F(n, std::vector<double>(nFactors));
+    for (auto& row : F) {
+        for (auto& v : row) {
+            v = rng.Normal() * 0.3;
+        }
+    }
+    for (unsigned int i = 0; i < n; ++i) {
+        for (unsigned int j = 0; j <= i; ++j) {
+            double sum = 0.0;
+            for (unsigned int k = 0; k < nFactors; ++k) {
+                sum += F[i][k] * F[j][k];
+            }
+            problem.H[i][j] = problem.H[j][i] = sum;
+        }
+        problem.H[i][i] += rng.Uniform(0.01, 0.1);
+        problem.c[i] = -rng.Uniform(0.0, 0.2);
+        problem.lw[i] = 0.0;
+        problem.up[i] = 1.0;
+    }
+    AddEquality(problem, std::vector<double>(n, 1.0), 1.0);
+    for (unsigned int s = 0; s < nSectors; ++s) {
+        std::vector<double> row(n, 0.0);
+        for (unsigned int i = s; i < n; i += nSectors) {
+            row[i] = 1.0;
+        }
+        problem.A.push_back(row);
+        problem.b.push_back(std::max(0.3, 2.0 / nSectors)); // equal weights are feasible
+    }
+}
+
+void SvmDual(Rng& rng, unsigned int n, DenseQPProblem& problem) {
+    // two gaussian clouds in 2d, gaussian kernel, labels alternate
+    std::vector<double> label(n);
+    matrix_t points(n, std::vector<double>(2));
+    for (unsigned int i = 0; i < n; ++i) {
+        label[i] = i % 2 == 0 ? 1.0 : -1.0;
+        points[i][0] = label[i] + rng.Normal();
+        points[i][1] = label[i] + rng.Normal();
+    }
+    for (unsigned int i = 0; i < n; ++i) {
+        for (unsigned int j = 0; j <= i; ++j) {
+            const double dx = points[i][0] - points[j][0];
+            const double dy = points[i][1] - points[j][1];
+            problem.H[i][j] = problem.H[j][i] = label[i] * label[j] * std::exp(-0.5 * (dx * dx + dy * dy));
+        }
+        problem.H[i][i] += 1.0e-3;
+        problem.c[i] = -1.0;
+        problem.lw[i] = 0.0;
+        problem.up[i] = 1.0;
+    }
+    AddEquality(problem, label, 0.0);
+}
+
+void Tall(Rng& rng, unsigned int n, unsigned int m, DenseQPProblem& problem) {
+    problem.H = RandomPD(rng, n, 1.0);
+    for (unsigned int i = 0; i < n; ++i) {
+        problem.c[i] = rng.Uniform(-10.0, 10.0);
+        problem.lw[i] = -10.0;
+        problem.up[i] = 10.0;
+    }
+    for (unsigned int r = 0; r < m; ++r) {
+        std::vector<double> row(n);
+        for (auto& v : row) {
+            v = rng.Uniform(-1.0, 1.0);
+        }
+        problem.A.push_back(row);
+        problem.b.push_back(rng.Uniform(0.1, 1.0));
+    }
+}
+}
+
+const char* ToString(QPFamily family) {
+    switch (family) {
+    case QPFamily::BOX: return "box";
+    case QPFamily::MPC: return "mpc";
+    case QPFamily::PORTFOLIO: return "portfolio";
+    case QPFamily::SVM_DUAL: return "svm";
+    case QPFamily::TALL: return "tall";
+    default: return "unknown";
+    }
+}
+
+bool FromString(const std::string& name, QPFamily& family) {
+    for (std::size_t i = 0; i < nFamilies; ++i) {
+        if (name == ToString(static_cast<QPFamily>(i))) {
+            family = static_cast<QPFamily>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+std::uint64_t Rng::Next() {
+    state += 0x9E3779B97F4A7C15ULL;
+    std::uint64_t z = state;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+double Rng::Uniform(double lw, double up) {
+    const double u = static_cast<double>(Next() >> 11) * (1.0 / 9007199254740992.0); // [0, 1)
+    return lw + (up - lw) * u;
+}
+
+double Rng::Normal() {
+    const double u1 = 1.0 - Uniform(0.0, 1.0); // (0, 1]
+    const double u2 = Uniform(0.0, 1.0);
+    return std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * 3.14159265358979323846 * u2);
+}
+
+DenseQPProblem Generate(QPFamily family, unsigned int n, unsigned int m, std::uint64_t seed) {
+    Rng rng(seed * nFamilies + static_cast<std::uint64_t>(family));
+    DenseQPProblem problem;
+    problem.H.assign(n, std::vector<double>(n, 0.0));
+    problem.c.assign(n, 0.0);
+    problem.lw.assign(n, -inf);
+    problem.up.assign(n, inf);
+    problem.nEqConstraints = 0;
+    switch (family) {
+    case QPFamily::BOX: Box(rng, n, problem); break;
+    case QPFamily::MPC: Mpc(rng, n, problem); break;
+    case QPFamily::PORTFOLIO: Portfolio(rng, n, std::max(1U, m), problem); break;
+    case QPFamily::SVM_DUAL: SvmDual(rng, n, problem); break;
+    case QPFamily::TALL: Tall(rng, n, m, problem); break;
+    default: break;
+    }
+    return problem;
+}
+}
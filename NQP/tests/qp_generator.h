@@ -0,0 +1,38 @@
+#ifndef NNLS_TESTS_QP_GENERATOR_H
+#define NNLS_TESTS_QP_GENERATOR_H
+#include <cstdint>
+#include <string>
+#include "types.h"
+namespace QP_GENERATOR {
+// Reproducible structured QP families: same (family, n, m, seed) gives the same problem
+// on every platform, all problems are feasible with positive definite H.
+// Equalities are written as two opposite inequalities.
+enum class QPFamily {
+    BOX = 0,      // dense H, bounds only
+    MPC,          // banded H, rate constraints |x[i+1] - x[i]| <= du, bounds
+    PORTFOLIO,    // H = F * F_T + D, budget sum(x) = 1, m sector limits, 0 <= x <= 1
+    SVM_DUAL,     // kernel Gram H, c = -1, 0 <= x <= C, y_T * x = 0
+    TALL,         // m random inequalities around interior point 0, bounds
+    N_FAMILIES
+};
+constexpr std::size_t nFamilies = static_cast<std::size_t>(QPFamily::N_FAMILIES);
+
+const char* ToString(QPFamily family);
+bool FromString(const std::string& name, QPFamily& family);
+
+class Rng {
+    // splitmix64, platform independent unlike std distributions
+public:
+    explicit Rng(std::uint64_t seed): state(seed) {}
+    std::uint64_t Next();
+    double Uniform(double lw, double up);
+    double Normal(); // Box-Muller
+private:
+    std::uint64_t state;
+};
+
+// m is used by PORTFOLIO (number of sector limits) and TALL (number of inequalities),
+// other families derive constraints from n
+QP_NNLS::DenseQPProblem Generate(QPFamily family, unsigned int n, unsigned int m, std::uint64_t seed);
+}
+#endif // NNLS_TESTS_QP_GENERATOR_H
@@ -4,6 +4,9 @@
 #include <iostream>
 #include <fstream>
 #include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <string_view>
 namespace  FSQP_LOG_PARSER {
     std::vector<std::string> split(const std::string& str, char delimeter)
     {
@@ -53,7 +56,7 @@ namespace  FSQP_LOG_PARSER {
             if (delPos == std::string::npos || delPos > pEnd) {
                 delPos = pEnd;
             }
-            if (curPos >= delPos - 1){
+            if (curPos >= delPos) { // empty entry
                 return false;
             }
             num = str.substr(curPos, delPos - curPos);
@@ -177,6 +180,7 @@ namespace  FSQP_LOG_PARSER {
             }
             pos = nlPos;
         }
+        return 0;
     }
     std::size_t getPosition(const std::string& buffer, const std::string& pattern, std::size_t pBg, std::size_t pEnd) 
     {
@@ -206,12 +210,11 @@ namespace  FSQP_LOG_PARSER {
         fid.close();
         return buffer;
     }
-    bool ReadIteration(const std::string& fileName, unsigned int iteration, IterationData& input)
-    {   
+    bool ParseIterationBlock(const std::string& buffer, IterationData& input)
+    {
+        // buffer starts at the line break after "ITERATION: k" and ends before the next block
         const std::string shiftFromPrevLine = "\n  ";
         const std::string sD0 = shiftFromPrevLine + "d0:";
-        const std::string sLowerBounds = shiftFromPrevLine + "lowerBounds:";
-        const std::string sUpperBounds = shiftFromPrevLine + "upperBounds:";
         const std::string sCVectorD0 = shiftFromPrevLine + "m_cVectorForD0:";
         const std::string sBVectorD0 = shiftFromPrevLine + "m_bVectorForD0:";
         const std::string sJacobianD0 = shiftFromPrevLine + "jacobian for d0:";
@@ -223,27 +226,8 @@ namespace  FSQP_LOG_PARSER {
         const std::string sUpperBoundsDTil = shiftFromPrevLine + "upper bounds dTil:";
         const std::string sX = shiftFromPrevLine + "x:";
 
-        const std::string buffer = readIntoString(fileName);
-        std::size_t lbPos = buffer.find(sLowerBounds);
-        if (lbPos == std::string::npos) {
-            return false;
-        }
-        lbPos = lbPos + sLowerBounds.size();
-        std::size_t ubPos = buffer.find(sUpperBounds);
-        if (ubPos == std::string::npos) {
-            return false;
-        }
-        ubPos = ubPos + sUpperBounds.size();
-        readVector(lbPos, buffer, input.m_lower);
-        readVector(ubPos, buffer, input.m_upper);
-        std::size_t pBg = getIterationBlockPosition(iteration, buffer);
-        if (pBg == 0) {
-            return false;
-        }
-        std::size_t pEnd = getIterationBlockPosition(iteration + 1, buffer);
-        if (pEnd == 0) {
-            pEnd = buffer.size();
-        }
+        const std::size_t pBg = 0;
+        const std::size_t pEnd = buffer.size();
         std::size_t pos = getPosition(buffer, sX, pBg, pEnd);
         if (pos == 0) {
             return false;
@@ -318,6 +302,166 @@ namespace  FSQP_LOG_PARSER {
 
 
 
+    namespace {
+    const char iterationTag[] = "ITERATION:";
+    const std::size_t iterationTagSize = sizeof(iterationTag) - 1;
+
+    std::size_t FindTag(const char* data, std::size_t size, const char* tag, std::size_t tagSize, std::size_t pos)
+    {
+        if (pos >= size) {
+            return std::string::npos;
+        }
+        const std::string_view view(data, size);
+        return view.find(std::string_view(tag, tagSize), pos);
+    }
+    }
+
+    bool IterationLog::Open(const std::string& fileName)
+    {
+        Close();
+        if (!file.Open(fileName)) {
+            errMsg = "failed to open " + fileName;
+            return false;
+        }
+        // single pass over block headers, blocks are parsed on demand
+        const char* data = file.Data();
+        const std::size_t size = file.Size();
+        std::size_t pos = FindTag(data, size, iterationTag, iterationTagSize, 0);
+        const std::size_t headerEnd = pos == std::string::npos ? size : pos;
+        while (pos != std::string::npos) {
+            const char* numBg = data + pos + iterationTagSize;
+            const char* lineEnd = static_cast<const char*>(std::memchr(numBg, '\n', size - (numBg - data)));
+            if (lineEnd == nullptr) {
+                lineEnd = data + size;
+            }
+            while (numBg < lineEnd && (*numBg == ' ' || *numBg == '\t')) {
+                ++numBg;
+            }
+            unsigned int iteration = 0;
+            const auto [ptr, ec] = std::from_chars(numBg, lineEnd, iteration);
+            if (ec != std::errc() || ptr == numBg) {
+                Close();
+                errMsg = "bad iteration header at offset " + std::to_string(pos);
+                return false;
+            }
+            if (!blocks.empty()) {
+                blocks.back().size = pos - blocks.back().offset;
+            }
+            const std::size_t offset = static_cast<std::size_t>(lineEnd - data);
+            blocks.push_back({iteration, offset, size - offset});
+            pos = FindTag(data, size, iterationTag, iterationTagSize, offset);
+        }
+        // problem bounds are printed once before the first iteration
+        if (!ReadHeaderVector("\n  lowerBounds:", headerEnd, lower) ||
+            !ReadHeaderVector("\n  upperBounds:", headerEnd, upper)) {
+            Close();
+            errMsg = "bounds of the problem are missing";
+            return false;
+        }
+        return true;
+    }
+
+    void IterationLog::Close()
+    {
+        file.Close();
+        blocks.clear();
+        lower.clear();
+        upper.clear();
+        cursor = 0;
+        lastIteration = 0;
+        errMsg.clear();
+    }
+
+    bool IterationLog::ReadHeaderVector(const std::string& tag, std::size_t headerEnd, std::vector<double>& v) const
+    {
+        std::size_t pos = FindTag(file.Data(), headerEnd, tag.data(), tag.size(), 0);
+        if (pos == std::string::npos) {
+            pos = FindTag(file.Data(), file.Size(), tag.data(), tag.size(), 0);
+        }
+        if (pos == std::string::npos) {
+            return false;
+        }
+        pos += tag.size();
+        const std::size_t end = FindTag(file.Data(), file.Size(), "]", 1, pos);
+        if (end == std::string::npos) {
+            return false;
+        }
+        return readVector(0, std::string(file.Data() + pos, end + 1 - pos), v);
+    }
+
+    bool IterationLog::Find(unsigned int iteration, std::size_t& index) const
+    {
+        // first block with the number, as getIterationBlockPosition
+        for (std::size_t i = 0; i < blocks.size(); ++i) {
+            if (blocks[i].iteration == iteration) {
+                index = i;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool IterationLog::Read(std::size_t index, IterationData& data) const
+    {
+        if (index >= blocks.size()) {
+            return false;
+        }
+        const IterationBlock& block = blocks[index];
+        data.m_lower = lower;
+        data.m_upper = upper;
+        return ParseIterationBlock(std::string(file.Data() + block.offset, block.size), data);
+    }
+
+    bool IterationLog::ReadIteration(unsigned int iteration, IterationData& data) const
+    {
+        std::size_t index = 0;
+        return Find(iteration, index) && Read(index, data);
+    }
+
+    IterationLog::Record IterationLog::Next(IterationData& data)
+    {
+        if (cursor >= blocks.size()) {
+            return Record::END;
+        }
+        lastIteration = blocks[cursor].iteration;
+        return Read(cursor++, data) ? Record::ITERATION : Record::CORRUPTED;
+    }
+
+    bool ReadIteration(const std::string& fileName, unsigned int iteration, IterationData& input)
+    {
+        IterationLog log;
+        return log.Open(fileName) && log.ReadIteration(iteration, input);
+    }
+
+    bool IterationToProblem(const IterationData& data, QP_NNLS::DenseQPProblem& problem)
+    {
+        // hessian for d0 has extra row / column of the auxiliary variable, same as in solveQP
+        const std::size_t nX = data.m_x.size();
+        if (data.m_hessianD0.size() < nX || data.m_cVectorD0.size() != nX ||
+            data.m_jacobianD0.size() != data.m_bVectorD0.size() ||
+            data.m_lowerD0.size() < nX || data.m_upperD0.size() < nX) {
+            return false;
+        }
+        problem.H.resize(nX);
+        for (std::size_t i = 0; i < nX; ++i) {
+            if (data.m_hessianD0[i].size() < nX) {
+                return false;
+            }
+            problem.H[i].assign(data.m_hessianD0[i].begin(), data.m_hessianD0[i].begin() + nX);
+        }
+        for (const auto& row : data.m_jacobianD0) {
+            if (row.size() != nX) {
+                return false;
+            }
+        }
+        problem.A = data.m_jacobianD0;
+        problem.b = data.m_bVectorD0;
+        problem.c = data.m_cVectorD0;
+        problem.lw.assign(data.m_lowerD0.begin(), data.m_lowerD0.begin() + nX);
+        problem.up.assign(data.m_upperD0.begin(), data.m_upperD0.begin() + nX);
+        problem.nEqConstraints = 0;
+        return true;
+    }
     bool QPOutputReader(const std::string& fileName, unsigned int iteration, FSQP_QP_PROBLEM_TYPE type, QPProblemOutput& output)
     {
         return true;
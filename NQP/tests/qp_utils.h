@@ -2,6 +2,8 @@
 #define  NNLS_TESTS_QP_UTILS_H
 #include <vector>
 #include <string>
+#include "types.h"
+#include "mapped_file.h"
 
 namespace FSQP_LOG_PARSER {
 using matrix_t = std::vector<std::vector<double>>;
@@ -49,7 +51,46 @@ bool findVector(std::size_t pos, const std::string& str, std::size_t& bg, std::s
 bool readVector(std::size_t pos, const std::string& str, std::vector<double>& output);
 bool readMatrixRow(std::size_t pos, const std::string& str, std::vector<double>& output, std::size_t& pEnd, int& rowIndex);
 bool readMatrix(std::size_t pos, const std::string& str, int nRows, matrix_t& output, std::size_t& posEnd);
+bool ParseIterationBlock(const std::string& buffer, IterationData& input); // without problem bounds
 bool ReadIteration(const std::string& logfileName, unsigned int iteration, IterationData& input);
+bool IterationToProblem(const IterationData& data, QP_NNLS::DenseQPProblem& problem); // d0 subproblem of iteration
+struct IterationBlock {
+    unsigned int iteration;
+    std::size_t offset; // line break after "ITERATION: k"
+    std::size_t size;   // up to the next block header or end of file
+};
+class IterationLog {
+    // indexes all ITERATION: blocks of the log in one pass over the mapped file,
+    // only the requested block is copied and parsed
+public:
+    enum class Record {
+        ITERATION = 0,
+        END,
+        CORRUPTED
+    };
+    IterationLog() = default;
+    ~IterationLog() = default;
+    bool Open(const std::string& fileName);
+    void Close();
+    const std::string& GetError() const { return errMsg; }
+    const std::vector<IterationBlock>& GetBlocks() const { return blocks; }
+    bool Find(unsigned int iteration, std::size_t& index) const;
+    bool Read(std::size_t index, IterationData& data) const; // index of block, not iteration number
+    bool ReadIteration(unsigned int iteration, IterationData& data) const;
+    // streaming in file order
+    Record Next(IterationData& data);
+    unsigned int GetIteration() const { return lastIteration; } // of the last Next
+    void Rewind() { cursor = 0; }
+private:
+    bool ReadHeaderVector(const std::string& tag, std::size_t headerEnd, std::vector<double>& v) const;
+    TXT_QP_PARSER::MappedFile file;
+    std::vector<IterationBlock> blocks;
+    std::vector<double> lower;
+    std::vector<double> upper;
+    std::size_t cursor = 0;
+    unsigned int lastIteration = 0;
+    std::string errMsg;
+};
 bool QPOutputReader(const std::string& fileName, unsigned int iteration, FSQP_QP_PROBLEM_TYPE type, QPProblemOutput& output);
 }
 #endif
\ No newline at end of file
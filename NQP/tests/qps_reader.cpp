@@ -0,0 +1,477 @@
+#include "qps_reader.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include "mapped_file.h"
+namespace QPS_PARSER {
+using namespace QP_NNLS;
+namespace {
+constexpr long long objectiveRowIndex = -1;
+constexpr long long freeRowIndex = -2; // N rows after the objective are ignored
+
+double Clamp(double value) {
+    return value >= infinity ? infinity : (value <= -infinity ? -infinity : value);
+}
+
+std::string_view Trim(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) {
+        s.remove_prefix(1);
+    }
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t' || s.back() == '\r')) {
+        s.remove_suffix(1);
+    }
+    return s;
+}
+}
+
+bool IsQpsExtension(const std::string& extension) {
+    std::string ext = extension;
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char ch) { return std::tolower(ch); });
+    return ext == ".qps" || ext == ".sif" || ext == ".mps";
+}
+
+bool QpsReader::Read(const std::string& filePath, SparseQPProblem& problem, QpsFormat format) {
+    TXT_QP_PARSER::MappedFile file;
+    if (!file.Open(filePath)) {
+        errMsg = "failed to open " + filePath;
+        return false;
+    }
+    return ReadString(std::string_view(file.Data(), file.Size()), problem, format);
+}
+
+bool QpsReader::ReadString(std::string_view text, SparseQPProblem& problem, QpsFormat format) {
+    this->problem = &problem;
+    this->format = format;
+    problem = SparseQPProblem();
+    section = Section::NONE;
+    rowIndex.clear();
+    colIndex.clear();
+    objectiveRow.clear();
+    rowTypes.clear();
+    rhs.clear();
+    ranges.clear();
+    hasRange.clear();
+    aTriplets.clear();
+    lineNumber = 0;
+    errMsg.clear();
+    std::size_t pos = 0;
+    while (pos < text.size() && section != Section::END) {
+        std::size_t eol = text.find('\n', pos);
+        if (eol == std::string_view::npos) {
+            eol = text.size();
+        }
+        ++lineNumber;
+        if (!ParseLine(text.substr(pos, eol - pos))) {
+            return false;
+        }
+        pos = eol + 1;
+    }
+    return Finish();
+}
+
+bool QpsReader::Fail(const std::string& msg) {
+    errMsg = "line " + std::to_string(lineNumber) + ": " + msg;
+    return false;
+}
+
+bool QpsReader::ParseLine(std::string_view line) {
+    if (!line.empty() && line.back() == '\r') {
+        line.remove_suffix(1);
+    }
+    if (Trim(line).empty() || line.front() == '*') {
+        return true;
+    }
+    if (line.front() != ' ' && line.front() != '\t') {
+        // section header
+        const std::size_t keyEnd = std::min(line.find_first_of(" \t"), line.size());
+        const std::string_view key = line.substr(0, keyEnd);
+        if (key == "NAME") {
+            problem->name = std::string(Trim(line.substr(keyEnd)));
+            section = Section::NONE;
+        } else if (key == "ROWS") {
+            section = Section::ROWS;
+        } else if (key == "COLUMNS") {
+            section = Section::COLUMNS;
+        } else if (key == "RHS") {
+            section = Section::RHS;
+        } else if (key == "RANGES") {
+            section = Section::RANGES;
+        } else if (key == "BOUNDS") {
+            section = Section::BOUNDS;
+        } else if (key == "QUADOBJ") {
+            section = Section::QUADOBJ;
+        } else if (key == "QMATRIX" || key == "QSECTION") {
+            section = Section::QMATRIX;
+        } else if (key == "ENDATA") {
+            section = Section::END;
+        } else if (key == "OBJSENSE") {
+            const std::string_view sense = Trim(line.substr(keyEnd));
+            if (!sense.empty() && sense != "MIN" && sense != "MINIMIZE") {
+                return Fail("maximization is not supported");
+            }
+            section = Section::NONE;
+        } else {
+            return Fail("unknown section " + std::string(key));
+        }
+        return true;
+    }
+    if (!Tokenize(line)) {
+        return false;
+    }
+    switch (section) {
+    case Section::ROWS: return ReadRow();
+    case Section::COLUMNS: return ReadColumn();
+    case Section::RHS: return ReadRhs();
+    case Section::RANGES: return ReadRange();
+    case Section::BOUNDS: return ReadBound();
+    case Section::QUADOBJ: return ReadQuadratic(true);
+    case Section::QMATRIX: return ReadQuadratic(false);
+    case Section::NONE:
+        // OBJSENSE value on its own line
+        if (tokens.size() == 1 && (tokens[0] == "MIN" || tokens[0] == "MINIMIZE")) {
+            return true;
+        }
+        return Fail("data outside of section");
+    default: return true;
+    }
+}
+
+bool QpsReader::Tokenize(std::string_view line) {
+    tokens.clear();
+    if (format == QpsFormat::FIXED) {
+        constexpr std::size_t fields[6][2] = {{1, 3}, {4, 12}, {14, 22}, {24, 36}, {39, 47}, {49, 61}};
+        for (const auto& field : fields) {
+            if (field[0] >= line.size()) {
+                break;
+            }
+            const std::string_view token = Trim(line.substr(field[0], field[1] - field[0]));
+            if (!token.empty()) {
+                tokens.push_back(token);
+            }
+        }
+        return true;
+    }
+    std::size_t pos = 0;
+    while (pos < line.size()) {
+        const std::size_t bg = line.find_first_not_of(" \t", pos);
+        if (bg == std::string_view::npos) {
+            break;
+        }
+        const std::size_t end = std::min(line.find_first_of(" \t", bg), line.size());
+        tokens.push_back(line.substr(bg, end - bg));
+        pos = end;
+    }
+    return true;
+}
+
+bool QpsReader::ToNumber(std::string_view token, double& value) {
+    if (!token.empty() && token.front() == '+') {
+        token.remove_prefix(1);
+    }
+    const auto [ptr, ec] = std::from_chars(token.data(), token.data() + token.size(), value);
+    if ((ec != std::errc() && ec != std::errc::result_out_of_range) || ptr != token.data() + token.size()) {
+        return Fail("bad number " + std::string(token));
+    }
+    value = Clamp(value);
+    return true;
+}
+
+bool QpsReader::FindRow(std::string_view name, long long& row) {
+    const auto it = rowIndex.find(std::string(name));
+    if (it == rowIndex.end()) {
+        return Fail("unknown row " + std::string(name));
+    }
+    row = it->second;
+    return true;
+}
+
+bool QpsReader::FindColumn(std::string_view name, unsg_t& col) {
+    const auto it = colIndex.find(std::string(name));
+    if (it == colIndex.end()) {
+        return Fail("unknown column " + std::string(name));
+    }
+    col = it->second;
+    return true;
+}
+
+bool QpsReader::ReadRow() {
+    if (tokens.size() != 2) {
+        return Fail("row definition expects type and name");
+    }
+    const char type = static_cast<char>(std::toupper(static_cast<unsigned char>(tokens[0].front())));
+    const std::string name(tokens[1]);
+    if (rowIndex.count(name) != 0) {
+        return Fail("duplicate row " + name);
+    }
+    if (type == 'N') {
+        if (objectiveRow.empty()) {
+            objectiveRow = name;
+            rowIndex[name] = objectiveRowIndex;
+        } else {
+            rowIndex[name] = freeRowIndex;
+        }
+    } else if (type == 'L' || type == 'G' || type == 'E') {
+        rowIndex[name] = static_cast<long long>(problem->rowNames.size());
+        problem->rowNames.push_back(name);
+        rowTypes.push_back(type);
+    } else {
+        return Fail("unknown row type " + std::string(tokens[0]));
+    }
+    return true;
+}
+
+bool QpsReader::ReadColumn() {
+    if (tokens.size() >= 2 && tokens[1] == "'MARKER'") {
+        return true; // integrality markers
+    }
+    if (tokens.size() != 3 && tokens.size() != 5) {
+        return Fail("column entry expects name and one or two row / value pairs");
+    }
+    const std::string name(tokens[0]);
+    auto it = colIndex.find(name);
+    if (it == colIndex.end()) {
+        it = colIndex.emplace(name, static_cast<unsg_t>(problem->colNames.size())).first;
+        problem->colNames.push_back(name);
+        problem->c.push_back(0.0);
+        problem->lw.push_back(0.0);
+        problem->up.push_back(infinity);
+    }
+    const unsg_t col = it->second;
+    for (std::size_t k = 1; k + 1 < tokens.size(); k += 2) {
+        long long row = 0;
+        double value = 0.0;
+        if (!FindRow(tokens[k], row) || !ToNumber(tokens[k + 1], value)) {
+            return false;
+        }
+        if (row == objectiveRowIndex) {
+            problem->c[col] += value;
+        } else if (row >= 0 && value != 0.0) {
+            aTriplets.push_back({static_cast<unsg_t>(row), col, value});
+        }
+    }
+    return true;
+}
+
+bool QpsReader::ReadRhs() {
+    // set name is optional: odd number of fields means it is present
+    const std::size_t first = tokens.size() % 2;
+    if (tokens.size() < 2 || tokens.size() > 5) {
+        return Fail("rhs entry expects one or two row / value pairs");
+    }
+    rhs.resize(problem->rowNames.size(), 0.0);
+    for (std::size_t k = first; k + 1 < tokens.size(); k += 2) {
+        long long row = 0;
+        double value = 0.0;
+        if (!FindRow(tokens[k], row) || !ToNumber(tokens[k + 1], value)) {
+            return false;
+        }
+        if (row == objectiveRowIndex) {
+            problem->objConstant = -value;
+        } else if (row >= 0) {
+            rhs[row] = value;
+        }
+    }
+    return true;
+}
+
+bool QpsReader::ReadRange() {
+    const std::size_t first = tokens.size() % 2;
+    if (tokens.size() < 2 || tokens.size() > 5) {
+        return Fail("range entry expects one or two row / value pairs");
+    }
+    ranges.resize(problem->rowNames.size(), 0.0);
+    hasRange.resize(problem->rowNames.size(), 0);
+    for (std::size_t k = first; k + 1 < tokens.size(); k += 2) {
+        long long row = 0;
+        double value = 0.0;
+        if (!FindRow(tokens[k], row) || !ToNumber(tokens[k + 1], value)) {
+            return false;
+        }
+        if (row >= 0) {
+            ranges[row] = value;
+            hasRange[row] = 1;
+        }
+    }
+    return true;
+}
+
+bool QpsReader::ReadBound() {
+    if (tokens.size() < 2) {
+        return Fail("bound entry expects type and column");
+    }
+    std::string type(tokens[0]);
+    std::transform(type.begin(), type.end(), type.begin(), [](unsigned char ch) { return std::toupper(ch); });
+    const bool hasValue = type == "UP" || type == "LO" || type == "FX" || type == "LI" || type == "UI" || type == "SC";
+    // [type, set, column, value] with optional set name
+    std::size_t colPos = 0;
+    if (hasValue) {
+        if (tokens.size() != 3 && tokens.size() != 4) {
+            return Fail("bound " + type + " expects a value");
+        }
+        colPos = tokens.size() - 2;
+    } else {
+        if (tokens.size() < 2 || tokens.size() > 4) {
+            return Fail("bad bound entry");
+        }
+        colPos = tokens.size() == 4 ? 2 : tokens.size() - 1;
+    }
+    unsg_t col = 0;
+    if (!FindColumn(tokens[colPos], col)) {
+        return false;
+    }
+    double value = 0.0;
+    if (hasValue && !ToNumber(tokens[colPos + 1], value)) {
+        return false;
+    }
+    double& lw = problem->lw[col];
+    double& up = problem->up[col];
+    if (type == "UP" || type == "UI" || type == "SC") {
+        up = value;
+        if (value < 0.0 && lw == 0.0) {
+            lw = -infinity; // MPS convention for negative upper bound
+        }
+    } else if (type == "LO" || type == "LI") {
+        lw = value;
+    } else if (type == "FX") {
+        lw = value;
+        up = value;
+    } else if (type == "FR") {
+        lw = -infinity;
+        up = infinity;
+    } else if (type == "MI") {
+        lw = -infinity;
+    } else if (type == "PL") {
+        up = infinity;
+    } else if (type == "BV") {
+        lw = 0.0;
+        up = 1.0;
+    } else {
+        return Fail("unknown bound type " + type);
+    }
+    return true;
+}
+
+bool QpsReader::ReadQuadratic(bool lowerOnly) {
+    if (tokens.size() != 3) {
+        return Fail("quadratic entry expects two columns and value");
+    }
+    unsg_t i = 0;
+    unsg_t j = 0;
+    double value = 0.0;
+    if (!FindColumn(tokens[0], i) || !FindColumn(tokens[1], j) || !ToNumber(tokens[2], value)) {
+        return false;
+    }
+    if (!lowerOnly && i < j) {
+        return true; // full matrix lists both triangles
+    }
+    problem->hRows.push_back(std::max(i, j));
+    problem->hCols.push_back(std::min(i, j));
+    problem->hValues.push_back(value);
+    return true;
+}
+
+bool QpsReader::Finish() {
+    if (section != Section::END) {
+        return Fail("ENDATA is missing");
+    }
+    if (objectiveRow.empty()) {
+        return Fail("objective row is missing");
+    }
+    const std::size_t nRows = problem->rowNames.size();
+    rhs.resize(nRows, 0.0);
+    ranges.resize(nRows, 0.0);
+    hasRange.resize(nRows, 0);
+    problem->rowLw.resize(nRows);
+    problem->rowUp.resize(nRows);
+    for (std::size_t i = 0; i < nRows; ++i) {
+        double& lw = problem->rowLw[i];
+        double& up = problem->rowUp[i];
+        const double r = std::fabs(ranges[i]);
+        if (rowTypes[i] == 'L') {
+            lw = hasRange[i] ? rhs[i] - r : -infinity;
+            up = rhs[i];
+        } else if (rowTypes[i] == 'G') {
+            lw = rhs[i];
+            up = hasRange[i] ? rhs[i] + r : infinity;
+        } else {
+            lw = hasRange[i] && ranges[i] < 0.0 ? rhs[i] - r : rhs[i];
+            up = hasRange[i] && ranges[i] > 0.0 ? rhs[i] + r : rhs[i];
+        }
+        lw = Clamp(lw);
+        up = Clamp(up);
+    }
+    // COLUMNS is column major, counting sort keeps column order inside rows
+    problem->aRowPtr.assign(nRows + 1, 0);
+    for (const auto& t : aTriplets) {
+        ++problem->aRowPtr[t.row + 1];
+    }
+    for (std::size_t i = 0; i < nRows; ++i) {
+        problem->aRowPtr[i + 1] += problem->aRowPtr[i];
+    }
+    problem->aColIndices.resize(aTriplets.size());
+    problem->aValues.resize(aTriplets.size());
+    std::vector<std::size_t> next(problem->aRowPtr.begin(), problem->aRowPtr.end() - 1);
+    for (const auto& t : aTriplets) {
+        const std::size_t k = next[t.row]++;
+        problem->aColIndices[k] = t.col;
+        problem->aValues[k] = t.value;
+    }
+    aTriplets.clear();
+    aTriplets.shrink_to_fit();
+    return true;
+}
+
+void ToDense(const SparseQPProblem& sparse, DenseQPProblem& problem, bool ranged) {
+    const std::size_t n = sparse.NVariables();
+    problem.H.assign(n, std::vector<double>(n, 0.0));
+    for (std::size_t k = 0; k < sparse.hValues.size(); ++k) {
+        const unsg_t i = sparse.hRows[k];
+        const unsg_t j = sparse.hCols[k];
+        problem.H[i][j] += sparse.hValues[k];
+        if (i != j) {
+            problem.H[j][i] += sparse.hValues[k];
+        }
+    }
+    problem.c = sparse.c;
+    problem.lw = sparse.lw;
+    problem.up = sparse.up;
+    problem.A.clear();
+    problem.b.clear();
+    problem.bLw.clear();
+    const auto addRow = [&](std::size_t i, double sign, double rhs) {
+        problem.A.emplace_back(n, 0.0);
+        for (std::size_t k = sparse.aRowPtr[i]; k < sparse.aRowPtr[i + 1]; ++k) {
+            problem.A.back()[sparse.aColIndices[k]] += sign * sparse.aValues[k];
+        }
+        problem.b.push_back(sign * rhs);
+        if (ranged) {
+            problem.bLw.push_back(-infinity);
+        }
+    };
+    unsg_t nEq = 0;
+    for (std::size_t i = 0; i < sparse.NConstraints(); ++i) {
+        if (sparse.IsEquality(i)) {
+            addRow(i, 1.0, sparse.rowUp[i]);
+            ++nEq;
+        }
+    }
+    for (std::size_t i = 0; i < sparse.NConstraints(); ++i) {
+        if (sparse.IsEquality(i)) {
+            continue;
+        }
+        if (ranged && sparse.rowUp[i] < infinity && sparse.rowLw[i] > -infinity) {
+            addRow(i, 1.0, sparse.rowUp[i]);
+            problem.bLw.back() = sparse.rowLw[i];
+            continue;
+        }
+        if (sparse.rowUp[i] < infinity) {
+            addRow(i, 1.0, sparse.rowUp[i]);
+        }
+        if (sparse.rowLw[i] > -infinity) {
+            addRow(i, -1.0, sparse.rowLw[i]);
+        }
+    }
+    problem.nEqConstraints = nEq;
+}
+}
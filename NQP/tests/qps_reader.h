@@ -0,0 +1,99 @@
+#ifndef NNLS_TESTS_QPS_READER_H
+#define NNLS_TESTS_QPS_READER_H
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "types.h"
+namespace QPS_PARSER {
+constexpr double infinity = 1.0e20; // |values| >= infinity are unbounded, as in txt problems
+
+enum class QpsFormat {
+    FREE = 0, // white space separated fields, names without spaces
+    FIXED     // fields at MPS columns 2-3, 5-12, 15-22, 25-36, 40-47, 50-61
+};
+
+struct SparseQPProblem {
+    // min 1/2 x_T * H * x + c_T * x + objConstant, rowLw <= A * x <= rowUp, lw <= x <= up
+    std::string name;
+    std::vector<std::string> colNames;
+    std::vector<std::string> rowNames;
+    std::vector<std::size_t> aRowPtr;      // CSR, rows in file order
+    std::vector<QP_NNLS::unsg_t> aColIndices;
+    std::vector<double> aValues;
+    std::vector<QP_NNLS::unsg_t> hRows;    // lower triangle including diagonal, coordinate form
+    std::vector<QP_NNLS::unsg_t> hCols;
+    std::vector<double> hValues;
+    std::vector<double> c;
+    double objConstant = 0.0;
+    std::vector<double> rowLw;
+    std::vector<double> rowUp;
+    std::vector<double> lw;
+    std::vector<double> up;
+    std::size_t NVariables() const { return colNames.size(); }
+    std::size_t NConstraints() const { return rowNames.size(); }
+    bool IsEquality(std::size_t row) const { return rowLw[row] == rowUp[row]; }
+};
+
+class QpsReader {
+    // single pass over memory mapped file, storage is proportional to the number of nonzeros
+public:
+    QpsReader() = default;
+    ~QpsReader() = default;
+    bool Read(const std::string& filePath, SparseQPProblem& problem, QpsFormat format = QpsFormat::FREE);
+    bool ReadString(std::string_view text, SparseQPProblem& problem, QpsFormat format = QpsFormat::FREE);
+    const std::string& GetError() const { return errMsg; }
+private:
+    enum class Section {
+        NONE = 0,
+        ROWS,
+        COLUMNS,
+        RHS,
+        RANGES,
+        BOUNDS,
+        QUADOBJ,  // lower triangle
+        QMATRIX,  // full matrix
+        END
+    };
+    struct Triplet {
+        QP_NNLS::unsg_t row;
+        QP_NNLS::unsg_t col;
+        double value;
+    };
+    bool Fail(const std::string& msg);
+    bool ParseLine(std::string_view line);
+    bool Tokenize(std::string_view line);
+    bool ReadRow();
+    bool ReadColumn();
+    bool ReadRhs();
+    bool ReadRange();
+    bool ReadBound();
+    bool ReadQuadratic(bool lowerOnly);
+    bool Finish();
+    bool ToNumber(std::string_view token, double& value);
+    bool FindRow(std::string_view name, long long& row); // -1 for objective row
+    bool FindColumn(std::string_view name, QP_NNLS::unsg_t& col);
+    SparseQPProblem* problem = nullptr;
+    QpsFormat format = QpsFormat::FREE;
+    Section section = Section::NONE;
+    std::vector<std::string_view> tokens;
+    std::unordered_map<std::string, long long> rowIndex;
+    std::unordered_map<std::string, QP_NNLS::unsg_t> colIndex;
+    std::string objectiveRow;
+    std::vector<char> rowTypes;
+    std::vector<double> rhs;
+    std::vector<double> ranges;
+    std::vector<char> hasRange;
+    std::vector<Triplet> aTriplets;
+    std::size_t lineNumber = 0;
+    std::string errMsg;
+};
+
+bool IsQpsExtension(const std::string& extension); // .qps, .sif, .mps in any case
+
+// equalities first, then A_i * x <= up_i and -A_i * x <= -lw_i for finite row bounds,
+// same layout as DENSE_PROBLEM_FORMAT::RIGHT of the txt problems;
+// ranged: rows with both bounds finite are kept once as lw_i <= A_i * x <= up_i in bLw, b
+void ToDense(const SparseQPProblem& sparse, QP_NNLS::DenseQPProblem& problem, bool ranged = false);
+}
+#endif // NNLS_TESTS_QPS_READER_H
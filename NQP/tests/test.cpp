@@ -4,8 +4,23 @@
 #include "TxtParser.h"
 #include "decorators.h"
 #include <algorithm>
+#include <array>
+#include <numeric>
 #include <string>
+#include <filesystem>
+#include <functional>
+#include <limits>
+#include <fstream>
 #include "data_writer.h"
+#include "asyncCallback.h"
+#include "binaryTrace.h"
+#include "profiler.h"
+#include "qp_generator.h"
+#include "binary_problem.h"
+#include "qps_reader.h"
+#include "mpc.h"
+#include "fixedCore.h"
+#include "generated_mpc.h"
 using namespace QP_NNLS;
 using namespace QP_NNLS_TEST_DATA;
 using namespace TXT_QP_PARSER;
@@ -47,6 +62,1318 @@ TEST(DataWriter, Test3) {
     fw.Write(s, x);
     fw.NewLine();
 }
+TEST(AsyncCallback, SpscRingDropsWhenFull) {
+    SpscRing<int> ring(3);
+    ASSERT_EQ(ring.Capacity(), 4);
+    for (int i = 0; i < 4; ++i) {
+        int* slot = ring.BeginPush();
+        ASSERT_NE(slot, nullptr);
+        *slot = i;
+        ring.EndPush();
+    }
+    EXPECT_EQ(ring.BeginPush(), nullptr);
+    for (int i = 0; i < 4; ++i) {
+        int* front = ring.Front();
+        ASSERT_NE(front, nullptr);
+        EXPECT_EQ(*front, i);
+        ring.Pop();
+    }
+    EXPECT_EQ(ring.Front(), nullptr);
+    EXPECT_TRUE(ring.Empty());
+}
+TEST(AsyncCallback, SameLogAsCallback1) {
+    ProblemReader pr;
+    pr.Init(case_3.H, case_3.c, case_3.A, case_3.b);
+    const std::string syncLog = "asyncCallbackSync.txt";
+    const std::string asyncLog = "asyncCallbackAsync.txt";
+    {
+        QPNNLSDense solver;
+        solver.SetCallback(std::make_unique<Callback1>(syncLog));
+        solver.Init(NqpTestSettingsDefault);
+        ASSERT_TRUE(solver.SetProblem(pr.getProblem()));
+        solver.Solve();
+    }
+    {
+        QPNNLSDense solver;
+        auto callback = std::make_unique<AsyncCallback>(asyncLog);
+        AsyncCallback* asyncCallback = callback.get();
+        solver.SetCallback(std::move(callback));
+        solver.Init(NqpTestSettingsDefault);
+        ASSERT_TRUE(solver.SetProblem(pr.getProblem()));
+        solver.Solve();
+        asyncCallback->Flush();
+        EXPECT_EQ(asyncCallback->GetDropped(), 0);
+    }
+    // logs differ only in the timing lines of the initialization stage
+    auto readNoTime = [](const std::string& file) {
+        std::ifstream fid(file);
+        std::string line, content;
+        while (std::getline(fid, line)) {
+            if (line.find(" t ") != 0) {
+                content += line + "\n";
+            }
+        }
+        return content;
+    };
+    const std::string syncContent = readNoTime(syncLog);
+    EXPECT_FALSE(syncContent.empty());
+    EXPECT_EQ(syncContent, readNoTime(asyncLog));
+}
+TEST(AsyncCallback, DropsIterationsWhenWriterIsSlow) {
+    class SlowWriter : public ITraceWriter {
+    public:
+        void WriteInit(const InitializationData& /*data*/) override {}
+        void WriteIteration(const TraceSnapshot& /*data*/) override {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        void WriteFinal(const FinalData& /*data*/, unsg_t nDropped) override {
+            dropped = nDropped;
+        }
+        unsg_t& dropped;
+        SlowWriter(unsg_t& dropped): dropped(dropped) {}
+    };
+    unsg_t droppedInFinal = 0;
+    const std::size_t capacity = 1;
+    AsyncCallback callback(std::make_unique<SlowWriter>(droppedInFinal), capacity);
+    std::set<unsg_t> activeSet = {0, 1};
+    std::deque<unsg_t> history = {0, 1};
+    std::vector<double> v(10, 1.0);
+    callback.iterData.activeSet = &activeSet;
+    callback.iterData.activeSetHistory = &history;
+    callback.iterData.zp = &v;
+    callback.iterData.primal = &v;
+    callback.iterData.dual = &v;
+    callback.iterData.violations = &v;
+    callback.ProcessData(1);
+    const unsg_t nIterations = 50;
+    for (unsg_t i = 0; i < nIterations; ++i) {
+        callback.iterData.iteration = i;
+        callback.ProcessData(2);
+    }
+    callback.ProcessData(3);
+    callback.Flush();
+    EXPECT_GT(callback.GetDropped(), 0);
+    EXPECT_LT(callback.GetDropped(), nIterations);
+    EXPECT_EQ(droppedInFinal, callback.GetDropped());
+}
+TEST(BinaryTrace, DecodedLogSameAsCallback1) {
+    ProblemReader pr;
+    pr.Init(case_3.H, case_3.c, case_3.A, case_3.b);
+    const std::string textLog = "binaryTraceText.txt";
+    const std::string binaryTrace = "binaryTrace.bin";
+    const std::string compactTrace = "binaryTraceCompact.bin";
+    const std::string decodedLog = "binaryTraceDecoded.txt";
+    const std::string csvLog = "binaryTraceDecoded.csv";
+    auto solve = [&pr](std::unique_ptr<Callback> callback) {
+        QPNNLSDense solver;
+        solver.SetCallback(std::move(callback));
+        solver.Init(NqpTestSettingsDefault);
+        ASSERT_TRUE(solver.SetProblem(pr.getProblem()));
+        solver.Solve();
+    };
+    solve(std::make_unique<Callback1>(textLog));
+    solve(std::make_unique<Callback1>(std::make_unique<BinaryTraceWriter>(binaryTrace, true)));
+    solve(std::make_unique<Callback1>(std::make_unique<BinaryTraceWriter>(compactTrace)));
+    {
+        TextTraceWriter writer(decodedLog);
+        ASSERT_TRUE(DecodeTrace(binaryTrace, writer));
+    }
+    {
+        CsvTraceWriter writer(csvLog);
+        ASSERT_TRUE(DecodeTrace(compactTrace, writer));
+    }
+    auto readNoTime = [](const std::string& file) {
+        std::ifstream fid(file);
+        std::string line, content;
+        while (std::getline(fid, line)) {
+            if (line.find(" t ") != 0) {
+                content += line + "\n";
+            }
+        }
+        return content;
+    };
+    const std::string textContent = readNoTime(textLog);
+    EXPECT_FALSE(textContent.empty());
+    EXPECT_EQ(textContent, readNoTime(decodedLog));
+    EXPECT_LT(std::filesystem::file_size(binaryTrace), std::filesystem::file_size(textLog));
+    EXPECT_LT(std::filesystem::file_size(compactTrace), std::filesystem::file_size(binaryTrace));
+    std::ifstream csv(csvLog);
+    std::string line;
+    int nLines = 0;
+    while (std::getline(csv, line)) {
+        ++nLines;
+    }
+    EXPECT_GT(nLines, 1);
+}
+TEST(BinaryTrace, CorruptedTrace) {
+    const std::string file = "binaryTraceCorrupted.bin";
+    {
+        std::ofstream fid(file, std::ios::binary);
+        fid << "NQPX";
+    }
+    BinaryTraceReader reader;
+    EXPECT_FALSE(reader.Open(file));
+    {
+        std::ofstream fid(file, std::ios::binary);
+        fid.write(BINARY_TRACE::magic, sizeof(BINARY_TRACE::magic));
+        const std::uint16_t header[2] = {BINARY_TRACE::version, 0};
+        fid.write(reinterpret_cast<const char*>(header), sizeof(header));
+        fid << "I" << char(0x85);
+    }
+    ASSERT_TRUE(reader.Open(file));
+    EXPECT_EQ(reader.Next(), BinaryTraceReader::Record::CORRUPTED);
+    {
+        // vector length 2^61 + 1: count * sizeof(double) wraps to 8 bytes
+        std::ofstream fid(file, std::ios::binary);
+        fid.write(BINARY_TRACE::magic, sizeof(BINARY_TRACE::magic));
+        const std::uint16_t header[2] = {BINARY_TRACE::version, 0};
+        fid.write(reinterpret_cast<const char*>(header), sizeof(header));
+        fid << "I" << char(1) << char(1) << char(0);
+        const double values[5] = {1.0, 0.0, 0.0, 0.0, 0.0};
+        fid.write(reinterpret_cast<const char*>(values), 4 * sizeof(double));
+        std::uint64_t n = (std::uint64_t(1) << 61) + 1;
+        while (n >= 0x80) {
+            fid << char((n & 0x7F) | 0x80);
+            n >>= 7;
+        }
+        fid << char(n);
+        fid.write(reinterpret_cast<const char*>(values), sizeof(double));
+    }
+    ASSERT_TRUE(reader.Open(file));
+    EXPECT_EQ(reader.Next(), BinaryTraceReader::Record::CORRUPTED);
+}
+TEST(Profiler, CpuTimerIgnoresSleep) {
+    cpuTimer cpu;
+    wcTimer wall;
+    cpu.Start();
+    wall.Start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_GE(wall.NsFromStart(), 20000000U);
+    EXPECT_LT(cpu.NsFromStart(), 10000000U);
+    volatile double sum = 0.0;
+    for (int i = 0; i < 20000000; ++i) {
+        sum = sum + 1.0e-3 * i;
+    }
+    EXPECT_GT(cpu.NsFromStart(), 0U);
+}
+TEST(Profiler, NestedPhases) {
+    PhaseProfiler profiler;
+    profiler.Enable(true, true);
+    profiler.Reset();
+    {
+        PhaseProfiler::Scope outer(profiler, SolverPhase::LINE_SEARCH);
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        for (int i = 0; i < 2; ++i) {
+            PhaseProfiler::Scope inner(profiler, SolverPhase::LS_DELETE);
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+    SolverProfile profile;
+    profiler.Fill(profile);
+    ASSERT_TRUE(profile.enabled);
+    const PhaseTime& outer = profile[SolverPhase::LINE_SEARCH];
+    const PhaseTime& inner = profile[SolverPhase::LS_DELETE];
+    EXPECT_EQ(outer.calls, 1);
+    EXPECT_EQ(inner.calls, 2);
+    EXPECT_GE(inner.wall, 0.02);
+    EXPECT_GE(outer.wall, inner.wall + 0.005);
+    EXPECT_NEAR(outer.selfWall, outer.wall - inner.wall, 1.0e-9);
+    EXPECT_EQ(inner.wall, inner.selfWall);
+    EXPECT_GE(profile.wall, outer.wall);
+    EXPECT_EQ(profile[SolverPhase::PRICING].calls, 0);
+}
+TEST(Profiler, SolverOutput) {
+    ProblemReader pr;
+    pr.Init(case_3.H, case_3.c, case_3.A, case_3.b);
+    for (bool enabled : {true, false}) {
+        QPNNLSDense solver;
+        Settings settings = NqpTestSettingsDefault;
+        settings.coreSettings.profile = enabled;
+        settings.coreSettings.profileCpuTime = true;
+        solver.Init(settings);
+        ASSERT_TRUE(solver.SetProblem(pr.getProblem()));
+        solver.Solve();
+        const SolverOutput& output = solver.GetOutput();
+        const SolverProfile& profile = output.profile;
+        ASSERT_EQ(profile.enabled, enabled);
+        if (!enabled) {
+            EXPECT_EQ(profile[SolverPhase::PRICING].calls, 0);
+            continue;
+        }
+        EXPECT_TRUE(profile.cpuTime);
+        EXPECT_EQ(profile[SolverPhase::CHOLETSKY].calls, 1);
+        EXPECT_EQ(profile[SolverPhase::INVERSION].calls, 1);
+        EXPECT_EQ(profile[SolverPhase::M_FORMATION].calls, 1);
+        EXPECT_EQ(profile[SolverPhase::SCALING].calls, 1);
+        EXPECT_EQ(profile[SolverPhase::DUALITY_GAP].calls, 1);
+        EXPECT_GE(profile[SolverPhase::PRICING].calls, output.nDualIterations);
+        EXPECT_EQ(profile[SolverPhase::LS_ADD].calls, output.nDualIterations);
+        EXPECT_GE(profile[SolverPhase::LS_SOLVE].calls, output.nDualIterations);
+        double selfWall = 0.0;
+        for (const PhaseTime& phase : profile.phases) {
+            EXPECT_GE(phase.wall, phase.selfWall);
+            EXPECT_GE(phase.cpu, phase.selfCpu);
+            selfWall += phase.selfWall;
+        }
+        EXPECT_LE(selfWall, profile.wall);
+        EXPECT_GT(profile.wall, 0.0);
+    }
+}
+TEST(Profiler, HwCountersDegradeGracefully) {
+    ProblemReader pr;
+    pr.Init(case_3.H, case_3.c, case_3.A, case_3.b);
+    QPNNLSDense solver;
+    Settings settings = NqpTestSettingsDefault;
+    settings.coreSettings.profile = true;
+    settings.coreSettings.profileHwCounters = true;
+    solver.Init(settings);
+    ASSERT_TRUE(solver.SetProblem(pr.getProblem()));
+    solver.Solve();
+    const SolverProfile& profile = solver.GetOutput().profile;
+    PerfCounters perf;
+    EXPECT_EQ(profile.hwCounters, perf.Open());
+    const PhaseTime& pricing = profile[SolverPhase::PRICING];
+    EXPECT_GT(pricing.calls, 0);
+    if (profile.hwCounters) {
+        EXPECT_GT(pricing.hw[HwCounter::CYCLES], 0);
+        EXPECT_GE(profile.hw[HwCounter::CYCLES], pricing.hw[HwCounter::CYCLES]);
+        EXPECT_LE(pricing.selfHw[HwCounter::CYCLES], pricing.hw[HwCounter::CYCLES]);
+    } else {
+        for (const PhaseTime& phase : profile.phases) {
+            for (auto value : phase.hw.values) {
+                EXPECT_EQ(value, 0);
+            }
+        }
+    }
+}
+TEST(SolverCounters, CountersAreConsistent) {
+    ProblemReader pr;
+    pr.Init(case_3.H, case_3.c, case_3.A, case_3.b);
+    for (LinSolverType type : {LinSolverType::MSS1, LinSolverType::CUMULATIVE_LDLT, LinSolverType::CUMULATIVE_EG_LDLT}) {
+        QPNNLSDense solver;
+        Settings settings = NqpTestSettingsDefault;
+        settings.coreSettings.linSolverType = type;
+        settings.coreSettings.profile = true;
+        solver.Init(settings);
+        ASSERT_TRUE(solver.SetProblem(pr.getProblem()));
+        solver.Solve();
+        const SolverOutput& output = solver.GetOutput();
+        const SolverCounters& counters = output.counters;
+        EXPECT_GT(output.nDualIterations, 0);
+        EXPECT_EQ(counters.activeSetAdds, output.nDualIterations);
+        EXPECT_GE(counters.primalIterations, output.nDualIterations);
+        EXPECT_EQ(counters.activeSetChanges, counters.activeSetAdds + counters.activeSetDeletes);
+        EXPECT_GE(counters.refactorizations, counters.primalIterations);
+        EXPECT_LE(counters.refactorizations, output.profile[SolverPhase::LS_SOLVE].calls);
+        EXPECT_LE(counters.lineSearchSteps, counters.primalIterations);
+        EXPECT_LE(counters.singularSolves, counters.refactorizations);
+        EXPECT_GE(counters.peakActiveSet, 1);
+        EXPECT_LE(counters.peakActiveSet, counters.activeSetAdds);
+        EXPECT_GT(counters.Flops(SolverPhase::CHOLETSKY), 0.0);
+        EXPECT_GT(counters.Flops(SolverPhase::PRICING), 0.0);
+        EXPECT_GT(counters.Flops(SolverPhase::LS_SOLVE), 0.0);
+        EXPECT_GT(counters.Flops(SolverPhase::DUALITY_GAP), 0.0);
+    }
+}
+TEST(WarmStart, ChainedSolvesMatchColdStart) {
+    using namespace QP_GENERATOR;
+    // SQP like sequence: same H and A, drifting c and b
+    DenseQPProblem problem = Generate(QPFamily::MPC, 40, 30, 11);
+    Settings settings = NqpTestSettingsDefault;
+    settings.coreSettings.reuseFactorization = true;
+    QPNNLSDense chained;
+    chained.Init(settings);
+    Rng rng(3);
+    std::vector<unsg_t> activeSet;
+    unsg_t nWarm = 0;
+    for (int it = 0; it < 5; ++it) {
+        for (auto& ci : problem.c) {
+            ci += 0.05 * rng.Normal();
+        }
+        for (auto& bi : problem.b) {
+            bi += 0.01 * rng.Normal();
+        }
+        SolverOutput coldOutput;
+        SolveDense(problem, NqpTestSettingsDefault, coldOutput);
+        ASSERT_TRUE(chained.SetProblem(problem));
+        chained.SetWarmStart(activeSet);
+        chained.Solve();
+        const SolverOutput& output = chained.GetOutput();
+        EXPECT_EQ(output.counters.factorizationReused, it > 0);
+        ASSERT_EQ(output.dualExitStatus, coldOutput.dualExitStatus);
+        ExpectSameSolution(output, coldOutput);
+        nWarm += output.counters.warmStartSize;
+        activeSet = output.activeSet;
+    }
+    EXPECT_GT(nWarm, 0);
+}
+TEST(Presolve, RedundantRowsAndFixedVariables) {
+    using namespace QP_GENERATOR;
+    DenseQPProblem problem = Generate(QPFamily::TALL, 20, 10, 4);
+    const std::size_t n = problem.H.size();
+    const std::size_t m = problem.A.size();
+    const std::vector<double> row0 = problem.A[0];
+    // duplicates with looser and tighter rhs, empty row, singleton rows, row dominated by bounds
+    std::vector<double> scaled(row0);
+    for (auto& v : scaled) {
+        v *= 3.0;
+    }
+    problem.A.push_back(scaled);
+    problem.b.push_back(3.0 * problem.b[0] + 1.0);
+    problem.A.push_back(problem.A[1]);
+    problem.b.push_back(problem.b[1] - 0.01);
+    problem.A.push_back(std::vector<double>(n, 0.0));
+    problem.b.push_back(1.0);
+    std::vector<double> singleton(n, 0.0);
+    singleton[2] = 2.0;
+    problem.A.push_back(singleton);
+    problem.b.push_back(0.1);
+    singleton[2] = 0.0;
+    singleton[3] = -1.0;
+    problem.A.push_back(singleton);
+    problem.b.push_back(-0.05);
+    std::vector<double> dominated(n, 0.0);
+    dominated[4] = 1.0;
+    dominated[5] = 1.0;
+    problem.A.push_back(dominated);
+    problem.b.push_back(1.0e3);
+    problem.lw[6] = problem.up[6] = 0.02;
+    problem.lw[7] = problem.up[7] = 0.0;
+    Settings settings = NqpTestSettingsDefault;
+    SolverOutput reference;
+    SolveDense(problem, settings, reference);
+    ASSERT_EQ(reference.dualExitStatus, DualLoopExitStatus::ALL_DUAL_POSITIVE);
+    settings.coreSettings.presolve = true;
+    settings.coreSettings.profile = true;
+    SolverOutput output;
+    SolveDense(problem, settings, output);
+    ASSERT_EQ(output.dualExitStatus, reference.dualExitStatus);
+    EXPECT_GE(output.counters.presolveRows, 6);
+    EXPECT_EQ(output.counters.presolveVariables, 2);
+    EXPECT_GT(output.profile[SolverPhase::PRESOLVE].calls, 0);
+    ASSERT_EQ(output.x.size(), n);
+    ASSERT_EQ(output.lambda.size(), m + 6);
+    ExpectSameSolution(output, reference);
+    EXPECT_NEAR(output.x[6], 0.02, 1.0e-12);
+    ExpectKkt(problem, output);
+    ASSERT_EQ(output.violations.size(), problem.A.size() + 2 * n);
+    for (double v : output.violations) {
+        EXPECT_LT(v, 1.0e-6);
+    }
+}
+TEST(RangedRows, NativeMatchesDuplicatedRows) {
+    using namespace QP_GENERATOR;
+    const DenseQPProblem base = Generate(QPFamily::TALL, 20, 12, 5);
+    const std::size_t n = base.H.size();
+    const std::size_t m = base.A.size();
+    // bLw <= A * x <= b natively and as A * x <= b, -A * x <= -bLw
+    DenseQPProblem ranged = base;
+    DenseQPProblem split = base;
+    ranged.bLw.resize(m);
+    for (std::size_t i = 0; i < m; ++i) {
+        ranged.bLw[i] = base.b[i] - 0.3;
+        split.A.emplace_back(n);
+        for (std::size_t j = 0; j < n; ++j) {
+            split.A.back()[j] = -base.A[i][j];
+        }
+        split.b.push_back(-ranged.bLw[i]);
+    }
+    ranged.bLw.back() = -1.0e20; // one-sided row
+    split.A.pop_back();
+    split.b.pop_back();
+    Settings settings = NqpTestSettingsDefault;
+    SolverOutput reference;
+    SolveDense(split, settings, reference);
+    ASSERT_EQ(reference.dualExitStatus, DualLoopExitStatus::ALL_DUAL_POSITIVE);
+    for (bool presolve : {false, true}) {
+        SCOPED_TRACE(presolve ? "presolve" : "no presolve");
+        settings.coreSettings.presolve = presolve;
+        DenseQPProblem problem = ranged;
+        if (presolve) {
+            problem.lw[3] = problem.up[3] = reference.x[3];
+        }
+        SolverOutput output;
+        SolveDense(problem, settings, output);
+        ASSERT_EQ(output.dualExitStatus, DualLoopExitStatus::ALL_DUAL_POSITIVE);
+        ExpectSameSolution(output, reference);
+        ASSERT_EQ(output.lambda.size(), m);
+        ASSERT_EQ(output.lambdaRowLw.size(), m);
+        ASSERT_EQ(output.violations.size(), 2 * m - 1 + 2 * n);
+        if (presolve) {
+            continue; // multipliers of the fixed variable differ
+        }
+        double maxLambdaLw = 0.0;
+        for (std::size_t i = 0; i < m; ++i) {
+            EXPECT_NEAR(output.lambda[i], reference.lambda[i], 1.0e-5) << i;
+            const double lambdaLw = i + 1 < m ? reference.lambda[m + i] : 0.0;
+            EXPECT_NEAR(output.lambdaRowLw[i], lambdaLw, 1.0e-5) << i;
+            maxLambdaLw = std::max(maxLambdaLw, output.lambdaRowLw[i]);
+        }
+        EXPECT_GT(maxLambdaLw, 1.0e-3);
+        ExpectKkt(problem, output);
+    }
+}
+TEST(EqualityElimination, NullSpaceMatchesSplitEqualities) {
+    using namespace QP_GENERATOR;
+    const DenseQPProblem base = Generate(QPFamily::TALL, 20, 12, 7);
+    const std::size_t n = base.H.size();
+    const std::size_t nEq = 4;
+    Settings settings = NqpTestSettingsDefault;
+    SolverOutput baseOutput;
+    SolveDense(base, settings, baseOutput);
+    const std::vector<double>& xFeasible = baseOutput.x;
+    ASSERT_EQ(xFeasible.size(), n);
+    // F * x = g through a feasible point, F is rank deficient: the last row is a sum of two others
+    matrix_t F(nEq, std::vector<double>(n, 0.0));
+    std::vector<double> g(nEq, 0.0);
+    for (std::size_t i = 0; i < nEq; ++i) {
+        for (std::size_t j = 0; j < n; ++j) {
+            F[i][j] = i + 1 < nEq ? std::sin(1.0 + i * n + j) : F[0][j] + F[1][j];
+            g[i] += F[i][j] * xFeasible[j];
+        }
+    }
+    DenseQPProblem equality = base;
+    DenseQPProblem split = base;
+    equality.A.insert(equality.A.begin(), F.begin(), F.end());
+    equality.b.insert(equality.b.begin(), g.begin(), g.end());
+    equality.nEqConstraints = nEq;
+    for (std::size_t i = 0; i < nEq; ++i) {
+        split.A.push_back(F[i]);
+        split.b.push_back(g[i]);
+        split.A.emplace_back(n);
+        for (std::size_t j = 0; j < n; ++j) {
+            split.A.back()[j] = -F[i][j];
+        }
+        split.b.push_back(-g[i]);
+    }
+    SolverOutput reference;
+    SolveDense(split, settings, reference);
+    ASSERT_EQ(reference.dualExitStatus, DualLoopExitStatus::ALL_DUAL_POSITIVE);
+    for (bool eliminate : {false, true}) {
+        SCOPED_TRACE(eliminate ? "eliminated" : "split");
+        settings.coreSettings.eliminateEqualities = eliminate;
+        SolverOutput output;
+        SolveDense(equality, settings, output);
+        ASSERT_EQ(output.dualExitStatus, DualLoopExitStatus::ALL_DUAL_POSITIVE);
+        EXPECT_EQ(output.counters.eliminatedEqualities, eliminate ? nEq : 0);
+        ExpectSameSolution(output, reference);
+        ASSERT_EQ(output.lambda.size(), equality.A.size());
+        ASSERT_EQ(output.violations.size(), equality.A.size() + 2 * n);
+        for (std::size_t i = 0; i < equality.A.size(); ++i) {
+            EXPECT_LT(i < nEq ? std::fabs(output.violations[i]) : output.violations[i], 1.0e-6) << i;
+        }
+        ExpectKkt(equality, output);
+    }
+}
+TEST(BandedHessian, MatchesDenseFactorization) {
+    using namespace QP_GENERATOR;
+    DenseQPProblem mpc = Generate(QPFamily::MPC, 40, 30, 5);
+    DenseQPProblem diagonal = Generate(QPFamily::BOX, 30, 0, 9);
+    for (std::size_t i = 0; i < diagonal.H.size(); ++i) {
+        for (std::size_t j = 0; j < diagonal.H.size(); ++j) {
+            diagonal.H[i][j] = i == j ? 1.0 + 0.1 * i : 0.0;
+        }
+    }
+    ASSERT_EQ(Bandwidth(diagonal.H), 0);
+    const unsg_t bw = Bandwidth(mpc.H);
+    ASSERT_GT(bw, 0);
+    ASSERT_LT(4 * (bw + 1), mpc.H.size());
+    // the skipped terms are exact zeros: the band factor is the dense one
+    const std::size_t n = mpc.H.size();
+    matrix_t chol(n, std::vector<double>(n, 0.0));
+    matrix_t cholBand(n, std::vector<double>(n, 1.0));
+    CholetskyOutput cholOutput;
+    ASSERT_TRUE(ComputeCholFactorT(mpc.H, chol, cholOutput));
+    ASSERT_TRUE(ComputeBandCholFactorT(mpc.H, bw, cholBand, cholOutput));
+    matrix_t inv(n, std::vector<double>(n, 0.0));
+    matrix_t invBand(n, std::vector<double>(n, 0.0));
+    InvertCholetsky(chol, inv);
+    InvertBandCholetsky(cholBand, bw, invBand);
+    std::vector<double> y;
+    SolveBandCholetskyT(cholBand, bw, mpc.c, y);
+    std::vector<double> yDense(n);
+    MultTransp(inv, mpc.c, yDense);
+    std::vector<double> x;
+    SolveBandCholetsky(cholBand, bw, mpc.c, x);
+    std::vector<double> xDense(n);
+    Mult(inv, mpc.c, xDense);
+    for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t j = 0; j <= i; ++j) {
+            EXPECT_EQ(cholBand[i][j], chol[i][j]) << i << " " << j;
+            EXPECT_NEAR(invBand[i][j], inv[i][j], 1.0e-12) << i << " " << j;
+        }
+        EXPECT_NEAR(y[i], yDense[i], 1.0e-10) << i;
+        EXPECT_NEAR(x[i], xDense[i], 1.0e-10) << i;
+    }
+    for (const DenseQPProblem* problem : {&mpc, &diagonal}) {
+        Settings settings = NqpTestSettingsDefault;
+        settings.coreSettings.hessianStructure = HessianStructure::DENSE;
+        SolverOutput reference;
+        SolveDense(*problem, settings, reference);
+        EXPECT_FALSE(reference.counters.bandedFactorization);
+        settings.coreSettings.hessianStructure = HessianStructure::AUTO;
+        SolverOutput output;
+        SolveDense(*problem, settings, output);
+        EXPECT_TRUE(output.counters.bandedFactorization);
+        EXPECT_EQ(output.counters.hessianBandwidth, problem == &mpc ? bw : 0);
+        EXPECT_LT(output.counters.Flops(SolverPhase::CHOLETSKY), reference.counters.Flops(SolverPhase::CHOLETSKY));
+        EXPECT_EQ(output.counters.Flops(SolverPhase::INVERSION), 0.0); // band solves, no dense Q^-1
+        ASSERT_EQ(output.dualExitStatus, reference.dualExitStatus);
+        ExpectSameSolution(output, reference, 1.0e-7, 1.0e-8);
+    }
+    // a callback still gets Q^-1 of a band factor
+    struct InitCapture : public Callback {
+        void ProcessData(int stage) override {
+            if (stage == 1) {
+                chol = initData.Chol;
+                cholInv = initData.CholInv;
+            }
+        }
+        matrix_t chol;
+        matrix_t cholInv;
+    };
+    auto capture = std::make_unique<InitCapture>();
+    InitCapture* init = capture.get();
+    QPNNLSDense traced;
+    traced.SetCallback(std::move(capture));
+    traced.Init(NqpTestSettingsDefault);
+    ASSERT_TRUE(traced.SetProblem(mpc));
+    traced.Solve();
+    ASSERT_TRUE(traced.GetOutput().counters.bandedFactorization);
+    ASSERT_EQ(init->cholInv.size(), n);
+    matrix_t identity(n, std::vector<double>(n, 0.0));
+    Mult(init->chol, init->cholInv, identity);
+    for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t j = 0; j < n; ++j) {
+            EXPECT_NEAR(identity[i][j], i == j ? 1.0 : 0.0, 1.0e-10) << i << " " << j;
+        }
+    }
+}
+TEST(MixedPrecision, MatchesDoublePath) {
+    // float pricing and solves, the refinement in double recovers the accuracy of the double path
+    using namespace QP_GENERATOR;
+    for (std::size_t f = 0; f < nFamilies; ++f) {
+        const QPFamily family = static_cast<QPFamily>(f);
+        SCOPED_TRACE(ToString(family));
+        const DenseQPProblem problem = Generate(family, 30, 40, 11 + f);
+        Settings settings = NqpTestSettingsDefault;
+        SolverOutput reference;
+        SolveDense(problem, settings, reference);
+        settings.coreSettings.mixedPrecision = true;
+        SolverOutput output;
+        SolveDense(problem, settings, output);
+        EXPECT_GT(output.counters.lowPrecisionIterations, 0u);
+        ASSERT_EQ(output.dualExitStatus, reference.dualExitStatus);
+        ExpectSameSolution(output, reference, 1.0e-8, 1.0e-9);
+        ASSERT_EQ(output.lambda.size(), reference.lambda.size());
+        for (std::size_t i = 0; i < output.lambda.size(); ++i) {
+            EXPECT_NEAR(output.lambda[i], reference.lambda[i], 1.0e-7 * (1.0 + std::fabs(reference.lambda[i]))) << i;
+        }
+        ASSERT_EQ(output.violations.size(), reference.violations.size());
+        for (std::size_t i = 0; i < output.violations.size(); ++i) {
+            EXPECT_NEAR(output.violations[i], reference.violations[i], 1.0e-8) << i;
+        }
+    }
+}
+TEST(MixedPrecision, RefinesWhenIterationsRunOut) {
+    // the float loop uses up the dual iterations, the final active set is still solved in double
+    using namespace QP_GENERATOR;
+    const DenseQPProblem problem = Generate(QPFamily::TALL, 30, 60, 13);
+    Settings settings = NqpTestSettingsDefault;
+    SolverOutput converged;
+    SolveDense(problem, settings, converged);
+    ASSERT_EQ(converged.dualExitStatus, DualLoopExitStatus::ALL_DUAL_POSITIVE);
+    ASSERT_GT(converged.nDualIterations, 4);
+    settings.coreSettings.nDualIterations = 4;
+    SolverOutput reference;
+    SolveDense(problem, settings, reference);
+    ASSERT_EQ(reference.dualExitStatus, DualLoopExitStatus::ITERATIONS);
+    settings.coreSettings.mixedPrecision = true;
+    SolverOutput output;
+    SolveDense(problem, settings, output);
+    EXPECT_EQ(output.dualExitStatus, DualLoopExitStatus::ITERATIONS);
+    EXPECT_EQ(output.counters.lowPrecisionIterations, 4u);
+    // the double solver of the refinement re-added the final active set
+    EXPECT_EQ(output.counters.activeSetChanges, reference.counters.activeSetChanges + output.activeSet.size());
+    ExpectSameSolution(output, reference, 1.0e-8, 1.0e-9);
+    ASSERT_EQ(output.violations.size(), reference.violations.size());
+    for (std::size_t i = 0; i < output.violations.size(); ++i) {
+        EXPECT_NEAR(output.violations[i], reference.violations[i], 1.0e-8) << i;
+    }
+}
+TEST(LambdaRefinement, ReusesActiveSetFactorization) {
+    using namespace QP_GENERATOR;
+    for (std::size_t f = 0; f < nFamilies; ++f) {
+        const QPFamily family = static_cast<QPFamily>(f);
+        SCOPED_TRACE(ToString(family));
+        const DenseQPProblem problem = Generate(family, 30, 40, 21 + f);
+        SolverOutput output;
+        SolveDense(problem, NqpTestSettingsDefault, output);
+        ASSERT_EQ(output.dualExitStatus, DualLoopExitStatus::ALL_DUAL_POSITIVE);
+        ASSERT_FALSE(output.activeSet.empty());
+        EXPECT_TRUE(output.counters.lambdaFactorizationReused);
+        EXPECT_LE(output.counters.lambdaRefinements, NqpTestSettingsDefault.coreSettings.lambdaRefinementSteps);
+        EXPECT_LT(output.counters.lambdaResidual, 1.0e-10);
+        ExpectKkt(problem, output, 1.0e-8);
+    }
+}
+double MaxViolation(const DenseQPProblem& problem, const SolverOutput& output) {
+    // equality rows are violated on both sides
+    double violation = 0.0;
+    for (std::size_t i = 0; i < problem.A.size(); ++i) {
+        const double residual = DotProduct(problem.A[i], output.x) - problem.b[i];
+        violation = std::fmax(violation, i < problem.nEqConstraints ? std::fabs(residual) : residual);
+    }
+    for (std::size_t j = 0; j < output.x.size(); ++j) {
+        violation = std::fmax(violation, std::fmax(problem.lw[j] - output.x[j], output.x[j] - problem.up[j]));
+    }
+    return violation;
+}
+void CheckTimeLimit(const DenseQPProblem& problem, SolverOutput& output) {
+    Settings settings = NqpTestSettingsDefault;
+    SolverOutput reference;
+    SolveDense(problem, settings, reference);
+    ASSERT_EQ(reference.dualExitStatus, DualLoopExitStatus::ALL_DUAL_POSITIVE);
+    ASSERT_GT(reference.nDualIterations, 1);
+    EXPECT_LT(reference.maxViolation, 1.0e-6);
+    // expired before the first active row: the unconstrained minimum is the only iterate
+    settings.coreSettings.timeLimit = std::chrono::nanoseconds(1);
+    SolveDense(problem, settings, output);
+    ASSERT_EQ(output.dualExitStatus, DualLoopExitStatus::TIME_LIMIT);
+    EXPECT_EQ(output.counters.bestIteration, 0);
+    ASSERT_EQ(output.x.size(), problem.H.size());
+    EXPECT_GT(output.maxViolation, 1.0e-3);
+    EXPECT_NEAR(output.maxViolation, MaxViolation(problem, output), 1.0e-8);
+    EXPECT_TRUE(std::isfinite(output.dualityGap));
+    EXPECT_LE(output.cost, reference.cost + 1.0e-8 * (1.0 + std::fabs(reference.cost)));
+    // a budget that is not reached changes nothing
+    settings.coreSettings.timeLimit = std::chrono::seconds(10);
+    SolverOutput full;
+    SolveDense(problem, settings, full);
+    ASSERT_EQ(full.dualExitStatus, DualLoopExitStatus::ALL_DUAL_POSITIVE);
+    EXPECT_EQ(full.nDualIterations, reference.nDualIterations);
+    EXPECT_EQ(full.cost, reference.cost);
+    EXPECT_NEAR(full.maxViolation, MaxViolation(problem, full), 1.0e-8);
+}
+TEST(TimeLimit, ReturnsLeastViolatingIterate) {
+    using namespace QP_GENERATOR;
+    const DenseQPProblem problem = Generate(QPFamily::TALL, 40, 120, 3);
+    SolverOutput output;
+    CheckTimeLimit(problem, output);
+    ASSERT_FALSE(HasFatalFailure());
+    // equality row through the interior point 0 with A * x - b < 0 at the unconstrained minimum,
+    // twice as violated as any inequality: only its lower side is infeasible
+    DenseQPProblem equality = problem;
+    std::vector<double> row = problem.A.front();
+    const double scale = -(2.0 * output.maxViolation + 1.0) / DotProduct(row, output.x);
+    for (double& a : row) {
+        a *= scale;
+    }
+    equality.A.insert(equality.A.begin(), row);
+    equality.b.insert(equality.b.begin(), 0.0);
+    equality.nEqConstraints = 1;
+    SolverOutput eqOutput;
+    CheckTimeLimit(equality, eqOutput);
+    ASSERT_FALSE(HasFatalFailure());
+    EXPECT_LT(eqOutput.violations.front(), 0.0);
+    EXPECT_NEAR(eqOutput.maxViolation, -eqOutput.violations.front(), 1.0e-8);
+}
+template <std::size_t NV, std::size_t NC, typename Scalar = double>
+FixedQPProblem<NV, NC, Scalar> ToFixedProblem(const DenseQPProblem& problem) {
+    FixedQPProblem<NV, NC, Scalar> fixedProblem;
+    for (std::size_t i = 0; i < NV; ++i) {
+        std::copy(problem.H[i].begin(), problem.H[i].end(), fixedProblem.H[i].begin());
+        fixedProblem.c[i] = static_cast<Scalar>(problem.c[i]);
+        fixedProblem.lw[i] = static_cast<Scalar>(problem.lw[i]);
+        fixedProblem.up[i] = static_cast<Scalar>(problem.up[i]);
+    }
+    for (std::size_t i = 0; i < NC; ++i) {
+        std::copy(problem.A[i].begin(), problem.A[i].end(), fixedProblem.A[i].begin());
+        fixedProblem.b[i] = static_cast<Scalar>(problem.b[i]);
+    }
+    return fixedProblem;
+}
+template <std::size_t NV, std::size_t NC>
+void CheckFixedCore(const DenseQPProblem& problem) {
+    ASSERT_EQ(problem.H.size(), NV);
+    ASSERT_EQ(problem.A.size(), NC);
+    const FixedQPProblem<NV, NC> fixedProblem = ToFixedProblem<NV, NC>(problem);
+    QPNNLSDense solver;
+    solver.Init(NqpTestSettingsDefault);
+    ASSERT_TRUE(solver.SetProblem(problem));
+    solver.Solve();
+    const SolverOutput& reference = solver.GetOutput();
+    static FixedCore<NV, NC> fixedCore; // ~ (NC + 2 * NV)^2 doubles, kept off the stack
+    fixedCore.Set(NqpTestSettingsDefault.coreSettings);
+    ASSERT_TRUE(fixedCore.SetProblem(fixedProblem));
+    fixedCore.Solve();
+    const auto& output = fixedCore.GetOutput();
+    ASSERT_EQ(output.dualExitStatus, reference.dualExitStatus);
+    EXPECT_EQ(output.nDualIterations, reference.nDualIterations);
+    EXPECT_NEAR(output.cost, reference.cost, 1.0e-8 * (1.0 + std::fabs(reference.cost)));
+    for (std::size_t i = 0; i < NV; ++i) {
+        EXPECT_NEAR(output.x[i], reference.x[i], 1.0e-7) << i;
+        EXPECT_NEAR(output.lambdaUp[i], reference.lambdaUp[i], 1.0e-6) << i;
+        EXPECT_NEAR(output.lambdaLw[i], reference.lambdaLw[i], 1.0e-6) << i;
+    }
+    for (std::size_t i = 0; i < NC; ++i) {
+        EXPECT_NEAR(output.lambda[i], reference.lambda[i], 1.0e-6) << i;
+    }
+}
+TEST(FixedCore, MatchesDenseCore) {
+    using namespace QP_GENERATOR;
+    for (std::uint64_t seed = 1; seed <= 5; ++seed) {
+        CheckFixedCore<8, 12>(Generate(QPFamily::TALL, 8, 12, seed));
+        CheckFixedCore<6, 0>(Generate(QPFamily::BOX, 6, 0, seed));
+    }
+    CheckFixedCore<20, 40>(Generate(QPFamily::TALL, 20, 40, 3));
+}
+TEST(FixedCore, FloatReselectsActiveRow) {
+    // float rounding makes the dual of an active row negative on several of these seeds (1, 4, 20, 23, ...),
+    // selecting it again must not be counted as a new active row (was: FULL_ACTIVE_SET) nor cycle to ITERATIONS
+    using namespace QP_GENERATOR;
+    constexpr std::size_t NV = 8;
+    constexpr std::size_t NC = 12;
+    static FixedCore<NV, NC, double> reference;
+    static FixedCore<NV, NC, float> fixedCore;
+    reference.Set(NqpTestSettingsDefault.coreSettings);
+    fixedCore.Set(NqpTestSettingsDefault.coreSettings);
+    for (std::uint64_t seed = 1; seed <= 40; ++seed) {
+        const DenseQPProblem problem = Generate(QPFamily::TALL, NV, NC, seed);
+        ASSERT_TRUE(reference.SetProblem(ToFixedProblem<NV, NC>(problem)));
+        ASSERT_TRUE(fixedCore.SetProblem(ToFixedProblem<NV, NC, float>(problem)));
+        reference.Solve();
+        fixedCore.Solve();
+        const auto& output = fixedCore.GetOutput();
+        ASSERT_EQ(output.dualExitStatus, DualLoopExitStatus::ALL_DUAL_POSITIVE) << seed;
+        EXPECT_LE(output.nDualIterations, 2 * reference.GetOutput().nDualIterations) << seed;
+        for (std::size_t i = 0; i < NV; ++i) {
+            EXPECT_NEAR(output.x[i], reference.GetOutput().x[i], 1.0e-3) << seed << " " << i;
+        }
+    }
+}
+TEST(SolverGenerator, GeneratedMpcMatchesCore) {
+    // generated_mpc.h is emitted at build time by nnls_codegen --generate mpc 12 0 1,
+    // numeric values change every tick on the same structure
+    using namespace QP_GENERATOR;
+    namespace gen = generated_mpc;
+    static gen::Solver generated;
+    Rng rng(17);
+    for (std::uint64_t tick = 1; tick <= 6; ++tick) {
+        DenseQPProblem problem = Generate(QPFamily::MPC, 12, 0, tick);
+        ASSERT_EQ(problem.H.size(), gen::nV);
+        ASSERT_EQ(problem.A.size(), gen::nC);
+        for (std::size_t i = 0; i < gen::nV; ++i) {
+            problem.H[i][i] += rng.Uniform(0.0, 0.5);
+            problem.up[i] = rng.Uniform(0.5, 1.5);
+        }
+        for (std::size_t i = 0; i < gen::nC; ++i) {
+            problem.b[i] = rng.Uniform(0.1, 0.3);
+        }
+        std::vector<double> H;
+        std::vector<double> A;
+        for (const auto& row : problem.H) {
+            H.insert(H.end(), row.begin(), row.end());
+        }
+        for (const auto& row : problem.A) {
+            A.insert(A.end(), row.begin(), row.end());
+        }
+        ASSERT_TRUE(generated.Setup(H.data(), A.data(), problem.b.data(), problem.c.data(),
+                                    problem.lw.data(), problem.up.data()));
+        generated.Solve();
+        const gen::Output& output = generated.GetOutput();
+        QPNNLSDense solver;
+        solver.Init(NqpTestSettingsDefault);
+        ASSERT_TRUE(solver.SetProblem(problem));
+        solver.Solve();
+        const SolverOutput& reference = solver.GetOutput();
+        ASSERT_EQ(reference.dualExitStatus, DualLoopExitStatus::ALL_DUAL_POSITIVE);
+        ASSERT_EQ(output.status, gen::Status::ALL_DUAL_POSITIVE) << tick;
+        EXPECT_NEAR(output.cost, reference.cost, 1.0e-8 * (1.0 + std::fabs(reference.cost))) << tick;
+        for (std::size_t i = 0; i < gen::nV; ++i) {
+            EXPECT_NEAR(output.x[i], reference.x[i], 1.0e-7) << i;
+            EXPECT_NEAR(output.lambdaUp[i], reference.lambdaUp[i], 1.0e-6) << i;
+            EXPECT_NEAR(output.lambdaLw[i], reference.lambdaLw[i], 1.0e-6) << i;
+        }
+        for (std::size_t i = 0; i < gen::nC; ++i) {
+            EXPECT_NEAR(output.lambda[i], reference.lambda[i], 1.0e-6) << i;
+        }
+    }
+}
+TEST(MpcCondenser, MatchesExplicitCondensing) {
+    // double integrator with an extra input, |u| <= 1, position in [-1, 2], velocity <= 0.8
+    MpcProblem mpc;
+    const double dt = 0.2;
+    mpc.A = {{1.0, dt}, {0.0, 1.0}};
+    mpc.B = {{0.5 * dt * dt, 0.0}, {dt, 0.1}};
+    mpc.Q = {{1.0, 0.1}, {0.1, 0.5}};
+    mpc.R = {{0.1, 0.0}, {0.0, 0.2}};
+    mpc.P = {{5.0, 0.5}, {0.5, 2.0}};
+    mpc.horizon = 8;
+    mpc.xMin = {-1.0, -1.0e20};
+    mpc.xMax = {2.0, 0.8};
+    mpc.uMin = {-1.0, -1.0};
+    mpc.uMax = {1.0, 1.0};
+    const std::size_t nx = 2, nu = 2, N = mpc.horizon, nU = N * nu;
+    MpcCondenser condenser;
+    ASSERT_FALSE(condenser.Set(MpcProblem()));
+    ASSERT_TRUE(condenser.Set(mpc));
+    const std::vector<double> x0 = {1.5, 0.6};
+    const DenseQPProblem& problem = condenser.Update(x0);
+    // explicit X = Phi * x0 + Gamma * U
+    matrix_t Gamma(N * nx, std::vector<double>(nU, 0.0));
+    matrix_t Phi(N * nx, std::vector<double>(nx, 0.0));
+    matrix_t Ak = mpc.A;
+    for (std::size_t k = 0; k < N; ++k) {
+        for (std::size_t s = 0; s < nx; ++s) {
+            for (std::size_t j = 0; j < nx; ++j) {
+                Phi[k * nx + s][j] = Ak[s][j];
+            }
+            for (std::size_t l = 0; l < nu; ++l) {
+                Gamma[k * nx + s][k * nu + l] = mpc.B[s][l];
+            }
+            for (std::size_t j = 0; j + 1 <= k; ++j) {
+                for (std::size_t l = 0; l < nu; ++l) {
+                    double v = 0.0;
+                    for (std::size_t t = 0; t < nx; ++t) {
+                        v += mpc.A[s][t] * Gamma[(k - 1) * nx + t][j * nu + l];
+                    }
+                    Gamma[k * nx + s][j * nu + l] = v;
+                }
+            }
+        }
+        matrix_t next(nx, std::vector<double>(nx, 0.0));
+        for (std::size_t s = 0; s < nx; ++s) {
+            for (std::size_t j = 0; j < nx; ++j) {
+                for (std::size_t t = 0; t < nx; ++t) {
+                    next[s][j] += mpc.A[s][t] * Ak[t][j];
+                }
+            }
+        }
+        Ak = next;
+    }
+    const auto weight = [&](std::size_t row, std::size_t col) {
+        if (row / nx != col / nx) {
+            return 0.0;
+        }
+        return row / nx + 1 == N ? mpc.P[row % nx][col % nx] : mpc.Q[row % nx][col % nx];
+    };
+    ASSERT_EQ(problem.H.size(), nU);
+    ASSERT_EQ(problem.c.size(), nU);
+    for (std::size_t i = 0; i < nU; ++i) {
+        double c = 0.0;
+        for (std::size_t r = 0; r < N * nx; ++r) {
+            for (std::size_t t = 0; t < N * nx; ++t) {
+                c += Gamma[r][i] * weight(r, t) * Phi[t][0] * x0[0] + Gamma[r][i] * weight(r, t) * Phi[t][1] * x0[1];
+            }
+        }
+        EXPECT_NEAR(problem.c[i], c, 1.0e-10) << i;
+        for (std::size_t j = 0; j < nU; ++j) {
+            double h = i / nu == j / nu ? mpc.R[i % nu][j % nu] : 0.0;
+            for (std::size_t r = 0; r < N * nx; ++r) {
+                for (std::size_t t = 0; t < N * nx; ++t) {
+                    h += Gamma[r][i] * weight(r, t) * Gamma[t][j];
+                }
+            }
+            EXPECT_NEAR(problem.H[i][j], h, 1.0e-10) << i << " " << j;
+        }
+        EXPECT_DOUBLE_EQ(problem.lw[i], mpc.uMin[i % nu]);
+        EXPECT_DOUBLE_EQ(problem.up[i], mpc.uMax[i % nu]);
+    }
+    // position rows are ranged, velocity rows are one sided
+    ASSERT_EQ(problem.A.size(), N * nx);
+    ASSERT_EQ(problem.bLw.size(), N * nx);
+    for (std::size_t r = 0; r < N * nx; ++r) {
+        const double response = Phi[r][0] * x0[0] + Phi[r][1] * x0[1];
+        for (std::size_t j = 0; j < nU; ++j) {
+            EXPECT_NEAR(problem.A[r][j], Gamma[r][j], 1.0e-12) << r;
+        }
+        EXPECT_NEAR(problem.b[r], mpc.xMax[r % nx] - response, 1.0e-12) << r;
+        if (r % nx == 0) {
+            EXPECT_NEAR(problem.bLw[r], mpc.xMin[0] - response, 1.0e-12) << r;
+        } else {
+            EXPECT_LE(problem.bLw[r], -CONSTANTS::infiniteBound) << r;
+        }
+    }
+    // per tick solves: H and A are unchanged, the factorization of H is reused
+    Settings settings = NqpTestSettingsDefault;
+    settings.coreSettings.reuseFactorization = true;
+    QPNNLSDense solver;
+    solver.Init(settings);
+    const matrix_t H = problem.H;
+    const matrix_t A = problem.A;
+    std::vector<double> x = x0;
+    for (int tick = 0; tick < 4; ++tick) {
+        condenser.Update(x);
+        EXPECT_EQ(problem.H, H);
+        EXPECT_EQ(problem.A, A);
+        ASSERT_TRUE(solver.SetProblem(problem));
+        solver.Solve();
+        const SolverOutput& output = solver.GetOutput();
+        ASSERT_EQ(output.dualExitStatus, DualLoopExitStatus::ALL_DUAL_POSITIVE) << tick;
+        EXPECT_EQ(output.counters.factorizationReused, tick > 0);
+        matrix_t states;
+        condenser.PredictStates(x, output.x, states);
+        ASSERT_EQ(states.size(), N);
+        for (const auto& state : states) {
+            EXPECT_GE(state[0], mpc.xMin[0] - 1.0e-6);
+            EXPECT_LE(state[0], mpc.xMax[0] + 1.0e-6);
+            EXPECT_LE(state[1], mpc.xMax[1] + 1.0e-6);
+        }
+        for (double u : output.x) {
+            EXPECT_LE(std::fabs(u), 1.0 + 1.0e-6);
+        }
+        x = states.front();
+    }
+}
+TEST(QpGenerator, SeededFamilies) {
+    using namespace QP_GENERATOR;
+    // golden values recorded on x86-64 gcc, the generator must reproduce them on every platform;
+    // the tolerance only absorbs libm differences in Normal()
+    Rng rng(7);
+    EXPECT_EQ(rng.Next(), 7191089600892374487ULL);
+    EXPECT_EQ(rng.Next(), 309689372594955804ULL);
+    EXPECT_EQ(rng.Next(), 16616101746815609346ULL);
+    EXPECT_EQ(Rng(7).Uniform(-1.0, 1.0), -0.22034050321745702);
+    // sums of H, c, A and b entries for Generate(family, 30, 8, 7)
+    const std::array<std::array<double, 4>, nFamilies> golden = {{
+        {15.786038811730823, -8.422540824324134, 0.0, 0.0},
+        {42.600000000000051, -38.212538147438885, 0.0, 11.599999999999991},
+        {6.0375583830690989, -3.0370579320810718, 30.0, 2.3999999999999999},
+        {123.25067742048448, -30.0, 0.0, 0.0},
+        {38.04841311578835, 40.297358733130899, 0.44874058008872342, 3.9977853676616597},
+    }};
+    for (std::size_t i = 0; i < nFamilies; ++i) {
+        const QPFamily family = static_cast<QPFamily>(i);
+        const DenseQPProblem p1 = Generate(family, 30, 8, 7);
+        const DenseQPProblem p2 = Generate(family, 30, 8, 7);
+        const DenseQPProblem p3 = Generate(family, 30, 8, 8);
+        EXPECT_EQ(p1.H, p2.H) << ToString(family);
+        EXPECT_EQ(p1.A, p2.A) << ToString(family);
+        EXPECT_EQ(p1.c, p2.c) << ToString(family);
+        EXPECT_NE(p1.H == p3.H && p1.A == p3.A && p1.c == p3.c, true) << ToString(family);
+        std::array<double, 4> sums{};
+        for (const auto& row : p1.H) {
+            sums[0] = std::accumulate(row.begin(), row.end(), sums[0]);
+        }
+        sums[1] = std::accumulate(p1.c.begin(), p1.c.end(), 0.0);
+        for (const auto& row : p1.A) {
+            sums[2] = std::accumulate(row.begin(), row.end(), sums[2]);
+        }
+        sums[3] = std::accumulate(p1.b.begin(), p1.b.end(), 0.0);
+        for (std::size_t k = 0; k < sums.size(); ++k) {
+            EXPECT_NEAR(sums[k], golden[i][k], 1e-10 * (1.0 + std::fabs(golden[i][k]))) << ToString(family) << " " << k;
+        }
+        QPNNLSDense solver;
+        solver.Init(NqpTestSettingsDefault);
+        ASSERT_TRUE(solver.SetProblem(p1)) << ToString(family);
+        solver.Solve();
+        const SolverOutput& output = solver.GetOutput();
+        EXPECT_NE(output.dualExitStatus, DualLoopExitStatus::INFEASIBILITY) << ToString(family);
+        EXPECT_EQ(output.x.size(), 30) << ToString(family);
+    }
+}
+TEST(TxtParserTests, MappedParallelParse) {
+    // free formatting: line breaks inside rows, explicit plus signs, exponents
+    const std::filesystem::path file = std::filesystem::temp_directory_path() / "nqp_txt_parser_test.txt";
+    const std::size_t n = 60;
+    {
+        std::ofstream fid(file);
+        fid << "{";
+        for (std::size_t i = 0; i < n; ++i) {
+            fid << (i > 0 ? ",\n" : "") << "{";
+            for (std::size_t j = 0; j < n; ++j) {
+                fid << (j > 0 ? (j % 7 == 0 ? ",\n  " : ", ") : "") << (j % 2 == 0 ? "+" : "-") << (i + 1) << ".5e" << (j % 3);
+            }
+            fid << "}";
+        }
+        fid << "}\n{{1.0, 0.0}, {0.0, 1.0}}\n{ -1, +2 }\n{-1.0e20,-3}\n{1.0e20, 3.25}\n";
+    }
+    TxtParser sequential;
+    sequential.SetParallel(1);
+    TxtParser parallel;
+    parallel.SetParallel(4, 0);
+    bool status = false;
+    const DenseQPProblem p1 = sequential.Parse(file.string(), status);
+    ASSERT_TRUE(status);
+    const DenseQPProblem p2 = parallel.Parse(file.string(), status);
+    ASSERT_TRUE(status);
+    ASSERT_EQ(p1.H.size(), n);
+    for (std::size_t i = 0; i < n; ++i) {
+        ASSERT_EQ(p1.H[i].size(), n);
+        for (std::size_t j = 0; j < n; ++j) {
+            const double expected = (j % 2 == 0 ? 1.0 : -1.0) * (i + 1.5) * std::pow(10.0, j % 3);
+            EXPECT_DOUBLE_EQ(p1.H[i][j], expected);
+        }
+    }
+    EXPECT_EQ(p1.H, p2.H);
+    EXPECT_EQ(p1.A, p2.A);
+    EXPECT_EQ(p1.c, std::vector<double>({-1.0, 2.0}));
+    EXPECT_EQ(p1.lw, std::vector<double>({-1.0e20, -3.0}));
+    EXPECT_EQ(p1.up, std::vector<double>({1.0e20, 3.25}));
+    {
+        std::ofstream fid(file);
+        fid << "{{1.0, 2.0}, {3.0}}\n{{1.0, x}}\n{1}\n{1}\n{1}\n"; // ragged hessian
+    }
+    EXPECT_FALSE((parallel.Parse(file.string(), status), status));
+    {
+        std::ofstream fid(file);
+        fid << "{{1.0}}\n{{1.0, x}}\n{1}\n{1}\n{1}\n"; // bad number
+    }
+    EXPECT_FALSE((sequential.Parse(file.string(), status), status));
+    {
+        std::ofstream fid(file);
+        fid << "{{1.0}}\n{{1.0}}\n{1e-400}\n{-1e400}\n{+1e999}\n"; // out of double range
+    }
+    const DenseQPProblem p3 = sequential.Parse(file.string(), status);
+    ASSERT_TRUE(status);
+    EXPECT_EQ(p3.c, std::vector<double>({0.0}));
+    EXPECT_EQ(p3.lw, std::vector<double>({-1.0e20}));
+    EXPECT_EQ(p3.up, std::vector<double>({1.0e20}));
+    EXPECT_FALSE((sequential.Parse((file.parent_path() / "nqp_missing_file.txt").string(), status), status));
+    std::filesystem::remove(file);
+}
+TEST(BinaryProblem, RoundTripDenseAndSparse) {
+    using namespace BINARY_QP_FORMAT;
+    // mpc rows are sparse, portfolio hessian is dense
+    const std::filesystem::path file = std::filesystem::temp_directory_path() / "nqp_binary_problem_test.nqpb";
+    for (QP_GENERATOR::QPFamily family : {QP_GENERATOR::QPFamily::MPC, QP_GENERATOR::QPFamily::PORTFOLIO}) {
+        DenseQPProblem original = QP_GENERATOR::Generate(family, 25, 3, 5);
+        if (family == QP_GENERATOR::QPFamily::MPC) {
+            original.bLw.assign(original.b.size(), -1.0);
+        }
+        ASSERT_TRUE(WriteProblem(file.string(), original, flagLeftRight));
+        ProblemFile binary;
+        ASSERT_TRUE(binary.Open(file.string())) << binary.GetError();
+        EXPECT_EQ(binary.GetHeader().flags, flagLeftRight);
+        EXPECT_EQ(binary.GetHeader().nVariables, 25);
+        EXPECT_EQ(binary.GetHeader().nConstraints, original.A.size());
+        if (family == QP_GENERATOR::QPFamily::MPC) {
+            ASSERT_TRUE(binary.IsSparse(SectionId::A));
+            const SparseView A = binary.Sparse(SectionId::A);
+            EXPECT_EQ(A.nnz, 2 * original.A.size());
+            EXPECT_EQ(reinterpret_cast<std::uintptr_t>(A.values) % sizeof(double), 0);
+        } else {
+            ASSERT_FALSE(binary.IsSparse(SectionId::H));
+            const DenseView H = binary.Dense(SectionId::H);
+            EXPECT_EQ(reinterpret_cast<std::uintptr_t>(H.data) % alignment, 0);
+            EXPECT_EQ(H(3, 7), original.H[3][7]);
+        }
+        DenseQPProblem loaded;
+        ASSERT_TRUE(binary.ToProblem(loaded));
+        EXPECT_EQ(loaded.H, original.H);
+        EXPECT_EQ(loaded.A, original.A);
+        EXPECT_EQ(loaded.b, original.b);
+        EXPECT_EQ(loaded.bLw, original.bLw);
+        EXPECT_EQ(loaded.c, original.c);
+        EXPECT_EQ(loaded.lw, original.lw);
+        EXPECT_EQ(loaded.up, original.up);
+        EXPECT_EQ(loaded.nEqConstraints, original.nEqConstraints);
+    }
+    {
+        // section tables that are consistent in size but disagree with the header
+        DenseQPProblem original = QP_GENERATOR::Generate(QP_GENERATOR::QPFamily::MPC, 25, 3, 5);
+        ASSERT_TRUE(WriteProblem(file.string(), original));
+        const auto corrupt = [&file](SectionId id, const std::function<void(Section&)>& patch) {
+            std::fstream fid(file, std::ios::binary | std::ios::in | std::ios::out);
+            const std::streamoff pos = sizeof(Header) + static_cast<std::size_t>(id) * sizeof(Section);
+            Section section;
+            fid.seekg(pos);
+            fid.read(reinterpret_cast<char*>(&section), sizeof(section));
+            Section patched = section;
+            patch(patched);
+            fid.seekp(pos);
+            fid.write(reinterpret_cast<const char*>(&patched), sizeof(patched));
+            fid.close();
+            ProblemFile binary;
+            const bool opened = binary.Open(file.string());
+            std::fstream restore(file, std::ios::binary | std::ios::in | std::ios::out);
+            restore.seekp(pos);
+            restore.write(reinterpret_cast<const char*>(&section), sizeof(section));
+            return opened;
+        };
+        ASSERT_EQ(original.b.size() % 2, 0);
+        EXPECT_FALSE(corrupt(SectionId::B, [](Section& s) { s.rows = 2; s.cols /= 2; }));
+        EXPECT_FALSE(corrupt(SectionId::LW, [](Section& s) { s.cols -= 1; s.size -= sizeof(double); }));
+        EXPECT_FALSE(corrupt(SectionId::B, [](Section& s) { s.offset = std::numeric_limits<std::uint64_t>::max() - 63; }));
+        EXPECT_FALSE(corrupt(SectionId::H, [](Section& s) { s.rows = s.cols = 0xFFFFFFFFu; s.size = 0; }));
+        ProblemFile binary;
+        EXPECT_TRUE(binary.Open(file.string())) << binary.GetError();
+    }
+    std::filesystem::resize_file(file, std::filesystem::file_size(file) - 128);
+    ProblemFile truncated;
+    EXPECT_FALSE(truncated.Open(file.string()));
+    EXPECT_FALSE(truncated.GetError().empty());
+    std::filesystem::remove(file);
+}
+TEST(QpsReader, FreeFormatQPTEST) {
+    using namespace QPS_PARSER;
+    // Maros-Meszaros QPTEST
+    const std::string qps =
+        "NAME          QPTEST\n"
+        "ROWS\n"
+        " N  obj\n"
+        " G  r1\n"
+        " L  r2\n"
+        "COLUMNS\n"
+        "    c1        r1        2.0          r2        -1.0\n"
+        "    c1        obj       1.5\n"
+        "    c2        r1        1.0          r2        2.0\n"
+        "    c2        obj       -2.0\n"
+        "RHS\n"
+        "    rhs1      r1        2.0          r2        6.0\n"
+        "BOUNDS\n"
+        " UP bnd1      c1        20.0\n"
+        "QUADOBJ\n"
+        "    c1        c1        8.0\n"
+        "    c1        c2        2.0\n"
+        "    c2        c2        10.0\n"
+        "ENDATA\n";
+    QpsReader reader;
+    QPS_PARSER::SparseQPProblem sparse;
+    ASSERT_TRUE(reader.ReadString(qps, sparse)) << reader.GetError();
+    const double tol = 1.0e-12;
+    EXPECT_EQ(sparse.name, "QPTEST");
+    ASSERT_EQ(sparse.NVariables(), 2);
+    ASSERT_EQ(sparse.NConstraints(), 2);
+    EXPECT_EQ(sparse.aRowPtr, std::vector<std::size_t>({0, 2, 4}));
+    EXPECT_EQ(sparse.aValues, std::vector<double>({2.0, 1.0, -1.0, 2.0}));
+    EXPECT_EQ(sparse.hValues.size(), 3);
+    EXPECT_NEAR(sparse.rowLw[0], 2.0, tol);
+    EXPECT_NEAR(sparse.rowUp[0], infinity, tol);
+    EXPECT_NEAR(sparse.rowLw[1], -infinity, tol);
+    EXPECT_NEAR(sparse.rowUp[1], 6.0, tol);
+    EXPECT_NEAR(sparse.up[0], 20.0, tol);
+    EXPECT_NEAR(sparse.up[1], infinity, tol);
+    DenseQPProblem problem;
+    ToDense(sparse, problem);
+    ASSERT_EQ(problem.A.size(), 2);
+    EXPECT_EQ(problem.A[0], std::vector<double>({-2.0, -1.0}));
+    EXPECT_NEAR(problem.b[0], -2.0, tol);
+    EXPECT_NEAR(problem.H[1][0], 2.0, tol);
+    EXPECT_NEAR(problem.H[0][1], 2.0, tol);
+    QPNNLSDense solver;
+    solver.Init(NqpTestSettingsDefault);
+    ASSERT_TRUE(solver.SetProblem(problem));
+    solver.Solve();
+    EXPECT_NEAR(solver.GetOutput().cost, 4.371875, 1.0e-6);
+}
+TEST(QpsReader, FixedFormatRangesAndBounds) {
+    using namespace QPS_PARSER;
+    // fixed fields start at columns 2, 5, 15, 25, 40, 50 and names may contain spaces
+    const auto card = [](std::initializer_list<const char*> fields) {
+        constexpr std::size_t starts[] = {1, 4, 14, 24, 39, 49};
+        std::string line;
+        std::size_t k = 0;
+        for (const char* field : fields) {
+            line.resize(starts[k++], ' ');
+            line += field;
+        }
+        return line + "\n";
+    };
+    const std::string qps =
+        "NAME          FIXED\n"
+        "ROWS\n" + card({"N", "COST"}) + card({"E", "ROW A"}) + card({"L", "ROW B"}) + card({"G", "ROW C"}) +
+        card({"E", "ROW D"}) +
+        "COLUMNS\n" + card({"", "X 1", "COST", "1.0", "ROW A", "1.0"}) + card({"", "X 1", "ROW B", "1.0", "ROW C", "1.0"}) +
+        card({"", "X 2", "ROW D", "1.0", "ROW B", "3.0"}) + card({"", "X 3", "COST", "-1.0"}) +
+        "RHS\n" + card({"", "RHS", "ROW A", "1.0", "ROW B", "4.0"}) + card({"", "RHS", "ROW C", "-1.0", "ROW D", "2.0"}) +
+        card({"", "RHS", "COST", "3.0"}) +
+        "RANGES\n" + card({"", "RNG", "ROW A", "2.0", "ROW B", "3.0"}) + card({"", "RNG", "ROW C", "5.0", "ROW D", "-0.5"}) +
+        "BOUNDS\n" + card({"UP", "BND", "X 1", "-2.0"}) + card({"FX", "BND", "X 2", "1.5"}) + card({"FR", "BND", "X 3"}) +
+        "QMATRIX\n" + card({"", "X 1", "X 1", "2.0"}) + card({"", "X 1", "X 3", "1.0"}) + card({"", "X 3", "X 1", "1.0"}) +
+        "ENDATA\n";
+    QpsReader reader;
+    QPS_PARSER::SparseQPProblem sparse;
+    ASSERT_TRUE(reader.ReadString(qps, sparse, QpsFormat::FIXED)) << reader.GetError();
+    const double tol = 1.0e-12;
+    ASSERT_EQ(sparse.NVariables(), 3);
+    ASSERT_EQ(sparse.NConstraints(), 4);
+    EXPECT_EQ(sparse.colNames[0], "X 1");
+    EXPECT_NEAR(sparse.objConstant, -3.0, tol);
+    EXPECT_EQ(sparse.aColIndices, std::vector<unsg_t>({0, 0, 1, 0, 1}));
+    EXPECT_NEAR(sparse.rowLw[0], 1.0, tol);
+    EXPECT_NEAR(sparse.rowUp[0], 3.0, tol);
+    EXPECT_NEAR(sparse.rowLw[1], 1.0, tol);
+    EXPECT_NEAR(sparse.rowUp[1], 4.0, tol);
+    EXPECT_NEAR(sparse.rowLw[2], -1.0, tol);
+    EXPECT_NEAR(sparse.rowUp[2], 4.0, tol);
+    EXPECT_NEAR(sparse.rowLw[3], 1.5, tol);
+    EXPECT_NEAR(sparse.rowUp[3], 2.0, tol);
+    EXPECT_NEAR(sparse.lw[0], -infinity, tol);
+    EXPECT_NEAR(sparse.up[0], -2.0, tol);
+    EXPECT_NEAR(sparse.lw[1], 1.5, tol);
+    EXPECT_NEAR(sparse.up[1], 1.5, tol);
+    EXPECT_NEAR(sparse.lw[2], -infinity, tol);
+    EXPECT_EQ(sparse.hValues.size(), 2); // upper triangle of QMATRIX is dropped
+    DenseQPProblem problem;
+    ToDense(sparse, problem);
+    EXPECT_EQ(problem.nEqConstraints, 0);
+    EXPECT_EQ(problem.A.size(), 8);
+    EXPECT_NEAR(problem.H[0][2], 1.0, tol);
+    EXPECT_NEAR(problem.H[2][0], 1.0, tol);
+    DenseQPProblem ranged;
+    ToDense(sparse, ranged, true);
+    EXPECT_EQ(ranged.A.size(), 4);
+    EXPECT_NEAR(ranged.bLw[1], 1.0, tol);
+    EXPECT_NEAR(ranged.b[1], 4.0, tol);
+    QPS_PARSER::SparseQPProblem broken;
+    EXPECT_FALSE(reader.ReadString("ROWS\n N obj\nCOLUMNS\n x missing 1.0\nENDATA\n", broken));
+    EXPECT_NE(reader.GetError().find("line 4"), std::string::npos);
+}
+TEST(FsqpLog, IndexedStreaming) {
+    using namespace FSQP_LOG_PARSER;
+    // 2 variables, 1 constraint: lambda d0 holds 2 * nX bound multipliers and the constraint one
+    const std::filesystem::path file = std::filesystem::temp_directory_path() / "nqp_fsqp_log_test.txt";
+    const unsigned int firstIteration = 1;
+    const unsigned int nIterations = 3;
+    {
+        std::ofstream fid(file);
+        fid << "FSQP log\n  lowerBounds: [-5.0,-5.0]\n  upperBounds: [5.0,5.0]\n";
+        for (unsigned int it = firstIteration; it < firstIteration + nIterations; ++it) {
+            fid << "ITERATION: " << it << "\n"
+                << "  x: [" << it << ".5,1.0]\n"
+                << "  d0: [0.1,0.2]\n"
+                << "  m_cVectorForD0: [" << it << ".0,-1.0]\n"
+                << "  m_bVectorForD0: [2.0]\n"
+                << "  lambda d0: [0.0,0.0,0.0,0.0,0.0]\n"
+                << "  lower bounds d0: [-1.0,-1.0,-1.0]\n"
+                << "  upper bounds d0: [1.0,1.0,1.0]\n"
+                << "  jacobian for d0:\n    0] 0) 1.0 1) 1.0\n"
+                << "  hessian:\n    0] 0) 2.0 1) 0.0 2) 0.0\n    1] 0) 0.0 1) 2.0 2) 0.0\n"
+                << "    2] 0) 0.0 1) 0.0 2) 1.0\n";
+        }
+    }
+    IterationLog log;
+    ASSERT_TRUE(log.Open(file.string())) << log.GetError();
+    ASSERT_EQ(log.GetBlocks().size(), nIterations);
+    std::size_t index = 0;
+    ASSERT_TRUE(log.Find(2, index));
+    EXPECT_EQ(index, 1);
+    EXPECT_FALSE(log.Find(0, index));
+    FSQP_LOG_PARSER::IterationData data;
+    ASSERT_TRUE(log.Read(index, data));
+    EXPECT_EQ(data.m_x, std::vector<double>({2.5, 1.0}));
+    EXPECT_EQ(data.m_lower, std::vector<double>({-5.0, -5.0}));
+    EXPECT_EQ(data.m_jacobianD0.size(), 1);
+    EXPECT_EQ(data.m_hessianD0.size(), 3);
+    unsigned int nRead = 0;
+    for (auto record = log.Next(data); record != IterationLog::Record::END; record = log.Next(data)) {
+        ASSERT_EQ(record, IterationLog::Record::ITERATION);
+        EXPECT_EQ(log.GetIteration(), firstIteration + nRead);
+        EXPECT_EQ(data.m_cVectorD0[0], static_cast<double>(log.GetIteration()));
+        DenseQPProblem problem;
+        ASSERT_TRUE(IterationToProblem(data, problem));
+        EXPECT_EQ(problem.H, matrix_t({{2.0, 0.0}, {0.0, 2.0}}));
+        ++nRead;
+    }
+    EXPECT_EQ(nRead, nIterations);
+    FSQP_LOG_PARSER::IterationData single;
+    ASSERT_TRUE(ReadIteration(file.string(), 3, single));
+    EXPECT_EQ(single.m_x, std::vector<double>({3.5, 1.0}));
+    EXPECT_FALSE(ReadIteration(file.string(), 4, single));
+    std::filesystem::remove(file);
+}
 TEST(TxtParserTests, QPTEST) {
     TxtParser parser;
     bool status = false;
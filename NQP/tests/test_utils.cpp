@@ -372,6 +372,40 @@ void TestSolverDense(const QP_NNLS_TEST_DATA::QPProblem& problem, const Settings
 
 
 
+void SolveDense(const DenseQPProblem& problem, const Settings& settings, SolverOutput& output) {
+    QPNNLSDense solver;
+    solver.Init(settings);
+    ASSERT_TRUE(solver.SetProblem(problem));
+    solver.Solve();
+    output = solver.GetOutput();
+}
+
+void ExpectSameSolution(const SolverOutput& output, const SolverOutput& reference, double xTol, double costTol) {
+    EXPECT_NEAR(output.cost, reference.cost, costTol * (1.0 + std::fabs(reference.cost)));
+    ASSERT_EQ(output.x.size(), reference.x.size());
+    for (std::size_t i = 0; i < output.x.size(); ++i) {
+        EXPECT_NEAR(output.x[i], reference.x[i], xTol) << i;
+    }
+}
+
+void ExpectKkt(const DenseQPProblem& problem, const SolverOutput& output, double tol) {
+    const std::size_t n = problem.H.size();
+    const std::size_t m = problem.A.size();
+    ASSERT_EQ(output.x.size(), n);
+    ASSERT_EQ(output.lambda.size(), m);
+    const bool ranged = !output.lambdaRowLw.empty();
+    for (std::size_t j = 0; j < n; ++j) {
+        double r = problem.c[j] + output.lambdaUp[j] - output.lambdaLw[j];
+        for (std::size_t k = 0; k < n; ++k) {
+            r += problem.H[j][k] * output.x[k];
+        }
+        for (std::size_t i = 0; i < m; ++i) {
+            r += problem.A[i][j] * (ranged ? output.lambda[i] - output.lambdaRowLw[i] : output.lambda[i]);
+        }
+        EXPECT_NEAR(r, 0.0, tol) << j;
+    }
+}
+
 void LinearTransform::setQPProblem(const QP_NNLS_TEST_DATA::QPProblem& problem) {
 	A = problem.A;
 	b = problem.b;
@@ -819,13 +853,19 @@ void DenseQPTester::ComputePrInfeasibility(const DenseQPProblem& problem) {
     unsigned int nViolatedC = 0;
     double violatedC = 0.0;
     for (std::size_t i = 0; i < problem.A.size(); ++i) {
-        double constraint = -problem.b[i];
+        double ax = 0.0;
         for (std::size_t j = 0; j < problem.A[i].size(); ++j) {
-            constraint += problem.A[i][j] * output.x[j];
+            ax += problem.A[i][j] * output.x[j];
+        }
+        double constraint = ax - problem.b[i];
+        double bound = problem.b[i];
+        if (i < problem.bLw.size() && problem.bLw[i] - ax > constraint) {
+            constraint = problem.bLw[i] - ax;
+            bound = problem.bLw[i];
         }
         if (constraint > maxInfsblC) {
             ++nViolatedC;
-            violatedC = problem.b[i];
+            violatedC = bound;
             maxInfsblC = constraint;
         }
     }
@@ -863,8 +903,13 @@ void DenseQPTester::ComputeDlInfeasibility(const DenseQPProblem& problem) {
     unsigned int nViolated = 0;   
     std::vector<double> dualFsb(problem.H.size());
     Mult(problem.H, output.x, dualFsb);
+    // lower sides of ranged rows enter with the opposite sign
+    std::vector<double> rowLambda = output.lambda;
+    for (std::size_t i = 0; i < output.lambdaRowLw.size(); ++i) {
+        rowLambda[i] -= output.lambdaRowLw[i];
+    }
     std::vector<double> AtLambda(problem.H.size());
-    MultTransp(problem.A, output.lambda, AtLambda);
+    MultTransp(problem.A, rowLambda, AtLambda);
     // xTx, xTx, bTl, lTl, uTl are duality gap components
     xHx = 0.0;
     cTx = 0.0;
@@ -893,6 +938,13 @@ void DenseQPTester::ComputeDlInfeasibility(const DenseQPProblem& problem) {
             ++nNegLambda;
         }
     }
+    for (std::size_t i = 0; i < output.lambdaRowLw.size(); ++i) {
+        bTL -= problem.bLw[i] * output.lambdaRowLw[i];
+        if (output.lambdaRowLw[i] < 0.0) {
+            maxNegDual = std::fmax(maxNegDual, -output.lambdaRowLw[i]);
+            ++nNegLambda;
+        }
+    }
     lTL = 0.0;
     uTL = 0.0;
     for (std::size_t i = 0; i < output.lambdaLw.size(); ++i) {
@@ -67,6 +67,13 @@ void TestMMTb(const matrix_t& M, const std::vector<double>& b);
 //void TestSolver(const QP_NNLS_TEST_DATA::QPProblem& problem, const UserSettings& settings, const QPBaseline& baseline);
 void TestSolverDense(const QP_NNLS_TEST_DATA::QPProblem& problem, const Settings& settings, const QPBaseline& baseline,
                      const std::string& logFile);
+// fresh QPNNLSDense solve of a generated / modified problem
+void SolveDense(const DenseQPProblem& problem, const Settings& settings, SolverOutput& output);
+// cost within costTol * (1 + |cost|) of the reference, every x within xTol
+void ExpectSameSolution(const SolverOutput& output, const SolverOutput& reference,
+                        double xTol = 1.0e-5, double costTol = 1.0e-6);
+// stationarity of the original problem: H * x + c + A_T * (lambda - lambdaRowLw) + lambdaUp - lambdaLw = 0
+void ExpectKkt(const DenseQPProblem& problem, const SolverOutput& output, double tol = 1.0e-5);
 double relativeVal(double a, double b);
 class TestCholetskyBase {
 public:
@@ -0,0 +1,67 @@
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "binary_problem.h"
+#include "qp_generator.h"
+#include "solverGenerator.h"
+
+// emits a standalone solver header specialized to the structure of a template problem
+namespace {
+int Usage() {
+    std::cerr << "usage: nnls_codegen <problem.nqpb> <output.h> [--name generated]\n"
+                 "       nnls_codegen --generate <family> <n> <m> <seed> <output.h> [--name generated]"
+              << std::endl;
+    return 1;
+}
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> positional;
+    std::string name = "generated";
+    bool generate = false;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--generate") {
+            generate = true;
+        } else if (arg == "--name" && i + 1 < argc) {
+            name = argv[++i];
+        } else {
+            positional.push_back(arg);
+        }
+    }
+    QP_NNLS::DenseQPProblem problem;
+    if (generate) {
+        QP_GENERATOR::QPFamily family;
+        if (positional.size() != 5 || !QP_GENERATOR::FromString(positional[0], family)) {
+            return Usage();
+        }
+        problem = QP_GENERATOR::Generate(family, static_cast<unsigned int>(std::atoi(positional[1].c_str())),
+                                         static_cast<unsigned int>(std::atoi(positional[2].c_str())),
+                                         std::strtoull(positional[3].c_str(), nullptr, 10));
+        positional.erase(positional.begin(), positional.begin() + 4);
+    } else {
+        if (positional.size() != 2) {
+            return Usage();
+        }
+        BINARY_QP_FORMAT::ProblemFile file;
+        if (!file.Open(positional[0]) || !file.ToProblem(problem)) {
+            std::cerr << positional[0] << ": " << file.GetError() << std::endl;
+            return 1;
+        }
+        positional.erase(positional.begin());
+    }
+    QP_CODEGEN::SolverGenerator generator;
+    if (!generator.Set(problem)) {
+        std::cerr << generator.GetError() << std::endl;
+        return 1;
+    }
+    std::ofstream out(positional[0]);
+    if (!out) {
+        std::cerr << "failed to open " << positional[0] << std::endl;
+        return 1;
+    }
+    generator.Write(out, name);
+    return out ? 0 : 1;
+}
@@ -0,0 +1,149 @@
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include "binary_problem.h"
+#include "qp_utils.h"
+#include "qps_reader.h"
+#include "TxtParser.h"
+
+// converts txt and qps problems and FSQP log iterations to binary problem files
+namespace {
+using namespace TXT_QP_PARSER;
+namespace fs = std::filesystem;
+
+struct ConvertOptions {
+    DENSE_PROBLEM_FORMAT fmt = DENSE_PROBLEM_FORMAT::RIGHT;
+    double sparseDensity = 0.25;
+};
+
+bool ConvertQps(const fs::path& input, const fs::path& output, const ConvertOptions& options) {
+    QPS_PARSER::QpsReader reader;
+    QPS_PARSER::SparseQPProblem sparse;
+    if (!reader.Read(input.string(), sparse)) {
+        std::cerr << input.string() << ": " << reader.GetError() << std::endl;
+        return false;
+    }
+    QP_NNLS::DenseQPProblem problem;
+    const bool ranged = options.fmt == DENSE_PROBLEM_FORMAT::LEFT_RIGHT;
+    QPS_PARSER::ToDense(sparse, problem, ranged);
+    const std::uint16_t flags = ranged ? BINARY_QP_FORMAT::flagLeftRight : 0;
+    if (!BINARY_QP_FORMAT::WriteProblem(output.string(), problem, flags, options.sparseDensity)) {
+        std::cerr << "failed to write " << output.string() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool ConvertTxt(const fs::path& input, const fs::path& output, const ConvertOptions& options,
+                DenseProblemFormatter& formatter) {
+    if (QPS_PARSER::IsQpsExtension(input.extension().string())) {
+        return ConvertQps(input, output, options);
+    }
+    const QP_NNLS::DenseQPProblem& problem = formatter.PrepareProblem(input.string(), options.fmt);
+    if (!formatter.GetRetStatus().status) {
+        std::cerr << input.string() << ": " << formatter.GetRetStatus().errMsg << std::endl;
+        return false;
+    }
+    const std::uint16_t flags = options.fmt == DENSE_PROBLEM_FORMAT::LEFT_RIGHT ? BINARY_QP_FORMAT::flagLeftRight : 0;
+    if (!BINARY_QP_FORMAT::WriteProblem(output.string(), problem, flags, options.sparseDensity)) {
+        std::cerr << "failed to write " << output.string() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool ConvertFsqp(const FSQP_LOG_PARSER::IterationData& data, const fs::path& output, const ConvertOptions& options) {
+    QP_NNLS::DenseQPProblem problem;
+    if (!FSQP_LOG_PARSER::IterationToProblem(data, problem)) {
+        return false;
+    }
+    if (!BINARY_QP_FORMAT::WriteProblem(output.string(), problem, 0, options.sparseDensity)) {
+        std::cerr << "failed to write " << output.string() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int Usage() {
+    std::cerr << "usage: nnls_problem_convert <problem.txt | problem.qps | dir> <output.nqpb | dir> [--format right|left_right]"
+                 " [--sparse-density 0.25]\n"
+                 "       nnls_problem_convert --fsqp <log> <iteration | all> <output.nqpb | dir> [--sparse-density 0.25]"
+              << std::endl;
+    return 1;
+}
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> positional;
+    ConvertOptions options;
+    bool fsqp = false;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--fsqp") {
+            fsqp = true;
+        } else if (arg == "--format" && i + 1 < argc) {
+            options.fmt = std::strcmp(argv[++i], "left_right") == 0 ? DENSE_PROBLEM_FORMAT::LEFT_RIGHT
+                                                                    : DENSE_PROBLEM_FORMAT::RIGHT;
+        } else if (arg == "--sparse-density" && i + 1 < argc) {
+            options.sparseDensity = std::atof(argv[++i]);
+        } else {
+            positional.push_back(arg);
+        }
+    }
+    if (fsqp) {
+        if (positional.size() != 3) {
+            return Usage();
+        }
+        const fs::path log = positional[0];
+        FSQP_LOG_PARSER::IterationLog iterations;
+        if (!iterations.Open(log.string())) {
+            std::cerr << log.string() << ": " << iterations.GetError() << std::endl;
+            return 1;
+        }
+        FSQP_LOG_PARSER::IterationData data;
+        if (positional[1] != "all") {
+            if (!iterations.ReadIteration(static_cast<unsigned int>(std::atoi(positional[1].c_str())), data) ||
+                !ConvertFsqp(data, positional[2], options)) {
+                std::cerr << "failed to convert iteration " << positional[1] << " of " << log.string() << std::endl;
+                return 1;
+            }
+            return 0;
+        }
+        fs::create_directories(positional[2]);
+        unsigned int nConverted = 0;
+        unsigned int nFailed = 0;
+        using Record = FSQP_LOG_PARSER::IterationLog::Record;
+        for (Record record = iterations.Next(data); record != Record::END; record = iterations.Next(data)) {
+            const unsigned int it = iterations.GetIteration();
+            const fs::path output = fs::path(positional[2]) / (log.stem().string() + "_" + std::to_string(it) + ".nqpb");
+            if (record == Record::ITERATION && ConvertFsqp(data, output, options)) {
+                ++nConverted;
+            } else {
+                std::cerr << "failed to convert iteration " << it << " of " << log.string() << std::endl;
+                ++nFailed;
+            }
+        }
+        std::cout << "converted " << nConverted << " of " << iterations.GetBlocks().size() << " iterations" << std::endl;
+        return nConverted > 0 && nFailed == 0 ? 0 : 1;
+    }
+    if (positional.size() != 2) {
+        return Usage();
+    }
+    DenseProblemFormatter formatter;
+    const fs::path input = positional[0];
+    if (!fs::is_directory(input)) {
+        return ConvertTxt(input, positional[1], options, formatter) ? 0 : 1;
+    }
+    fs::create_directories(positional[1]);
+    int nFailed = 0;
+    for (const auto& entry : fs::directory_iterator(input)) {
+        const std::string ext = entry.path().extension().string();
+        if (entry.is_regular_file() && (ext == ".txt" || QPS_PARSER::IsQpsExtension(ext))) {
+            const fs::path output = fs::path(positional[1]) / (entry.path().stem().string() + ".nqpb");
+            nFailed += ConvertTxt(entry.path(), output, options, formatter) ? 0 : 1;
+        }
+    }
+    return nFailed == 0 ? 0 : 1;
+}
@@ -0,0 +1,745 @@
+#include "solverGenerator.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+namespace QP_CODEGEN {
+using namespace QP_NNLS;
+namespace {
+// dual / primal loop of FixedCore over the generated kernels, sizes and settings are constants of the namespace
+const char* runtime = R"(    void Solve() {
+        active.fill(false);
+        nActive = 0;
+        primal.fill(0.0);
+        gamma = 1.0;
+        unsigned int dualIteration = 0;
+        Status status = Status::ITERATIONS;
+        bool done = false;
+        while (dualIteration < nDualIterations) {
+            if (OrigInfeasible()) {
+                status = Status::INFEASIBILITY;
+                done = true;
+                break;
+            }
+            if (nActive == nRows) {
+                status = Status::FULL_ACTIVE_SET;
+                done = true;
+                break;
+            }
+            const std::size_t newIndex = SelectNewActiveComponent();
+            if (newIndex == nRows || active[newIndex]) {
+                // an active row is selected only by rounding, adding it again would repeat the iteration
+                status = Status::ALL_DUAL_POSITIVE;
+                done = true;
+                break;
+            }
+            if (gammaUpdate) {
+                gamma += std::fabs(s[newIndex]);
+            }
+            active[newIndex] = true;
+            ++nActive;
+            for (unsigned int primalIteration = 0; primalIteration < nPrimalIterations && nActive > 0; ++primalIteration) {
+                if (!SolvePrimal()) {
+                    primal = zp;
+                    break;
+                }
+                if (!MakeLineSearch()) {
+                    break;
+                }
+            }
+            ++dualIteration;
+        }
+        if (!done) {
+            status = Status::ITERATIONS;
+        }
+        if (status == Status::ALL_DUAL_POSITIVE || status == Status::FULL_ACTIVE_SET) {
+            SolvePrimal();
+            primal = zp;
+        }
+        if (OrigInfeasible()) {
+            status = Status::INFEASIBILITY;
+        }
+        output = Output();
+        output.status = status;
+        output.nDualIterations = dualIteration;
+        if (status != Status::INFEASIBILITY) {
+            ComputeOrigSolution();
+        }
+    }
+    const Output& GetOutput() const { return output; }
+private:
+    static double Dot(const std::array<double, nV>& v1, const std::array<double, nV>& v2) {
+        double sum = 0.0;
+        for (std::size_t j = 0; j < nV; ++j) {
+            sum += v1[j] * v2[j];
+        }
+        return sum;
+    }
+    void Scale() {
+        // OrtScaler::Scale
+        std::array<double, nRows> norm2{};
+        RowNorm2(norm2.data());
+        double scaleFactorSL = 1.0;
+        double scaleFactorSU = 1.0;
+        for (std::size_t i = 0; i < nRows; ++i) {
+            const double rat = norm2[i] / (s[i] * s[i]);
+            if (1.0e-5 < rat && rat < 1.0e5) {
+                scaleFactorSL = std::fmin(rat, scaleFactorSL);
+            } else {
+                double bf = 1.0;
+                if (rat < 1.0e-5) {
+                    bf = rat / 1.0e-5;
+                } else if (rat > 1.0e5) {
+                    bf = rat / 1.0e5;
+                }
+                if (bf < scaleFactorSU) {
+                    scaleFactorSU = std::fmax(1.0e-8, bf);
+                }
+            }
+        }
+        const bool blncL = scaleFactorSL == 1.0;
+        const bool blncU = scaleFactorSU == 1.0;
+        scaleFactor = blncL && !blncU ? scaleFactorSU : (blncL && blncU ? 1.0 : scaleFactorSL);
+        for (std::size_t i = 0; i < nRows; ++i) {
+            s[i] *= scaleFactor;
+            rowScale[i] = 1.0 / std::sqrt(norm2[i] + s[i] * s[i]);
+            s[i] *= rowScale[i];
+            for (std::size_t j = 0; j < nV; ++j) {
+                M[i][j] *= rowScale[i];
+            }
+        }
+        for (std::size_t j = 0; j < nV; ++j) {
+            v[j] *= scaleFactor;
+        }
+        primalFsb = origPrimalFsb * scaleFactor;
+    }
+    bool OrigInfeasible() {
+        styGamma = gamma;
+        std::array<double, nRows> y{};
+        for (std::size_t i = 0; i < nRows; ++i) {
+            if (active[i]) {
+                y[i] = primal[i];
+                styGamma += s[i] * primal[i];
+            }
+        }
+        MultMT(y.data(), MTY.data());
+        return Dot(MTY, MTY) + styGamma * styGamma < nnlsResidNormFsb;
+    }
+    std::size_t SelectNewActiveComponent() {
+        MultM(MTY.data(), dual.data());
+        double sty = gamma;
+        for (std::size_t i = 0; i < nRows; ++i) {
+            dual[i] += styGamma * s[i];
+            sty += s[i] * primal[i];
+        }
+        const double dualTolerance = -sty * primalFsb;
+        std::size_t newIndex = nRows;
+        double newActive = std::numeric_limits<double>::max();
+        for (int pass = 0; pass < 2 && newIndex == nRows; ++pass) {
+            for (std::size_t i = 0; i < nRows; ++i) {
+                if (active[i] == (pass == 1) && dual[i] < dualTolerance && dual[i] < newActive) {
+                    newActive = dual[i];
+                    newIndex = i;
+                }
+            }
+        }
+        return newIndex;
+    }
+    bool SolvePrimal() {
+        // min || [M_A_T; s_A_T] * z - [0; -gamma] ||, Householder QR with column pivoting
+        std::size_t k = 0;
+        for (std::size_t i = 0; i < nRows; ++i) {
+            if (active[i]) {
+                for (std::size_t j = 0; j < nV; ++j) {
+                    ls[k][j] = M[i][j];
+                }
+                ls[k][nV] = s[i];
+                lsIndex[k++] = i;
+            }
+        }
+        std::array<double, nLs> rhs{};
+        rhs[nV] = -gamma;
+        std::array<double, nRows> colNorm2{};
+        for (std::size_t col = 0; col < k; ++col) {
+            for (std::size_t r = 0; r < nLs; ++r) {
+                colNorm2[col] += ls[col][r] * ls[col][r];
+            }
+        }
+        const std::size_t steps = k < nLs ? k : nLs;
+        double threshold = 0.0;
+        std::size_t rank = 0;
+        for (; rank < steps; ++rank) {
+            std::size_t pivot = rank;
+            for (std::size_t col = rank + 1; col < k; ++col) {
+                if (colNorm2[col] > colNorm2[pivot]) {
+                    pivot = col;
+                }
+            }
+            std::swap(ls[rank], ls[pivot]);
+            std::swap(lsIndex[rank], lsIndex[pivot]);
+            std::swap(colNorm2[rank], colNorm2[pivot]);
+            double norm2 = 0.0;
+            for (std::size_t r = rank; r < nLs; ++r) {
+                norm2 += ls[rank][r] * ls[rank][r];
+            }
+            const double norm = std::sqrt(norm2);
+            if (rank == 0) {
+                threshold = norm * std::numeric_limits<double>::epsilon() * nLs;
+            }
+            if (norm <= threshold) {
+                break;
+            }
+            const double alpha = ls[rank][rank] > 0.0 ? -norm : norm;
+            std::array<double, nLs> w{};
+            for (std::size_t r = rank; r < nLs; ++r) {
+                w[r] = ls[rank][r];
+            }
+            w[rank] -= alpha;
+            const double wNorm2 = norm2 - ls[rank][rank] * ls[rank][rank] + w[rank] * w[rank];
+            ls[rank][rank] = alpha;
+            for (std::size_t r = rank + 1; r < nLs; ++r) {
+                ls[rank][r] = 0.0;
+            }
+            const auto reflect = [&](std::array<double, nLs>& col) {
+                double dot = 0.0;
+                for (std::size_t r = rank; r < nLs; ++r) {
+                    dot += w[r] * col[r];
+                }
+                const double f = 2.0 * dot / wNorm2;
+                for (std::size_t r = rank; r < nLs; ++r) {
+                    col[r] -= f * w[r];
+                }
+            };
+            for (std::size_t col = rank + 1; col < k; ++col) {
+                reflect(ls[col]);
+                colNorm2[col] -= ls[col][rank] * ls[col][rank];
+            }
+            reflect(rhs);
+        }
+        zp.fill(0.0);
+        std::array<double, nLs> z{};
+        for (std::size_t r = rank; r-- > 0;) {
+            double sum = rhs[r];
+            for (std::size_t col = r + 1; col < rank; ++col) {
+                sum -= ls[col][r] * z[col];
+            }
+            z[r] = sum / ls[r][r];
+            zp[lsIndex[r]] = z[r];
+        }
+        bool negative = false;
+        for (std::size_t col = 0; col < k; ++col) {
+            negative = negative || zp[lsIndex[col]] < nnlsPrimalZero;
+        }
+        return negative;
+    }
+    bool MakeLineSearch() {
+        double minStep = std::numeric_limits<double>::max();
+        bool stepFound = false;
+        for (std::size_t i = 0; i < nRows; ++i) {
+            if (active[i] && zp[i] < nnlsPrimalZero) {
+                const double denominator = primal[i] - zp[i];
+                if (std::fabs(denominator) > 1.0e-16) {
+                    minStep = std::fmin(minStep, primal[i] / denominator);
+                    stepFound = true;
+                }
+            }
+        }
+        if (!stepFound) {
+            return false;
+        }
+        double gammaCorrection = 0.0;
+        for (std::size_t i = 0; i < nRows; ++i) {
+            primal[i] += minStep * (zp[i] - primal[i]);
+            if (std::fabs(primal[i]) < prLtZero && active[i]) {
+                gammaCorrection += std::fabs(s[i]);
+                active[i] = false;
+                --nActive;
+            }
+        }
+        if (gammaUpdate) {
+            gamma = std::fabs(gamma - gammaCorrection);
+        }
+        return true;
+    }
+    void ComputeOrigSolution() {
+        // exact multipliers on the active set: M_A * M_A_T * lambda_A = s_A, x = L^-1 * (M_T * lambda - v)
+        double sty = gamma;
+        for (std::size_t i = 0; i < nRows; ++i) {
+            if (active[i]) {
+                sty += s[i] * primal[i];
+            }
+        }
+        std::array<double, nRows> lambda{};
+        std::size_t k = 0;
+        for (std::size_t i = 0; i < nRows; ++i) {
+            lambda[i] = -primal[i] / sty;
+            if (active[i]) {
+                lsIndex[k++] = i;
+            }
+        }
+        std::array<double, nRows> d{};
+        std::array<double, nRows> y{};
+        for (std::size_t r = 0; r < k; ++r) {
+            for (std::size_t col = 0; col <= r; ++col) {
+                double sum = Dot(M[lsIndex[r]], M[lsIndex[col]]);
+                for (std::size_t l = 0; l < col; ++l) {
+                    sum -= gram[r][l] * gram[col][l] * d[l];
+                }
+                if (col < r) {
+                    gram[r][col] = std::fabs(d[col]) < 1.0e-16 ? 0.0 : sum / d[col];
+                } else {
+                    d[r] = sum;
+                }
+            }
+            double sum = s[lsIndex[r]];
+            for (std::size_t l = 0; l < r; ++l) {
+                sum -= gram[r][l] * y[l];
+            }
+            y[r] = sum;
+        }
+        for (std::size_t r = k; r-- > 0;) {
+            double sum = 0.0;
+            for (std::size_t l = r + 1; l < k; ++l) {
+                sum += gram[l][r] * lambda[lsIndex[l]];
+            }
+            lambda[lsIndex[r]] = std::fabs(d[r]) < 1.0e-16 ? 0.0 : y[r] / d[r] - sum;
+        }
+        std::array<double, nRows> lambdaActive{};
+        for (std::size_t r = 0; r < k; ++r) {
+            lambdaActive[lsIndex[r]] = lambda[lsIndex[r]];
+        }
+        std::array<double, nV> u{};
+        MultMT(lambdaActive.data(), u.data());
+        for (std::size_t j = 0; j < nV; ++j) {
+            u[j] -= v[j];
+        }
+        ApplyInv(u.data(), output.x.data());
+        const double invScaleFactor = 1.0 / scaleFactor;
+        for (std::size_t j = 0; j < nV; ++j) {
+            output.x[j] *= invScaleFactor;
+        }
+        for (std::size_t i = 0; i < nRows; ++i) {
+            const double li = -lambda[i] * rowScale[i] * invScaleFactor;
+            if (rowVariable[i] < 0) {
+                output.lambda[i] = li;
+            } else if (rowLower[i]) {
+                output.lambdaLw[rowVariable[i]] = li;
+            } else {
+                output.lambdaUp[rowVariable[i]] = li;
+            }
+        }
+        output.cost = Cost(output.x.data());
+    }
+    std::array<std::array<double, nV>, nV> L{};
+    std::array<std::array<double, nV>, nV> Inv{};
+    std::array<double, nV> Ld{};
+    std::array<std::array<double, nV>, nRows> M{};
+    std::array<std::array<double, nLs>, nRows> ls{};
+    std::array<std::array<double, nRows>, nRows> gram{};
+    std::array<std::size_t, nRows> lsIndex{};
+    std::array<bool, nRows> active{};
+    std::array<double, nRows> s{};
+    std::array<double, nRows> rowScale{};
+    std::array<double, nRows> primal{};
+    std::array<double, nRows> zp{};
+    std::array<double, nRows> dual{};
+    std::array<double, nV * nV> h{};
+    std::array<double, nV> c{};
+    std::array<double, nV> v{};
+    std::array<double, nV> MTY{};
+    std::size_t nActive = 0;
+    double gamma = 1.0;
+    double styGamma = 1.0;
+    double scaleFactor = 1.0;
+    double primalFsb = origPrimalFsb;
+    Output output;
+)";
+
+std::string Guard(const std::string& name) {
+    std::string guard = "NNLS_GENERATED_";
+    for (char ch : name) {
+        guard.push_back(std::isalnum(static_cast<unsigned char>(ch)) ? static_cast<char>(std::toupper(ch)) : '_');
+    }
+    return guard + "_H";
+}
+
+bool IsFinite(double bound) {
+    return std::fabs(bound) < CONSTANTS::infiniteBound;
+}
+
+// "a[i][j] * b[k][l]" terms joined by " + ", empty string for no terms
+template <typename F>
+std::string Sum(std::size_t n, F term) {
+    std::string sum;
+    for (std::size_t k = 0; k < n; ++k) {
+        const std::string t = term(k);
+        if (!t.empty()) {
+            sum += sum.empty() ? t : " + " + t;
+        }
+    }
+    return sum;
+}
+
+std::string Idx(const char* name, std::size_t i, std::size_t j) {
+    return std::string(name) + "[" + std::to_string(i) + "][" + std::to_string(j) + "]";
+}
+
+std::string Idx(const char* name, std::size_t i) {
+    return std::string(name) + "[" + std::to_string(i) + "]";
+}
+}
+
+bool SolverGenerator::Set(const DenseQPProblem& pattern, const CoreSettings& settings) {
+    errMsg.clear();
+    this->settings = settings;
+    nVariables = static_cast<unsigned int>(pattern.H.size());
+    nConstraints = static_cast<unsigned int>(pattern.A.size());
+    if (nVariables == 0 || pattern.c.size() != nVariables || pattern.lw.size() != nVariables ||
+        pattern.up.size() != nVariables || pattern.b.size() != nConstraints) {
+        errMsg = "inconsistent problem dimensions";
+        return false;
+    }
+    if (pattern.nEqConstraints > 0) {
+        errMsg = "equality rows are not supported, split them into two inequality rows";
+        return false;
+    }
+    for (double lw : pattern.bLw) {
+        if (lw > -CONSTANTS::infiniteBound) {
+            errMsg = "ranged rows are not supported";
+            return false;
+        }
+    }
+    hPattern.assign(nVariables, std::vector<bool>(nVariables, false));
+    for (unsigned int i = 0; i < nVariables; ++i) {
+        if (pattern.H[i].size() != nVariables) {
+            errMsg = "H is not square";
+            return false;
+        }
+        for (unsigned int j = 0; j <= i; ++j) {
+            hPattern[i][j] = i == j || pattern.H[i][j] != 0.0 || pattern.H[j][i] != 0.0;
+        }
+    }
+    aPattern.assign(nConstraints, std::vector<bool>(nVariables, false));
+    for (unsigned int i = 0; i < nConstraints; ++i) {
+        if (pattern.A[i].size() != nVariables) {
+            errMsg = "rows of A and H differ in size";
+            return false;
+        }
+        for (unsigned int j = 0; j < nVariables; ++j) {
+            aPattern[i][j] = pattern.A[i][j] != 0.0;
+        }
+    }
+    rowVariable.assign(nConstraints, -1);
+    rowLower.assign(nConstraints, false);
+    upperRow.assign(nVariables, -1);
+    for (unsigned int i = 0; i < nVariables; ++i) {
+        if (IsFinite(pattern.up[i])) {
+            upperRow[i] = static_cast<int>(rowVariable.size());
+            rowVariable.push_back(static_cast<int>(i));
+            rowLower.push_back(false);
+        }
+        if (IsFinite(pattern.lw[i])) {
+            rowVariable.push_back(static_cast<int>(i));
+            rowLower.push_back(true);
+        }
+    }
+    SymbolicFactorization();
+    return true;
+}
+
+void SolverGenerator::SymbolicFactorization() {
+    // nonzeros of L (H = L_T * L, eliminated from the last row as in ComputeCholFactorT), of L^-1 and of M
+    const unsigned int n = nVariables;
+    lPattern.assign(n, std::vector<bool>(n, false));
+    for (int r = static_cast<int>(n) - 1; r >= 0; --r) {
+        for (int col = r; col >= 0; --col) {
+            bool nz = hPattern[r][col];
+            for (unsigned int k = r + 1; k < n && !nz; ++k) {
+                nz = lPattern[k][col] && lPattern[k][r];
+            }
+            lPattern[r][col] = nz;
+        }
+    }
+    invPattern.assign(n, std::vector<bool>(n, false));
+    for (unsigned int r = 0; r < n; ++r) {
+        for (unsigned int col = 0; col <= r; ++col) {
+            bool nz = col == r;
+            for (unsigned int i = col; i < r && !nz; ++i) {
+                nz = lPattern[r][i] && invPattern[i][col];
+            }
+            invPattern[r][col] = nz;
+        }
+    }
+    mPattern.assign(rowVariable.size(), std::vector<bool>(n, false));
+    for (std::size_t i = 0; i < rowVariable.size(); ++i) {
+        for (unsigned int j = 0; j < n; ++j) {
+            if (rowVariable[i] >= 0) {
+                mPattern[i][j] = invPattern[rowVariable[i]][j];
+            } else {
+                for (unsigned int k = j; k < n && !mPattern[i][j]; ++k) {
+                    mPattern[i][j] = aPattern[i][k] && invPattern[k][j];
+                }
+            }
+        }
+    }
+}
+
+std::size_t SolverGenerator::Nnz(const pattern_t& pattern) const {
+    std::size_t nnz = 0;
+    for (const auto& row : pattern) {
+        nnz += static_cast<std::size_t>(std::count(row.begin(), row.end(), true));
+    }
+    return nnz;
+}
+
+void SolverGenerator::WriteFactorization(std::ostream& out) const {
+    const unsigned int n = nVariables;
+    out << "    bool Factorize(const double* H) {\n"
+           "        // H = L_T * L as ComputeCholFactorT, only structural nonzeros of H are read\n"
+           "        double t = 0.0;\n";
+    for (int r = static_cast<int>(n) - 1; r >= 0; --r) {
+        for (int col = r; col >= 0; --col) {
+            if (!lPattern[r][col]) {
+                continue;
+            }
+            const std::string sum = Sum(n, [&](std::size_t k) {
+                const std::size_t kk = n - 1 - k; // descending as the dense factorization
+                return kk > static_cast<std::size_t>(r) && lPattern[kk][col] && lPattern[kk][r]
+                       ? Idx("L", kk, col) + " * " + Idx("L", kk, r) : std::string();
+            });
+            const std::string h = hPattern[r][col] ? Idx("H", static_cast<std::size_t>(r) * n + col) : "0.0";
+            out << "        t = " << h << (sum.empty() ? "" : " - (" + sum + ")") << ";\n";
+            if (col == r) {
+                out << "        if (std::fabs(t) < " << CONSTANTS::cholFactorZero << ") {\n"
+                       "            t = " << CONSTANTS::cholFactorZero << ";\n"
+                       "        } else if (t < 0.0) {\n"
+                       "            return false;\n"
+                       "        }\n"
+                    << "        " << Idx("L", r, r) << " = std::sqrt(t);\n"
+                    << "        " << Idx("Ld", r) << " = 1.0 / " << Idx("L", r, r) << ";\n";
+            } else {
+                out << "        " << Idx("L", r, col) << " = " << Idx("Ld", r) << " * t;\n";
+            }
+        }
+    }
+    for (unsigned int i = 0; i < n; ++i) {
+        for (unsigned int j = 0; j <= i; ++j) {
+            if (hPattern[i][j]) {
+                out << "        " << Idx("h", i * n + j) << " = " << Idx("H", i * n + j) << ";\n";
+            }
+        }
+    }
+    out << "        return true;\n"
+           "    }\n";
+    out << "    void Invert() {\n"
+           "        // L^-1 as InvertCholetsky\n";
+    for (unsigned int r = 0; r < n; ++r) {
+        for (unsigned int col = 0; col <= r; ++col) {
+            if (!invPattern[r][col]) {
+                continue;
+            }
+            const std::string sum = Sum(r, [&](std::size_t i) {
+                return i >= col && lPattern[r][i] && invPattern[i][col]
+                       ? Idx("L", r, i) + " * " + Idx("Inv", i, col) : std::string();
+            });
+            out << "        " << Idx("Inv", r, col) << " = (" << (col == r ? "1.0" : "0.0")
+                << (sum.empty() ? "" : " - (" + sum + ")") << ") * " << Idx("Ld", r) << ";\n";
+        }
+    }
+    out << "    }\n";
+}
+
+void SolverGenerator::WriteFormM(std::ostream& out) const {
+    const unsigned int n = nVariables;
+    const std::size_t nRows = rowVariable.size();
+    out << "    void FormM(const double* A) {\n"
+           "        // M = [A; I; -I] * L^-1 for the rows of A and the finite bounds\n";
+    if (nConstraints == 0) {
+        out << "        (void)A;\n";
+    }
+    for (std::size_t i = 0; i < nRows; ++i) {
+        for (unsigned int j = 0; j < n; ++j) {
+            if (!mPattern[i][j]) {
+                continue;
+            }
+            out << "        " << Idx("M", i, j) << " = ";
+            if (rowVariable[i] >= 0) {
+                out << (rowLower[i] ? "-" : "") << Idx("Inv", rowVariable[i], j) << ";\n";
+            } else {
+                out << Sum(n, [&](std::size_t k) {
+                    return k >= j && aPattern[i][k] && invPattern[k][j]
+                           ? Idx("A", i * n + k) + " * " + Idx("Inv", k, j) : std::string();
+                }) << ";\n";
+            }
+        }
+    }
+    out << "    }\n";
+    out << "    void FormS(const double* b, const double* cUser, const double* lw, const double* up) {\n"
+           "        // v = L^-T * c, s = M * v + [b; up; -lw]\n";
+    for (unsigned int j = 0; j < n; ++j) {
+        out << "        " << Idx("c", j) << " = " << Idx("cUser", j) << ";\n";
+    }
+    for (unsigned int j = 0; j < n; ++j) {
+        out << "        " << Idx("v", j) << " = " << Sum(n, [&](std::size_t k) {
+            return invPattern[k][j] ? Idx("Inv", k, j) + " * " + Idx("c", k) : std::string();
+        }) << ";\n";
+    }
+    out << "        MultM(v.data(), s.data());\n";
+    if (nConstraints == 0) {
+        out << "        (void)b;\n";
+    }
+    bool usesLw = false;
+    bool usesUp = false;
+    for (std::size_t i = 0; i < nRows; ++i) {
+        out << "        " << Idx("s", i) << " += ";
+        if (rowVariable[i] < 0) {
+            out << Idx("b", i) << ";\n";
+        } else if (rowLower[i]) {
+            usesLw = true;
+            out << "-" << Idx("lw", rowVariable[i]) << ";\n";
+        } else {
+            usesUp = true;
+            out << Idx("up", rowVariable[i]) << ";\n";
+        }
+    }
+    if (!usesLw) {
+        out << "        (void)lw;\n";
+    }
+    if (!usesUp) {
+        out << "        (void)up;\n";
+    }
+    out << "    }\n";
+}
+
+void SolverGenerator::WriteKernels(std::ostream& out) const {
+    const unsigned int n = nVariables;
+    const std::size_t nRows = rowVariable.size();
+    const auto rowSum = [&](std::size_t i, const char* vec) {
+        const std::string sum = Sum(n, [&](std::size_t j) {
+            return mPattern[i][j] ? Idx("M", i, j) + " * " + Idx(vec, j) : std::string();
+        });
+        return sum.empty() ? std::string("0.0") : sum;
+    };
+    out << "    void MultM(const double* y, double* out) const {\n";
+    for (std::size_t i = 0; i < nRows; ++i) {
+        out << "        " << Idx("out", i) << " = " << rowSum(i, "y") << ";\n";
+    }
+    out << "    }\n";
+    out << "    void MultMT(const double* y, double* out) const {\n";
+    for (unsigned int j = 0; j < n; ++j) {
+        const std::string sum = Sum(nRows, [&](std::size_t i) {
+            return mPattern[i][j] ? Idx("M", i, j) + " * " + Idx("y", i) : std::string();
+        });
+        out << "        " << Idx("out", j) << " = " << (sum.empty() ? "0.0" : sum) << ";\n";
+    }
+    out << "    }\n";
+    out << "    void RowNorm2(double* norm2) const {\n";
+    for (std::size_t i = 0; i < nRows; ++i) {
+        const std::string sum = Sum(n, [&](std::size_t j) {
+            return mPattern[i][j] ? Idx("M", i, j) + " * " + Idx("M", i, j) : std::string();
+        });
+        out << "        " << Idx("norm2", i) << " = " << (sum.empty() ? "0.0" : sum) << ";\n";
+    }
+    out << "    }\n";
+    out << "    void ApplyInv(const double* w, double* x) const {\n";
+    for (unsigned int r = 0; r < n; ++r) {
+        out << "        " << Idx("x", r) << " = " << Sum(n, [&](std::size_t j) {
+            return invPattern[r][j] ? Idx("Inv", r, j) + " * " + Idx("w", j) : std::string();
+        }) << ";\n";
+    }
+    out << "    }\n";
+    out << "    double Cost(const double* x) const {\n"
+           "        double cost = 0.0;\n";
+    for (unsigned int i = 0; i < n; ++i) {
+        out << "        cost += " << Idx("c", i) << " * " << Idx("x", i) << ";\n";
+    }
+    for (unsigned int i = 0; i < n; ++i) {
+        for (unsigned int j = 0; j < i; ++j) {
+            if (hPattern[i][j]) {
+                out << "        cost += " << Idx("h", i * n + j) << " * " << Idx("x", i) << " * " << Idx("x", j) << ";\n";
+            }
+        }
+        out << "        cost += 0.5 * " << Idx("h", i * n + i) << " * " << Idx("x", i) << " * " << Idx("x", i) << ";\n";
+    }
+    out << "        return cost;\n"
+           "    }\n";
+}
+
+void SolverGenerator::Write(std::ostream& out, const std::string& name) const {
+    const std::size_t nRows = rowVariable.size();
+    const std::string guard = Guard(name);
+    out << std::setprecision(std::numeric_limits<double>::max_digits10);
+    out << "// generated by nnls_codegen, do not edit\n"
+        << "// n = " << nVariables << ", m = " << nConstraints << ", NNLS rows = " << nRows
+        << ", nonzeros: H " << Nnz(hPattern) << ", L " << Nnz(lPattern) << ", L^-1 " << Nnz(invPattern)
+        << ", M " << Nnz(mPattern) << "\n"
+        << "#ifndef " << guard << "\n"
+        << "#define " << guard << "\n"
+        << "#include <array>\n"
+           "#include <cmath>\n"
+           "#include <cstddef>\n"
+           "#include <limits>\n"
+           "#include <utility>\n"
+        << "namespace " << name << " {\n"
+        << "constexpr std::size_t nV = " << nVariables << ";\n"
+        << "constexpr std::size_t nC = " << nConstraints << ";\n"
+        << "constexpr std::size_t nRows = " << nRows << "; // rows of A, then finite upper and lower bounds\n"
+        << "constexpr std::size_t nLs = nV + 1;\n"
+        << "constexpr unsigned int nDualIterations = " << settings.nDualIterations << ";\n"
+        << "constexpr unsigned int nPrimalIterations = " << settings.nPrimalIterations << ";\n"
+        << "constexpr double nnlsResidNormFsb = " << settings.nnlsResidNormFsb << ";\n"
+        << "constexpr double origPrimalFsb = " << settings.origPrimalFsb << ";\n"
+        << "constexpr double nnlsPrimalZero = " << settings.nnlsPrimalZero << ";\n"
+        << "constexpr double prLtZero = " << settings.prLtZero << ";\n"
+        << "constexpr bool gammaUpdate = " << (settings.gammaUpdate ? "true" : "false") << ";\n";
+    out << "constexpr std::array<int, nRows> rowVariable = {";
+    for (std::size_t i = 0; i < nRows; ++i) {
+        out << (i > 0 ? ", " : "") << rowVariable[i];
+    }
+    out << "}; // -1 for rows of A\n"
+        << "constexpr std::array<bool, nRows> rowLower = {";
+    for (std::size_t i = 0; i < nRows; ++i) {
+        out << (i > 0 ? ", " : "") << (rowLower[i] ? "true" : "false");
+    }
+    out << "};\n"
+        << "enum class Status {\n"
+           "    ALL_DUAL_POSITIVE = 0,\n"
+           "    FULL_ACTIVE_SET,\n"
+           "    ITERATIONS,\n"
+           "    INFEASIBILITY,\n"
+           "    CHOLESKY,\n"
+           "};\n"
+           "struct Output {\n"
+           "    Status status = Status::ITERATIONS;\n"
+           "    unsigned int nDualIterations = 0;\n"
+           "    double cost = 0.0;\n"
+           "    std::array<double, nV> x{};\n"
+           "    std::array<double, nC> lambda{};\n"
+           "    std::array<double, nV> lambdaLw{}; // zero for infinite bounds\n"
+           "    std::array<double, nV> lambdaUp{};\n"
+           "};\n"
+           "class Solver {\n"
+           "public:\n"
+           "    // H (n x n) and A (m x n) are dense row major, only their structural nonzeros are read\n"
+           "    bool Setup(const double* H, const double* A, const double* b, const double* c, const double* lw, const double* up) {\n"
+           "        if (!Factorize(H)) {\n"
+           "            output = Output();\n"
+           "            output.status = Status::CHOLESKY;\n"
+           "            return false;\n"
+           "        }\n"
+           "        Invert();\n"
+           "        FormM(A);\n"
+           "        FormS(b, c, lw, up);\n"
+           "        Scale();\n"
+           "        return true;\n"
+           "    }\n";
+    out << runtime;
+    WriteFactorization(out);
+    WriteFormM(out);
+    WriteKernels(out);
+    out << "};\n"
+        << "}\n"
+        << "#endif // " << guard << "\n";
+}
+}
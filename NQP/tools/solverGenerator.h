@@ -0,0 +1,41 @@
+#ifndef NNLS_TOOLS_SOLVER_GENERATOR_H
+#define NNLS_TOOLS_SOLVER_GENERATOR_H
+#include <ostream>
+#include <string>
+#include <vector>
+#include "types.h"
+namespace QP_CODEGEN {
+class SolverGenerator {
+    // emits a standalone header with the dual NNLS solver of Core specialized to the structure of a template problem:
+    // structural zeros of H and A, finite bounds. Setup (Cholesky H = L_T * L, L^-1, M = [A; I; -I] * L^-1, v, s)
+    // and the kernels M * y, M_T * y are straight-line code over the structural nonzeros only,
+    // the dual / primal loop is the one of FixedCore. b, c and the finite bounds are dense.
+public:
+    SolverGenerator() = default;
+    ~SolverGenerator() = default;
+    // false for equality or ranged rows, bounds are infinite if |bound| >= infiniteBound
+    bool Set(const QP_NNLS::DenseQPProblem& pattern, const QP_NNLS::CoreSettings& settings = QP_NNLS::CoreSettings());
+    void Write(std::ostream& out, const std::string& name) const;
+    const std::string& GetError() const { return errMsg; }
+private:
+    using pattern_t = std::vector<std::vector<bool>>;
+    void SymbolicFactorization();
+    void WriteFactorization(std::ostream& out) const;
+    void WriteFormM(std::ostream& out) const;
+    void WriteKernels(std::ostream& out) const;
+    std::size_t Nnz(const pattern_t& pattern) const;
+    QP_NNLS::CoreSettings settings;
+    pattern_t hPattern;   // lower triangle
+    pattern_t aPattern;
+    pattern_t lPattern;   // Cholesky factor, low triangular
+    pattern_t invPattern; // L^-1, low triangular
+    pattern_t mPattern;   // NNLS rows
+    std::vector<int> rowVariable; // -1 for rows of A, else the bounded variable
+    std::vector<bool> rowLower;   // lower bound row -e_i
+    std::vector<int> upperRow;    // variable -> NNLS row of the upper bound, -1 if infinite
+    unsigned int nVariables = 0;
+    unsigned int nConstraints = 0;
+    std::string errMsg;
+};
+}
+#endif // NNLS_TOOLS_SOLVER_GENERATOR_H
@@ -0,0 +1,24 @@
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include "binaryTrace.h"
+
+// converts binary iteration trace written by BinaryTraceWriter to text log or csv
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "usage: nnls_trace_decode <trace file> <output file> [--csv]" << std::endl;
+        return 1;
+    }
+    const bool csv = argc > 3 && std::strcmp(argv[3], "--csv") == 0;
+    std::unique_ptr<QP_NNLS::ITraceWriter> writer;
+    if (csv) {
+        writer = std::make_unique<QP_NNLS::CsvTraceWriter>(argv[2]);
+    } else {
+        writer = std::make_unique<QP_NNLS::TextTraceWriter>(argv[2]);
+    }
+    if (!QP_NNLS::DecodeTrace(argv[1], *writer)) {
+        std::cerr << "failed to decode " << argv[1] << std::endl;
+        return 1;
+    }
+    return 0;
+}